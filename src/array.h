@@ -2,17 +2,54 @@
 #define ARRAY_H_
 
 #include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdbool.h>
 #include <assert.h>
 
+/**
+ * @struct ArrayAllocatorStats
+ * @brief Compteurs d'un allocateur, tenus à jour par array.h.
+ */
+typedef struct {
+    size_t live_bytes;  /**< Octets alloués et pas encore libérés. */
+    size_t peak_bytes;  /**< Maximum atteint par `live_bytes`. */
+    size_t allocations; /**< Appels à alloc et realloc. */
+} ArrayAllocatorStats;
+
+/**
+ * @struct ArrayAllocator
+ * @brief Allocateur d'un tableau ou d'un sous-système, avec ses compteurs.
+ *
+ * Un allocateur sans fonctions est l'allocateur de la libc, et reste valide après
+ * un rechargement de libplug.so. Avec une fonction `alloc`, la libc ne touche
+ * jamais aux blocs : sans `realloc`, un bloc est agrandi par `alloc`, une copie
+ * puis `free` ; sans `free`, la libération ne fait rien (arène libérée d'un coup
+ * par son propriétaire). Sans `alloc`, les blocs viennent de malloc et `realloc`
+ * ou `free` laissés à NULL sont ceux de la libc. Les tailles passées aux fonctions sont celles
+ * demandées à l'allocation, si bien qu'une arène ou un pool n'a pas à les garder.
+ * Les compteurs sont mis à jour de façon atomique : un allocateur peut servir
+ * à plusieurs threads si ses fonctions le permettent.
+ */
+typedef struct ArrayAllocator ArrayAllocator;
+struct ArrayAllocator {
+    void *(*alloc)(void *context, size_t size);                                    /**< Alloue `size` octets. */
+    void *(*realloc)(void *context, void *ptr, size_t old_size, size_t new_size); /**< Agrandit un bloc. */
+    void (*free)(void *context, void *ptr, size_t size);                          /**< Libère un bloc. */
+    void *context;             /**< Donnée passée en premier argument de chaque fonction. */
+    const char *name;          /**< Nom du sous-système (affichage). */
+    ArrayAllocatorStats stats; /**< Compteurs (lire avec array_allocator_stats). */
+};
+
 /**
  * @brief Structure représentant un tableau dynamique.
  */
 typedef struct {
-    size_t size;     /**< Nombre d'éléments actuellement dans le tableau. */
-    size_t capacity; /**< Capacité totale du tableau. */
+    size_t size;               /**< Nombre d'éléments actuellement dans le tableau. */
+    size_t capacity;           /**< Capacité totale du tableau. */
+    ArrayAllocator *allocator; /**< Allocateur du tableau, ou NULL pour malloc sans compteurs. */
 } Array;
 
 #define CAST(T, expr) ((T)(expr)) /**< Macro pour effectuer une conversion de type. */
@@ -34,7 +71,7 @@ typedef struct {
  * la fonction array_grow pour agrandir le tableau.
  */
 #define array_try_grow(array, size_) \
-    (((array) && array_meta(array)->size + (size_) < array_meta(array)->capacity) \
+    (((array) && array_meta(array)->size + (size_) <= array_meta(array)->capacity) \
      ? true \
      : array_grow(CAST(void **, &(array)), (size_), sizeof *(array)))
 
@@ -100,7 +137,7 @@ typedef struct {
  * @brief Macro pour libérer la mémoire associée au tableau.
  */
 #define array_free(array) \
-    array_delete((void*)array)
+    array_delete((void*)(array), sizeof *(array))
 
 /**
  * @brief Macro pour redimensionner le tableau.
@@ -130,12 +167,399 @@ typedef struct {
 #define array_clear(array) \
     (void)((array) ? array_meta(array)->size = 0 : 0)
 
+/**
+ * @brief Stockage intégré d'un petit tableau : les métadonnées suivies de N éléments.
+ *
+ * Placé dans la structure qui possède le tableau, il évite toute allocation tant
+ * que le tableau ne dépasse pas N éléments. Le tableau se lit et s'agrandit avec
+ * les macros habituelles, en passant par array_push_inline pour l'agrandir. La
+ * structure ne doit plus être déplacée une fois array_init_inline appelée.
+ */
+#define ArrayInline(T, N) \
+    struct { Array meta; T items[N]; }
+
+/**
+ * @brief Macro pour faire pointer un tableau sur son stockage intégré (vide).
+ */
+#define array_init_inline(array, storage) \
+    (assert((void *)(storage).items == (void *)(&(storage).meta + 1)), \
+     (storage).meta.size = 0, \
+     (storage).meta.capacity = sizeof((storage).items) / sizeof((storage).items[0]), \
+     (storage).meta.allocator = NULL, \
+     (array) = (storage).items)
+
+/**
+ * @brief Macro pour savoir si un tableau est encore dans son stockage intégré.
+ */
+#define array_is_inline(array, storage) \
+    ((void *)(array) == (void *)(storage).items)
+
+/**
+ * @brief Macro pour ajouter un élément à un tableau à stockage intégré.
+ *
+ * Quand le stockage intégré est plein, les éléments sont recopiés sur le tas ;
+ * ensuite le tableau grandit comme avec array_push.
+ */
+#define array_push_inline(array, storage, value) \
+    ((array_is_inline((array), (storage)) && array_meta(array)->size == array_meta(array)->capacity \
+      ? array_spill(CAST(void **, &(array)), sizeof *(array)) \
+      : true) \
+     ? array_push((array), (value)) \
+     : false)
+
+/**
+ * @brief Macro pour libérer un tableau à stockage intégré (sans effet s'il n'a pas quitté son stockage).
+ */
+#define array_free_inline(array, storage) \
+    (array_is_inline((array), (storage)) ? (void)0 : array_free(array))
+
+/**
+ * @def DEQUE_MIN_CAPACITY
+ * @brief Capacité d'un deque alloué par son premier ajout.
+ */
+#define DEQUE_MIN_CAPACITY 8
+
+/**
+ * @brief Structure représentant une file circulaire à deux bouts (deque).
+ *
+ * Comme pour Array, les métadonnées sont stockées juste avant les éléments et
+ * le deque se manipule par un pointeur vers ses éléments, mais l'élément i est
+ * à la position (head + i) modulo la capacité : il se lit avec deque_at, pas
+ * avec l'opérateur []. La capacité est une puissance de deux. Ajouter ou
+ * retirer à un bout ne déplace aucun élément ; quand le deque est plein, il est
+ * recopié dans l'ordre dans un tableau deux fois plus grand. Un deque NULL est
+ * vide, et son premier ajout l'alloue.
+ */
+typedef struct {
+    size_t head;               /**< Position du premier élément. */
+    size_t size;               /**< Nombre d'éléments. */
+    size_t capacity;           /**< Capacité (puissance de deux). */
+    ArrayAllocator *allocator; /**< Allocateur du deque, ou NULL pour malloc sans compteurs. */
+} Deque;
+
+/**
+ * @brief Macro pour obtenir les métadonnées du deque.
+ */
+#define deque_meta(deque) \
+    (CAST(Deque*, (deque)) - 1)
+
+/**
+ * @brief Macro pour obtenir le nombre d'éléments du deque.
+ */
+#define deque_size(deque) \
+    ((deque) ? deque_meta(deque)->size : 0)
+
+/**
+ * @brief Macro pour obtenir la capacité actuelle du deque.
+ */
+#define deque_capacity(deque) \
+    ((deque) ? deque_meta(deque)->capacity : 0)
+
+/**
+ * @brief Macro pour obtenir la position dans le tableau de l'élément i du deque.
+ */
+#define deque_index(deque, i) \
+    ((deque_meta(deque)->head + (i)) & (deque_meta(deque)->capacity - 1))
+
+/**
+ * @brief Macro pour accéder à l'élément i du deque (0 est le premier).
+ */
+#define deque_at(deque, i) \
+    ((deque)[deque_index((deque), (i))])
+
+/**
+ * @brief Macro pour accéder au premier élément du deque.
+ */
+#define deque_front(deque) \
+    deque_at((deque), 0)
+
+/**
+ * @brief Macro pour accéder au dernier élément du deque.
+ */
+#define deque_back(deque) \
+    deque_at((deque), deque_meta(deque)->size - 1)
+
+/**
+ * @brief Macro pour s'assurer qu'il reste une place dans le deque.
+ */
+#define deque_try_grow(deque) \
+    (((deque) && deque_meta(deque)->size < deque_meta(deque)->capacity) \
+     ? true \
+     : deque_grow(CAST(void **, &(deque)), sizeof *(deque)))
+
+/**
+ * @brief Macro pour ajouter un élément à la fin du deque.
+ */
+#define deque_push_back(deque, value) \
+    (deque_try_grow(deque) \
+     ? (deque_at((deque), deque_meta(deque)->size) = (value), deque_meta(deque)->size++, true) \
+     : false)
+
+/**
+ * @brief Macro pour ajouter un élément au début du deque.
+ */
+#define deque_push_front(deque, value) \
+    (deque_try_grow(deque) \
+     ? (deque_meta(deque)->head = deque_index((deque), deque_meta(deque)->capacity - 1), \
+	(deque)[deque_meta(deque)->head] = (value), deque_meta(deque)->size++, true) \
+     : false)
+
+/**
+ * @brief Macro pour supprimer le premier élément du deque.
+ */
+#define deque_pop_front(deque) \
+    (deque_size(deque) \
+     ? (deque_meta(deque)->head = deque_index((deque), 1), deque_meta(deque)->size--, true) \
+     : false)
+
+/**
+ * @brief Macro pour supprimer le dernier élément du deque.
+ */
+#define deque_pop_back(deque) \
+    (deque_size(deque) \
+     ? (deque_meta(deque)->size--, true) \
+     : false)
+
+/**
+ * @brief Macro pour vider le deque.
+ */
+#define deque_clear(deque) \
+    (void)((deque) ? (deque_meta(deque)->head = 0, deque_meta(deque)->size = 0) : 0)
+
+/**
+ * @brief Macro pour libérer la mémoire associée au deque (sans effet sur un deque NULL).
+ */
+#define deque_free(deque) \
+    deque_delete((void*)(deque), sizeof *(deque))
+
+/**
+ * @def MAP_KEY_STRING
+ * @brief Taille de clé d'une table dont la clé est une chaîne (`char *` ou `const char *`).
+ */
+#define MAP_KEY_STRING 0
+
+/**
+ * @def MAP_MIN_SLOTS
+ * @brief Nombre minimal de cases de l'index d'une table.
+ */
+#define MAP_MIN_SLOTS 8
+
+/**
+ * @struct MapSlot
+ * @brief Case de l'index d'une table : empreinte de la clé et position de l'entrée.
+ */
+typedef struct {
+    uint32_t hash;  /**< Empreinte de la clé, 0 pour une case vide. */
+    uint32_t index; /**< Position de l'entrée dans la table. */
+} MapSlot;
+
+/**
+ * @brief Structure représentant une table associative (adressage ouvert, Robin Hood).
+ *
+ * Les entrées sont rangées à la suite comme dans un Array, dont les métadonnées
+ * terminent l'en-tête : array_size et l'opérateur [] s'appliquent à la table.
+ * La clé est le premier champ de l'entrée, soit une chaîne (MAP_KEY_STRING),
+ * soit une valeur de `key_size` octets comparée avec memcmp (un entier, ou une
+ * structure sans octets de remplissage). L'index est un tableau séparé de
+ * MapSlot, dont le nombre de cases est une puissance de deux. Une clé est cherchée à partir
+ * de la case donnée par son empreinte ; à l'insertion, une entrée prend la case
+ * d'une entrée plus proche de sa case d'origine (Robin Hood), ce qui garde les
+ * parcours courts même avec un index rempli aux 7/8. Retirer une entrée la
+ * remplace par la dernière : les positions ne sont stables qu'entre deux retraits.
+ * Une entrée de plus est allouée après la capacité pour passer une entrée à
+ * map_put sans connaître son type. Une table se crée avec map_create_init ou
+ * map_create_with (une table NULL n'est pas vide).
+ */
+typedef struct {
+    MapSlot *slots;  /**< Index des entrées. */
+    size_t mask;     /**< Nombre de cases de l'index moins un. */
+    size_t key_size; /**< Taille de la clé en octets, ou MAP_KEY_STRING. */
+    Array array;     /**< Métadonnées des entrées, juste avant la première. */
+} Map;
+
+/**
+ * @brief Macro pour obtenir les métadonnées de la table.
+ */
+#define map_meta(map) \
+    (CAST(Map*, (map)) - 1)
+
+/**
+ * @brief Macro pour obtenir le nombre d'entrées de la table.
+ */
+#define map_size(map) \
+    array_size(map)
+
+/**
+ * @brief Macro pour obtenir le nombre d'entrées que la table peut contenir sans s'agrandir.
+ */
+#define map_capacity(map) \
+    array_capacity(map)
+
+/**
+ * @brief Macro pour s'assurer qu'il reste une place dans la table.
+ */
+#define map_try_grow(map) \
+    (map_size(map) < map_capacity(map) \
+     ? true \
+     : map_grow(CAST(void **, &(map)), sizeof *(map)))
+
+/**
+ * @brief Macro pour obtenir la position de l'entrée d'une clé, ou -1.
+ *
+ * La clé est passée par son adresse, ou directement pour une clé chaîne.
+ */
+#define map_find(map, key) \
+    map_lookup((map), sizeof *(map), (key))
+
+/**
+ * @brief Macro pour obtenir un pointeur vers l'entrée d'une clé, ou NULL.
+ */
+#define map_get(map, key) \
+    map_entry((map), sizeof *(map), (key))
+
+/**
+ * @brief Macro pour ajouter une entrée, ou remplacer l'entrée de même clé.
+ *
+ * @return La position de l'entrée, ou -1 si la table n'a pas pu s'agrandir.
+ */
+#define map_put(map, entry) \
+    (map_try_grow(map) \
+     ? ((map)[map_capacity(map)] = (entry), map_store((map), sizeof *(map))) \
+     : -1)
+
+/**
+ * @brief Macro pour retirer l'entrée d'une clé (la dernière entrée prend sa place).
+ *
+ * @return `true` si la clé était présente.
+ */
+#define map_remove(map, key) \
+    map_erase((map), sizeof *(map), (key))
+
+/**
+ * @brief Macro pour vider la table.
+ */
+#define map_clear(map) \
+    map_reset(map)
+
+/**
+ * @brief Macro pour libérer la mémoire associée à la table (sans effet sur une table NULL).
+ */
+#define map_free(map) \
+    map_delete((void*)(map), sizeof *(map))
+
 bool array_grow(void **const array, size_t elements, size_t type_size);
-void array_delete(void **const array);
+bool array_spill(void **const array, size_t type_size);
+void array_delete(void **const array, size_t type_size);
 void *array_create_init(size_t capacity, size_t type_size);
+void *array_create_with(ArrayAllocator *allocator, size_t capacity, size_t type_size);
+void *array_allocator_alloc(ArrayAllocator *allocator, size_t size);
+void *array_allocator_realloc(ArrayAllocator *allocator, void *ptr, size_t old_size, size_t new_size);
+void array_allocator_free(ArrayAllocator *allocator, void *ptr, size_t size);
+ArrayAllocatorStats array_allocator_stats(const ArrayAllocator *allocator);
+bool deque_grow(void **const deque, size_t type_size);
+void deque_delete(void *const deque, size_t type_size);
+void *deque_create_init(size_t capacity, size_t type_size);
+void *deque_create_with(ArrayAllocator *allocator, size_t capacity, size_t type_size);
+bool map_grow(void **const map, size_t type_size);
+ptrdiff_t map_lookup(const void *map, size_t type_size, const void *key);
+void *map_entry(void *map, size_t type_size, const void *key);
+ptrdiff_t map_store(void *map, size_t type_size);
+bool map_erase(void *map, size_t type_size, const void *key);
+void map_reset(void *map);
+void map_delete(void *const map, size_t type_size);
+void *map_create_init(size_t capacity, size_t type_size, size_t key_size);
+void *map_create_with(ArrayAllocator *allocator, size_t capacity, size_t type_size, size_t key_size);
 
 #ifdef ARRAY_IMPLEMENTATION
 
+/**
+ * @brief Ajoute `size` octets aux octets vivants d'un allocateur et relève le maximum.
+ */
+static void array_allocator_count(ArrayAllocator *allocator, size_t size) {
+    size_t live = __atomic_add_fetch(&allocator->stats.live_bytes, size, __ATOMIC_RELAXED);
+    size_t peak = __atomic_load_n(&allocator->stats.peak_bytes, __ATOMIC_RELAXED);
+    while (live > peak && !__atomic_compare_exchange_n(&allocator->stats.peak_bytes, &peak, live, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+    __atomic_add_fetch(&allocator->stats.allocations, 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Alloue un bloc avec un allocateur (malloc si `allocator` est NULL).
+ *
+ * @param allocator L'allocateur, ou NULL.
+ * @param size Le nombre d'octets.
+ * @return Le bloc, ou NULL en cas d'échec.
+ */
+void *array_allocator_alloc(ArrayAllocator *allocator, size_t size) {
+    if (!allocator) return malloc(size);
+    void *ptr = allocator->alloc ? allocator->alloc(allocator->context, size) : malloc(size);
+    if (ptr) array_allocator_count(allocator, size);
+    return ptr;
+}
+
+/**
+ * @brief Agrandit ou réduit un bloc obtenu avec le même allocateur.
+ *
+ * @param allocator L'allocateur, ou NULL.
+ * @param ptr Le bloc.
+ * @param old_size La taille demandée à son allocation.
+ * @param new_size La nouvelle taille.
+ * @return Le nouveau bloc, ou NULL en cas d'échec (l'ancien bloc reste valide).
+ */
+void *array_allocator_realloc(ArrayAllocator *allocator, void *ptr, size_t old_size, size_t new_size) {
+    if (!allocator) return realloc(ptr, new_size);
+    void *data;
+    if (allocator->realloc) {
+	data = allocator->realloc(allocator->context, ptr, old_size, new_size);
+    } else if (allocator->alloc) {
+	// bloc venu de `alloc` : la libc ne doit pas le voir
+	data = allocator->alloc(allocator->context, new_size);
+	if (data) {
+	    memcpy(data, ptr, old_size < new_size ? old_size : new_size);
+	    if (allocator->free) allocator->free(allocator->context, ptr, old_size);
+	}
+    } else {
+	data = realloc(ptr, new_size);
+    }
+    if (data) {
+	__atomic_sub_fetch(&allocator->stats.live_bytes, old_size, __ATOMIC_RELAXED);
+	array_allocator_count(allocator, new_size);
+    }
+    return data;
+}
+
+/**
+ * @brief Libère un bloc obtenu avec le même allocateur.
+ *
+ * @param allocator L'allocateur, ou NULL.
+ * @param ptr Le bloc (NULL est ignoré).
+ * @param size La taille demandée à son allocation.
+ */
+void array_allocator_free(ArrayAllocator *allocator, void *ptr, size_t size) {
+    if (!ptr) return;
+    if (!allocator) {
+	free(ptr);
+	return;
+    }
+    if (allocator->free) allocator->free(allocator->context, ptr, size);
+    else if (!allocator->alloc) free(ptr);
+    __atomic_sub_fetch(&allocator->stats.live_bytes, size, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Lit les compteurs d'un allocateur, éventuellement utilisé par d'autres threads.
+ *
+ * @param allocator L'allocateur.
+ * @return Une copie des compteurs.
+ */
+ArrayAllocatorStats array_allocator_stats(const ArrayAllocator *allocator) {
+    ArrayAllocatorStats stats = {
+	.live_bytes = __atomic_load_n(&allocator->stats.live_bytes, __ATOMIC_RELAXED),
+	.peak_bytes = __atomic_load_n(&allocator->stats.peak_bytes, __ATOMIC_RELAXED),
+	.allocations = __atomic_load_n(&allocator->stats.allocations, __ATOMIC_RELAXED),
+    };
+    return stats;
+}
+
 /**
  * @brief Agrandit la capacité d'un tableau dynamique.
  * 
@@ -152,9 +576,10 @@ bool array_grow(void **const array, size_t elements, size_t type_size) {
     assert(*array);
     Array *meta = array_meta(*array);
     const size_t count = 2 * meta->capacity + elements;
-    void *data = realloc(meta, type_size * count + sizeof *meta);
+    const size_t old_size = type_size * meta->capacity + sizeof *meta;
+    void *data = array_allocator_realloc(meta->allocator, meta, old_size, type_size * count + sizeof *meta);
     if (!data) {
-	free(meta);
+	array_allocator_free(meta->allocator, meta, old_size);
 	return false;
     }
     meta = CAST(Array *, data);
@@ -163,6 +588,28 @@ bool array_grow(void **const array, size_t elements, size_t type_size) {
     return true;
 }
 
+/**
+ * @brief Recopie sur le tas un tableau plein qui est dans un stockage intégré.
+ *
+ * Le nouveau tableau a deux fois la capacité du stockage et prend son
+ * allocateur ; le stockage intégré n'est plus utilisé.
+ *
+ * @param array   Un pointeur vers le tableau à recopier.
+ * @param type_size La taille en octets d'un élément du tableau.
+ * @return Retourne true si la copie réussit, false en cas d'échec (le tableau est inchangé).
+ */
+bool array_spill(void **const array, size_t type_size) {
+    Array *meta = array_meta(*array);
+    void *data = array_create_with(meta->allocator, 2 * meta->capacity + 1, type_size);
+    if (!data) {
+	return false;
+    }
+    memcpy(data, *array, meta->size * type_size);
+    array_meta(data)->size = meta->size;
+    *array = data;
+    return true;
+}
+
 /**
  * @brief Libère la mémoire associée à un tableau dynamique.
  * 
@@ -170,11 +617,12 @@ bool array_grow(void **const array, size_t elements, size_t type_size) {
  * y compris les métadonnées stockées avant le début du tableau.
  *
  * @param array Un pointeur vers le tableau à libérer.
+ * @param type_size La taille en octets d'un élément du tableau (compteurs de l'allocateur).
  */
-void array_delete(void **const array) {
+void array_delete(void **const array, size_t type_size) {
     assert(array);
     Array *const meta = array_meta(array);
-    free(meta);
+    array_allocator_free(meta->allocator, meta, type_size * meta->capacity + sizeof *meta);
 }
 
 /**
@@ -190,16 +638,371 @@ void array_delete(void **const array) {
  *         En cas d'échec, renvoie NULL.
  */
 void *array_create_init(size_t capacity, size_t type_size) {
-    void *data = malloc(type_size * capacity + sizeof(Array));
+    return array_create_with(NULL, capacity, type_size);
+}
+
+/**
+ * @brief Crée un tableau dynamique dont la mémoire vient d'un allocateur.
+ *
+ * Le tableau garde l'allocateur : il grandit et se libère avec lui.
+ *
+ * @param allocator L'allocateur, ou NULL pour malloc.
+ * @param capacity La capacité initiale du tableau.
+ * @param type_size La taille en octets d'un élément du tableau.
+ * @return Un pointeur vers la première position du tableau, ou NULL en cas d'échec.
+ */
+void *array_create_with(ArrayAllocator *allocator, size_t capacity, size_t type_size) {
+    void *data = array_allocator_alloc(allocator, type_size * capacity + sizeof(Array));
     if (!data) {
 	return 0;
     }
     Array *array = CAST(Array *, data);
     array->size = 0;
     array->capacity = capacity;
+    array->allocator = allocator;
     return array + 1;
 }
 
+/**
+ * @brief Double la capacité d'un deque plein, ou alloue un deque NULL.
+ *
+ * Les éléments sont recopiés dans l'ordre au début du nouveau tableau : la
+ * partie qui faisait le tour de l'ancien tableau se retrouve à sa place.
+ *
+ * @param deque Un pointeur vers le deque à agrandir.
+ * @param type_size La taille en octets d'un élément du deque.
+ * @return Retourne true si l'agrandissement réussit, false en cas d'échec (le deque est inchangé).
+ */
+bool deque_grow(void **const deque, size_t type_size) {
+    if (!*deque) {
+	*deque = deque_create_init(DEQUE_MIN_CAPACITY, type_size);
+	return *deque != NULL;
+    }
+    Deque *meta = deque_meta(*deque);
+    char *data = deque_create_with(meta->allocator, 2 * meta->capacity, type_size);
+    if (!data) {
+	return false;
+    }
+    size_t first = meta->capacity - meta->head;
+    if (first > meta->size) first = meta->size;
+    memcpy(data, (char *)*deque + meta->head * type_size, first * type_size);
+    memcpy(data + first * type_size, *deque, (meta->size - first) * type_size);
+    deque_meta(data)->size = meta->size;
+    deque_delete(*deque, type_size);
+    *deque = data;
+    return true;
+}
+
+/**
+ * @brief Libère la mémoire associée à un deque.
+ *
+ * @param deque Le deque à libérer (NULL est ignoré).
+ * @param type_size La taille en octets d'un élément du deque (compteurs de l'allocateur).
+ */
+void deque_delete(void *const deque, size_t type_size) {
+    if (!deque) return;
+    Deque *const meta = deque_meta(deque);
+    array_allocator_free(meta->allocator, meta, type_size * meta->capacity + sizeof *meta);
+}
+
+/**
+ * @brief Crée un deque vide.
+ *
+ * @param capacity La capacité initiale, arrondie à la puissance de deux supérieure.
+ * @param type_size La taille en octets d'un élément du deque.
+ * @return Un pointeur vers les éléments du deque, ou NULL en cas d'échec.
+ */
+void *deque_create_init(size_t capacity, size_t type_size) {
+    return deque_create_with(NULL, capacity, type_size);
+}
+
+/**
+ * @brief Crée un deque vide dont la mémoire vient d'un allocateur.
+ *
+ * @param allocator L'allocateur, ou NULL pour malloc.
+ * @param capacity La capacité initiale, arrondie à la puissance de deux supérieure.
+ * @param type_size La taille en octets d'un élément du deque.
+ * @return Un pointeur vers les éléments du deque, ou NULL en cas d'échec.
+ */
+void *deque_create_with(ArrayAllocator *allocator, size_t capacity, size_t type_size) {
+    size_t rounded = 1;
+    while (rounded < capacity) rounded *= 2;
+    void *data = array_allocator_alloc(allocator, type_size * rounded + sizeof(Deque));
+    if (!data) {
+	return 0;
+    }
+    Deque *deque = CAST(Deque *, data);
+    deque->head = 0;
+    deque->size = 0;
+    deque->capacity = rounded;
+    deque->allocator = allocator;
+    return deque + 1;
+}
+
+/**
+ * @brief Calcule l'empreinte d'une clé (jamais 0, réservé aux cases vides).
+ *
+ * @param key La clé : la chaîne pour MAP_KEY_STRING, son adresse sinon.
+ * @param key_size La taille de la clé en octets, ou MAP_KEY_STRING.
+ */
+static uint32_t map_hash(const void *key, size_t key_size) {
+    uint64_t hash = 14695981039346656037ull;
+    if (key_size == MAP_KEY_STRING) {
+	for (const unsigned char *c = key; *c; c++) hash = (hash ^ *c) * 1099511628211ull;
+    } else if (key_size <= sizeof hash) {
+	hash = 0;
+	memcpy(&hash, key, key_size);
+    } else {
+	const unsigned char *bytes = key;
+	for (size_t i = 0; i < key_size; i++) hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    // mélange final (splitmix64) : les bits de poids faible choisissent la case
+    hash ^= hash >> 30;
+    hash *= 0xbf58476d1ce4e5b9ull;
+    hash ^= hash >> 27;
+    hash *= 0x94d049bb133111ebull;
+    hash ^= hash >> 31;
+    return (uint32_t)hash ? (uint32_t)hash : 1;
+}
+
+/**
+ * @brief Donne la clé d'une entrée sous la forme attendue par map_hash.
+ */
+static const void *map_key(const Map *meta, const void *entry) {
+    return meta->key_size == MAP_KEY_STRING ? *(const char *const *)entry : entry;
+}
+
+/**
+ * @brief Cherche la case de l'index qui désigne une clé.
+ *
+ * @return La position de la case, ou SIZE_MAX si la clé est absente.
+ */
+static size_t map_slot(const void *map, size_t type_size, const void *key, uint32_t hash) {
+    const Map *meta = map_meta(map);
+    for (size_t pos = hash & meta->mask, distance = 0;; pos = (pos + 1) & meta->mask, distance++) {
+	MapSlot slot = meta->slots[pos];
+	// une entrée plus proche de sa case d'origine que la clé cherchée : la clé est absente
+	if (!slot.hash || ((pos - slot.hash) & meta->mask) < distance) return SIZE_MAX;
+	if (slot.hash != hash) continue;
+	const void *other = map_key(meta, (const char *)map + slot.index * type_size);
+	if (meta->key_size == MAP_KEY_STRING ? strcmp(key, other) == 0 : memcmp(key, other, meta->key_size) == 0) {
+	    return pos;
+	}
+    }
+}
+
+/**
+ * @brief Range une case dans l'index, à la place d'une entrée plus proche de sa case d'origine.
+ */
+static void map_place(Map *meta, MapSlot slot) {
+    for (size_t pos = slot.hash & meta->mask, distance = 0;; pos = (pos + 1) & meta->mask, distance++) {
+	MapSlot *curr = &meta->slots[pos];
+	if (!curr->hash) {
+	    *curr = slot;
+	    return;
+	}
+	size_t curr_distance = (pos - curr->hash) & meta->mask;
+	if (curr_distance < distance) {
+	    MapSlot displaced = *curr;
+	    *curr = slot;
+	    slot = displaced;
+	    distance = curr_distance;
+	}
+    }
+}
+
+/**
+ * @brief Double le nombre de cases de l'index d'une table et agrandit ses entrées.
+ *
+ * @param map Un pointeur vers la table à agrandir.
+ * @param type_size La taille en octets d'une entrée.
+ * @return Retourne true si l'agrandissement réussit, false en cas d'échec (la table est inchangée).
+ */
+bool map_grow(void **const map, size_t type_size) {
+    Map *meta = map_meta(*map);
+    ArrayAllocator *allocator = meta->array.allocator;
+    size_t slots = 2 * (meta->mask + 1);
+    size_t capacity = slots - slots / 8;
+    MapSlot *index = array_allocator_alloc(allocator, slots * sizeof(MapSlot));
+    if (!index) {
+	return false;
+    }
+    Map *data = array_allocator_realloc(allocator, meta,
+					type_size * (meta->array.capacity + 1) + sizeof(Map),
+					type_size * (capacity + 1) + sizeof(Map));
+    if (!data) {
+	array_allocator_free(allocator, index, slots * sizeof(MapSlot));
+	return false;
+    }
+    memset(index, 0, slots * sizeof(MapSlot));
+    MapSlot *old = data->slots;
+    size_t old_slots = data->mask + 1;
+    data->slots = index;
+    data->mask = slots - 1;
+    data->array.capacity = capacity;
+    // les empreintes sont dans l'index : aucune clé n'est relue
+    for (size_t i = 0; i < old_slots; i++) {
+	if (old[i].hash) map_place(data, old[i]);
+    }
+    array_allocator_free(allocator, old, old_slots * sizeof(MapSlot));
+    *map = data + 1;
+    return true;
+}
+
+/**
+ * @brief Cherche l'entrée d'une clé.
+ *
+ * @param map La table.
+ * @param type_size La taille en octets d'une entrée.
+ * @param key La clé : la chaîne pour MAP_KEY_STRING, son adresse sinon.
+ * @return La position de l'entrée, ou -1 si la clé est absente.
+ */
+ptrdiff_t map_lookup(const void *map, size_t type_size, const void *key) {
+    const Map *meta = map_meta(map);
+    size_t pos = map_slot(map, type_size, key, map_hash(key, meta->key_size));
+    return pos == SIZE_MAX ? -1 : (ptrdiff_t)meta->slots[pos].index;
+}
+
+/**
+ * @brief Cherche l'entrée d'une clé.
+ *
+ * @param map La table.
+ * @param type_size La taille en octets d'une entrée.
+ * @param key La clé : la chaîne pour MAP_KEY_STRING, son adresse sinon.
+ * @return Un pointeur vers l'entrée, ou NULL si la clé est absente.
+ */
+void *map_entry(void *map, size_t type_size, const void *key) {
+    ptrdiff_t index = map_lookup(map, type_size, key);
+    return index < 0 ? NULL : (char *)map + index * type_size;
+}
+
+/**
+ * @brief Range l'entrée placée après la capacité par map_put.
+ *
+ * La table doit avoir une place libre (map_try_grow).
+ *
+ * @param map La table.
+ * @param type_size La taille en octets d'une entrée.
+ * @return La position de l'entrée.
+ */
+ptrdiff_t map_store(void *map, size_t type_size) {
+    Map *meta = map_meta(map);
+    const char *entry = (const char *)map + meta->array.capacity * type_size;
+    const void *key = map_key(meta, entry);
+    uint32_t hash = map_hash(key, meta->key_size);
+    size_t pos = map_slot(map, type_size, key, hash);
+    size_t index = pos == SIZE_MAX ? meta->array.size++ : meta->slots[pos].index;
+    memcpy((char *)map + index * type_size, entry, type_size);
+    if (pos == SIZE_MAX) map_place(meta, (MapSlot){hash, (uint32_t)index});
+    return index;
+}
+
+/**
+ * @brief Retire l'entrée d'une clé ; la dernière entrée prend sa place.
+ *
+ * @param map La table.
+ * @param type_size La taille en octets d'une entrée.
+ * @param key La clé : la chaîne pour MAP_KEY_STRING, son adresse sinon (elle peut appartenir à l'entrée retirée).
+ * @return `true` si la clé était présente.
+ */
+bool map_erase(void *map, size_t type_size, const void *key) {
+    Map *meta = map_meta(map);
+    size_t pos = map_slot(map, type_size, key, map_hash(key, meta->key_size));
+    if (pos == SIZE_MAX) {
+	return false;
+    }
+    size_t index = meta->slots[pos].index;
+
+    // les cases suivantes reculent jusqu'à une case vide ou une entrée à sa case d'origine
+    for (;;) {
+	size_t next = (pos + 1) & meta->mask;
+	MapSlot slot = meta->slots[next];
+	if (!slot.hash || ((next - slot.hash) & meta->mask) == 0) break;
+	meta->slots[pos] = slot;
+	pos = next;
+    }
+    meta->slots[pos].hash = 0;
+
+    size_t last = meta->array.size - 1;
+    if (index != last) {
+	char *entry = (char *)map + last * type_size;
+	const void *last_key = map_key(meta, entry);
+	meta->slots[map_slot(map, type_size, last_key, map_hash(last_key, meta->key_size))].index = index;
+	memcpy((char *)map + index * type_size, entry, type_size);
+    }
+    meta->array.size = last;
+    return true;
+}
+
+/**
+ * @brief Vide une table sans libérer sa mémoire.
+ *
+ * @param map La table à vider (NULL est ignoré).
+ */
+void map_reset(void *map) {
+    if (!map) return;
+    Map *meta = map_meta(map);
+    memset(meta->slots, 0, (meta->mask + 1) * sizeof(MapSlot));
+    meta->array.size = 0;
+}
+
+/**
+ * @brief Libère la mémoire associée à une table.
+ *
+ * @param map La table à libérer (NULL est ignoré).
+ * @param type_size La taille en octets d'une entrée (compteurs de l'allocateur).
+ */
+void map_delete(void *const map, size_t type_size) {
+    if (!map) return;
+    Map *const meta = map_meta(map);
+    ArrayAllocator *allocator = meta->array.allocator;
+    array_allocator_free(allocator, meta->slots, (meta->mask + 1) * sizeof(MapSlot));
+    array_allocator_free(allocator, meta, type_size * (meta->array.capacity + 1) + sizeof(Map));
+}
+
+/**
+ * @brief Crée une table vide.
+ *
+ * @param capacity Le nombre d'entrées à pouvoir ranger sans agrandir la table.
+ * @param type_size La taille en octets d'une entrée.
+ * @param key_size La taille en octets de la clé (premier champ de l'entrée), ou MAP_KEY_STRING.
+ * @return Un pointeur vers les entrées de la table, ou NULL en cas d'échec.
+ */
+void *map_create_init(size_t capacity, size_t type_size, size_t key_size) {
+    return map_create_with(NULL, capacity, type_size, key_size);
+}
+
+/**
+ * @brief Crée une table vide dont la mémoire vient d'un allocateur.
+ *
+ * @param allocator L'allocateur, ou NULL pour malloc.
+ * @param capacity Le nombre d'entrées à pouvoir ranger sans agrandir la table.
+ * @param type_size La taille en octets d'une entrée.
+ * @param key_size La taille en octets de la clé (premier champ de l'entrée), ou MAP_KEY_STRING.
+ * @return Un pointeur vers les entrées de la table, ou NULL en cas d'échec.
+ */
+void *map_create_with(ArrayAllocator *allocator, size_t capacity, size_t type_size, size_t key_size) {
+    size_t slots = MAP_MIN_SLOTS;
+    while (slots - slots / 8 < capacity) slots *= 2;
+    capacity = slots - slots / 8;
+    Map *map = array_allocator_alloc(allocator, type_size * (capacity + 1) + sizeof(Map));
+    if (!map) {
+	return 0;
+    }
+    map->slots = array_allocator_alloc(allocator, slots * sizeof(MapSlot));
+    if (!map->slots) {
+	array_allocator_free(allocator, map, type_size * (capacity + 1) + sizeof(Map));
+	return 0;
+    }
+    memset(map->slots, 0, slots * sizeof(MapSlot));
+    map->mask = slots - 1;
+    map->key_size = key_size;
+    map->array.size = 0;
+    map->array.capacity = capacity;
+    map->array.allocator = allocator;
+    return map + 1;
+}
+
 #endif // ARRAY_IMPLEMENTATION
 
 #endif // ARRAY_H_
@@ -0,0 +1,1273 @@
+/* -*- compile-command: "make -C .. bench" -*- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <ctype.h>
+#include <sys/stat.h>
+#include <utime.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <dirent.h>
+
+#include "xml.h"
+#include "array.h"
+#include "level.h"
+#include "catalog.h"
+#include "library.h"
+#include "render.h"
+
+// dimensions d'un niveau (TILESX x TILESY dans plug.h), sans dépendre de raylib
+#define BENCH_TILESX 22
+#define BENCH_TILESY 13
+#define BENCH_PLAYERS 3
+#define BENCH_TILE_SIZE 36
+
+static double bench_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Écrit un document contenant autant de niveaux que nécessaire pour atteindre `size` octets.
+ *
+ * Chaque niveau a la forme d'un fichier de `levels/` : un noeud csv et des noeuds player.
+ *
+ * @return Nombre de niveaux écrits, 0 en cas d'erreur.
+ */
+static size_t bench_xml_generate(const char *file_path, size_t size) {
+    FILE *file = fopen(file_path, "w");
+    if (!file) {
+	fprintf(stderr, "ERROR: Could not fopen the file %s\n", file_path);
+	return 0;
+    }
+
+    srand(42);
+    size_t levels = 0;
+    fprintf(file, "<root>\n");
+    while ((size_t)ftell(file) < size) {
+	fprintf(file, "  <level id=\"%zu\">\n    <csv>\n      ", levels);
+	for (size_t y = 0; y < BENCH_TILESY; y++) {
+	    for (size_t x = 0; x < BENCH_TILESX; x++) {
+		fprintf(file, "%d", rand() % 8 == 0 ? rand() % 7 : 0);
+		if (y != BENCH_TILESY - 1 || x != BENCH_TILESX - 1) fputc(',', file);
+	    }
+	    if (y != BENCH_TILESY - 1) fputc('\n', file);
+	}
+	fprintf(file, "\n    </csv>\n");
+	for (size_t i = 0; i < BENCH_PLAYERS; i++) {
+	    fprintf(file, "    <player x=\"%d\" y=\"%d\"/>\n", rand() % BENCH_TILESX, rand() % BENCH_TILESY);
+	}
+	fprintf(file, "  </level>\n");
+	levels++;
+    }
+    fprintf(file, "</root>\n");
+    fclose(file);
+    return levels;
+}
+
+static size_t bench_xml_count(XMLNode *node) {
+    size_t count = 1;
+    for (size_t i = 0; i < array_size(node->children); i++) {
+	count += bench_xml_count(node->children[i]);
+    }
+    return count;
+}
+
+static void bench_xml_sax_start(void *user, XMLStr tag) {
+    (void)tag;
+    (*(size_t *)user)++;
+}
+
+/**
+ * @brief Compare le débit de xml_load (copie de chaque chaîne), de xml_view_load (mmap, vues)
+ * et de xml_sax_parse_file (flux par morceaux, sans arbre).
+ */
+static int bench_xml(int argc, char **argv) {
+    size_t megabytes = argc > 0 ? strtoul(argv[0], NULL, 10) : 8;
+    size_t iterations = argc > 1 ? strtoul(argv[1], NULL, 10) : 5;
+    const char *file_path = argc > 2 ? argv[2] : "/tmp/lemmings-bench.xml";
+
+    size_t levels = bench_xml_generate(file_path, megabytes << 20);
+    if (levels == 0) return 1;
+
+    FILE *file = fopen(file_path, "r");
+    fseek(file, 0, SEEK_END);
+    double mb = ftell(file) / (1024.0 * 1024.0);
+    fclose(file);
+    printf("xml: %s, %.1f MB, %zu levels, %zu iterations\n", file_path, mb, levels, iterations);
+
+    double best_load = 1e9, best_view = 1e9, best_sax = 1e9;
+    size_t nodes_load = 0, nodes_view = 0, nodes_sax = 0;
+    XMLArena arena = {0};
+    for (size_t it = 0; it < iterations; it++) {
+	XMLDocument doc = {0};
+	double start = bench_time();
+	if (!xml_load(&doc, file_path)) return 1;
+	nodes_load = bench_xml_count(doc.root);
+	arena = *doc.arena;
+	xml_doc_free(&doc);
+	double elapsed = bench_time() - start;
+	if (elapsed < best_load) best_load = elapsed;
+
+	XMLView view = {0};
+	start = bench_time();
+	if (!xml_view_load(&view, file_path)) return 1;
+	nodes_view = array_size(view.nodes);
+	xml_view_free(&view);
+	elapsed = bench_time() - start;
+	if (elapsed < best_view) best_view = elapsed;
+
+	nodes_sax = 0;
+	XMLSaxHandler handler = {.user = &nodes_sax, .start = bench_xml_sax_start};
+	start = bench_time();
+	if (!xml_sax_parse_file(file_path, handler)) return 1;
+	elapsed = bench_time() - start;
+	if (elapsed < best_sax) best_sax = elapsed;
+    }
+
+    if (nodes_load != nodes_view || nodes_load != nodes_sax) {
+	fprintf(stderr, "ERROR: Node count mismatch (xml_load: %zu, xml_view_load: %zu, xml_sax_parse_file: %zu)\n",
+		nodes_load, nodes_view, nodes_sax);
+	return 1;
+    }
+
+    printf("%-18s %10s %10s\n", "parser", "ms", "MB/s");
+    printf("%-18s %10.2f %10.1f\n", "xml_load", best_load * 1e3, mb / best_load);
+    printf("%-18s %10.2f %10.1f\n", "xml_view_load", best_view * 1e3, mb / best_view);
+    printf("%-18s %10.2f %10.1f\n", "xml_sax_parse_file", best_sax * 1e3, mb / best_sax);
+    printf("speedup: %.1fx (%zu nodes)\n", best_load / best_view, nodes_view);
+    printf("xml_load arena: %zu allocations served by %zu mallocs (%.1f MB)\n",
+	   arena.allocations, arena.block_count, arena.bytes / (1024.0 * 1024.0));
+    return 0;
+}
+
+/**
+ * @brief Recherche d'origine de xml_node_find_tags : parcours de tout le sous-arbre avec strcmp.
+ */
+static Array_XMLNode bench_query_walk(XMLNode *root, const char *tagname) {
+    Array_XMLNode stack = array_create_init(2, sizeof(XMLNode*));
+    Array_XMLNode nodes = array_create_init(2, sizeof(XMLNode*));
+    array_push(stack, root);
+    while (array_size(stack)) {
+	XMLNode *node = array_last(stack);
+	array_pop_last(stack);
+	if (strcmp(node->tag, tagname) == 0) array_push(nodes, node);
+	for (size_t i = 0; i < array_size(node->children); i++) {
+	    array_push(stack, node->children[i]);
+	}
+    }
+    array_free(stack);
+    return nodes;
+}
+
+/**
+ * @brief Compare les recherches par tag et par clé d'attribut avant et après l'index des tags.
+ */
+static int bench_query(int argc, char **argv) {
+    size_t megabytes = argc > 0 ? strtoul(argv[0], NULL, 10) : 8;
+    size_t queries = argc > 1 ? strtoul(argv[1], NULL, 10) : 20;
+    const char *file_path = argc > 2 ? argv[2] : "/tmp/lemmings-bench.xml";
+
+    size_t levels = bench_xml_generate(file_path, megabytes << 20);
+    if (levels == 0) return 1;
+    XMLDocument doc;
+    if (!xml_load(&doc, file_path)) return 1;
+    printf("query: %s, %zu levels, %zu queries, %zu interned strings\n", file_path, levels, queries, doc.arena->string_count);
+    printf("%-28s %10s %10s\n", "query", "ms/query", "matches");
+
+    // Recherche de tous les joueurs du document.
+    size_t walk_count = 0, index_count = 0;
+    double start = bench_time();
+    for (size_t q = 0; q < queries; q++) {
+	Array_XMLNode nodes = bench_query_walk(doc.root, "player");
+	walk_count = array_size(nodes);
+	array_free(nodes);
+    }
+    double walk = (bench_time() - start) / queries;
+
+    start = bench_time();
+    Array_XMLNode first = xml_node_find_tags(doc.root, "player");
+    double build = bench_time() - start;
+    array_free(first);
+    start = bench_time();
+    for (size_t q = 0; q < queries; q++) {
+	Array_XMLNode nodes = xml_node_find_tags(doc.root, "player");
+	index_count = array_size(nodes);
+	array_free(nodes);
+    }
+    double indexed = (bench_time() - start) / queries;
+    if (walk_count != index_count) {
+	fprintf(stderr, "ERROR: Match count mismatch (walk: %zu, index: %zu)\n", walk_count, index_count);
+	return 1;
+    }
+    printf("%-28s %10.3f %10zu\n", "walk find_tags(player)", walk * 1e3, walk_count);
+    printf("%-28s %10.3f %10s\n", "index build (first query)", build * 1e3, "");
+    printf("%-28s %10.3f %10zu\n", "index find_tags(player)", indexed * 1e3, index_count);
+
+    // Nœud csv de chaque niveau, puis attribut x de chaque joueur.
+    Array_XMLNode level_nodes = xml_node_find_tags(doc.root, "level");
+    start = bench_time();
+    size_t found = 0;
+    for (size_t i = 0; i < array_size(level_nodes); i++) {
+	if (xml_node_find_tag(level_nodes[i], "csv")) found++;
+    }
+    double per_level = (bench_time() - start) / array_size(level_nodes);
+    printf("%-28s %10.6f %10zu\n", "index find_tag(level, csv)", per_level * 1e3, found);
+    array_free(level_nodes);
+
+    Array_XMLNode players = xml_node_find_tags(doc.root, "player");
+    size_t sum_walk = 0, sum_index = 0;
+    start = bench_time();
+    for (size_t i = 0; i < array_size(players); i++) sum_walk += atoi(xml_attrib_get_value(players[i], "x"));
+    double attrib_walk = (bench_time() - start) / array_size(players);
+    start = bench_time();
+    const char *x = xml_intern(doc.arena, "x");
+    for (size_t i = 0; i < array_size(players); i++) sum_index += atoi(xml_attrib_get_interned(players[i], x));
+    double attrib_index = (bench_time() - start) / array_size(players);
+    array_free(players);
+    if (sum_walk != sum_index) {
+	fprintf(stderr, "ERROR: Attribute mismatch\n");
+	return 1;
+    }
+    printf("%-28s %10.6f %10s\n", "strcmp attrib(x)", attrib_walk * 1e3, "");
+    printf("%-28s %10.6f %10s\n", "interned attrib(x)", attrib_index * 1e3, "");
+
+    xml_doc_free(&doc);
+    return 0;
+}
+
+/*
+ * Compteurs d'allocations : le programme est lié avec -Wl,--wrap=malloc (voir le
+ * Makefile), les appels faits par xml.c et array.h passent donc par ces fonctions.
+ * Les allocations internes de la libc (fopen, strdup...) ne sont pas comptées.
+ */
+static size_t bench_allocs = 0;
+static size_t bench_alloc_bytes = 0;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+
+void *__wrap_malloc(size_t size) {
+    bench_allocs++;
+    bench_alloc_bytes += size;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+    bench_allocs++;
+    bench_alloc_bytes += count * size;
+    return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+    bench_allocs++;
+    bench_alloc_bytes += size;
+    return __real_realloc(ptr, size);
+}
+
+// profondeur des chaînes de nœuds du document "deep"
+#define BENCH_CORPUS_DEPTH 128
+// attributs par nœud du document "attrs"
+#define BENCH_CORPUS_ATTRS 16
+// caractères d'un texte du document "text"
+#define BENCH_CORPUS_TEXT 16384
+
+/**
+ * @brief Écrit des chaînes de BENCH_CORPUS_DEPTH nœuds imbriqués.
+ */
+static void bench_corpus_deep(FILE *file, size_t size) {
+    while ((size_t)ftell(file) < size) {
+	for (size_t d = 0; d < BENCH_CORPUS_DEPTH; d++) fprintf(file, "<node d=\"%zu\">\n", d);
+	fprintf(file, "leaf\n");
+	for (size_t d = 0; d < BENCH_CORPUS_DEPTH; d++) fprintf(file, "</node>\n");
+    }
+}
+
+/**
+ * @brief Écrit des nœuds vides, tous enfants de la racine.
+ */
+static void bench_corpus_wide(FILE *file, size_t size) {
+    for (size_t i = 0; (size_t)ftell(file) < size; i++) {
+	fprintf(file, "  <item id=\"%zu\"/>\n", i);
+    }
+}
+
+/**
+ * @brief Écrit des paragraphes de BENCH_CORPUS_TEXT caractères (moins pour les petits documents).
+ */
+static void bench_corpus_text(FILE *file, size_t size) {
+    size_t length = size / 2 < BENCH_CORPUS_TEXT ? size / 2 : BENCH_CORPUS_TEXT;
+    while ((size_t)ftell(file) < size) {
+	fprintf(file, "  <p>\n    ");
+	for (size_t c = 0; c < length; c++) {
+	    fputc(rand() % 6 == 0 ? ' ' : 'a' + rand() % 26, file);
+	}
+	fprintf(file, "\n  </p>\n");
+    }
+}
+
+/**
+ * @brief Écrit des nœuds portant BENCH_CORPUS_ATTRS attributs.
+ */
+static void bench_corpus_attrs(FILE *file, size_t size) {
+    while ((size_t)ftell(file) < size) {
+	fprintf(file, "  <item");
+	for (size_t a = 0; a < BENCH_CORPUS_ATTRS; a++) fprintf(file, " key%zu=\"%d\"", a, rand());
+	fprintf(file, "/>\n");
+    }
+}
+
+/**
+ * @struct BenchShape
+ * @brief Forme de document du corpus.
+ */
+typedef struct {
+    const char *name;                          /**< Nom de la forme, repris dans la sortie. */
+    const char *tag;                           /**< Tag cherché avec xml_node_find_tags. */
+    void (*generate)(FILE *file, size_t size); /**< Écrit le contenu de la racine, NULL pour les niveaux. */
+} BenchShape;
+
+static const BenchShape bench_shapes[] = {
+    {"levels", "player", NULL},
+    {"deep", "node", bench_corpus_deep},
+    {"wide", "item", bench_corpus_wide},
+    {"text", "p", bench_corpus_text},
+    {"attrs", "item", bench_corpus_attrs},
+};
+
+#define BENCH_SHAPE_COUNT (sizeof(bench_shapes) / sizeof(bench_shapes[0]))
+
+// tailles du corpus, de 1 Ko à 100 Mo
+static const size_t bench_corpus_sizes[] = {1 << 10, 16 << 10, 256 << 10, 4 << 20, 16 << 20, 100 << 20};
+
+#define BENCH_CORPUS_SIZE_COUNT (sizeof(bench_corpus_sizes) / sizeof(bench_corpus_sizes[0]))
+
+/**
+ * @brief Écrit un document du corpus d'environ `size` octets.
+ *
+ * @return La taille du fichier, 0 en cas d'erreur.
+ */
+static size_t bench_corpus_generate(const BenchShape *shape, const char *file_path, size_t size) {
+    if (!shape->generate) {
+	if (bench_xml_generate(file_path, size) == 0) return 0;
+    } else {
+	FILE *file = fopen(file_path, "w");
+	if (!file) {
+	    fprintf(stderr, "ERROR: Could not fopen the file %s\n", file_path);
+	    return 0;
+	}
+	srand(42);
+	fprintf(file, "<root>\n");
+	shape->generate(file, size);
+	fprintf(file, "</root>\n");
+	fclose(file);
+    }
+
+    struct stat st;
+    if (stat(file_path, &st) == -1) return 0;
+    return st.st_size;
+}
+
+/**
+ * @struct BenchOp
+ * @brief Mesure d'une opération sur un document du corpus.
+ */
+typedef struct {
+    const char *name;   /**< Nom de l'opération. */
+    double best;        /**< Meilleur temps, en secondes. */
+    size_t allocs;      /**< Appels à malloc, calloc et realloc (première itération). */
+    size_t alloc_bytes; /**< Octets demandés (première itération). */
+    long peak_rss;      /**< Pic de mémoire résidente du processus après l'opération, en Ko. */
+} BenchOp;
+
+enum {
+    BENCH_OP_LOAD,
+    BENCH_OP_INDEX,
+    BENCH_OP_FIND,
+    BENCH_OP_WRITE,
+    BENCH_OP_FREE,
+    BENCH_OP_COUNT,
+};
+
+static double bench_op_start(void) {
+    bench_allocs = 0;
+    bench_alloc_bytes = 0;
+    return bench_time();
+}
+
+static void bench_op_end(BenchOp *op, double start, size_t it) {
+    double elapsed = bench_time() - start;
+    if (it == 0 || elapsed < op->best) op->best = elapsed;
+    if (it == 0) {
+	op->allocs = bench_allocs;
+	op->alloc_bytes = bench_alloc_bytes;
+    }
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    op->peak_rss = usage.ru_maxrss;
+}
+
+/**
+ * @brief Mesure les opérations sur un document et écrit une ligne par opération.
+ *
+ * Appelée dans un processus fils, pour que le pic de mémoire résidente soit propre au document.
+ */
+static int bench_corpus_run(const BenchShape *shape, const char *file_path, const char *out_path, size_t bytes, size_t iterations) {
+    BenchOp ops[BENCH_OP_COUNT] = {
+	[BENCH_OP_LOAD] = {.name = "xml_load"},
+	[BENCH_OP_INDEX] = {.name = "find_tags_first"},
+	[BENCH_OP_FIND] = {.name = "find_tags"},
+	[BENCH_OP_WRITE] = {.name = "xml_doc_write"},
+	[BENCH_OP_FREE] = {.name = "xml_doc_free"},
+    };
+    size_t nodes = 0, matches = 0;
+    double start;
+
+    for (size_t it = 0; it < iterations; it++) {
+	XMLDocument doc;
+	start = bench_op_start();
+	if (!xml_load(&doc, file_path)) return 1;
+	bench_op_end(&ops[BENCH_OP_LOAD], start, it);
+	nodes = bench_xml_count(doc.root);
+
+	// la première recherche construit l'index des tags
+	start = bench_op_start();
+	Array_XMLNode found = xml_node_find_tags(doc.root, shape->tag);
+	bench_op_end(&ops[BENCH_OP_INDEX], start, it);
+	array_free(found);
+
+	start = bench_op_start();
+	found = xml_node_find_tags(doc.root, shape->tag);
+	bench_op_end(&ops[BENCH_OP_FIND], start, it);
+	matches = array_size(found);
+	array_free(found);
+
+	start = bench_op_start();
+	if (!xml_doc_write(&doc, out_path, 2)) return 1;
+	bench_op_end(&ops[BENCH_OP_WRITE], start, it);
+
+	start = bench_op_start();
+	xml_doc_free(&doc);
+	bench_op_end(&ops[BENCH_OP_FREE], start, it);
+    }
+    unlink(out_path);
+
+    if (matches == 0) {
+	fprintf(stderr, "ERROR: No <%s> found in %s\n", shape->tag, file_path);
+	return 1;
+    }
+    double mb = bytes / (1024.0 * 1024.0);
+    for (size_t i = 0; i < BENCH_OP_COUNT; i++) {
+	BenchOp *op = &ops[i];
+	printf("%s\t%zu\t%zu\t%s\t%.3f\t%.1f\t%zu\t%zu\t%ld\n", shape->name, bytes, nodes, op->name,
+	       op->best * 1e3, op->best > 0 ? mb / op->best : 0.0, op->allocs, op->alloc_bytes, op->peak_rss);
+    }
+    return 0;
+}
+
+/**
+ * @brief Mesure xml_load, xml_node_find_tags, xml_doc_write et xml_doc_free sur un corpus
+ * de documents de formes et de tailles variées.
+ *
+ * La sortie est un tableau TSV stable (une ligne d'en-tête, puis une ligne par document
+ * et par opération) à comparer d'une version à l'autre.
+ */
+static int bench_corpus(int argc, char **argv) {
+    size_t max_megabytes = argc > 0 ? strtoul(argv[0], NULL, 10) : 16;
+    size_t iterations = argc > 1 ? strtoul(argv[1], NULL, 10) : 3;
+    const char *dir = argc > 2 ? argv[2] : "/tmp/lemmings-corpus";
+    if (iterations == 0) iterations = 1;
+    mkdir(dir, 0777);
+
+    printf("# lemmings xml corpus v1, %zu iterations\n", iterations);
+    printf("shape\tbytes\tnodes\top\tms\tmb_s\tallocs\talloc_bytes\tpeak_rss_kb\n");
+    fflush(stdout);
+
+    int result = 0;
+    char file_path[256], out_path[256];
+    for (size_t s = 0; s < BENCH_SHAPE_COUNT; s++) {
+	const BenchShape *shape = &bench_shapes[s];
+	for (size_t z = 0; z < BENCH_CORPUS_SIZE_COUNT; z++) {
+	    size_t size = bench_corpus_sizes[z];
+	    if (size > max_megabytes << 20) break;
+	    snprintf(file_path, sizeof(file_path), "%s/%s-%zu.xml", dir, shape->name, size);
+	    snprintf(out_path, sizeof(out_path), "%s/%s-%zu.out.xml", dir, shape->name, size);
+	    size_t bytes = bench_corpus_generate(shape, file_path, size);
+	    if (bytes == 0) return 1;
+
+	    pid_t pid = fork();
+	    if (pid == -1) {
+		fprintf(stderr, "ERROR: Could not fork: %s\n", strerror(errno));
+		return 1;
+	    }
+	    if (pid == 0) {
+		int status = bench_corpus_run(shape, file_path, out_path, bytes, iterations);
+		fflush(stdout);
+		_exit(status);
+	    }
+	    int status;
+	    waitpid(pid, &status, 0);
+	    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+		fprintf(stderr, "ERROR: Bench of %s failed\n", file_path);
+		result = 1;
+	    }
+	}
+    }
+    return result;
+}
+
+/**
+ * @brief Décodeur d'origine de open_level : un nombre de trois chiffres au plus, puis atoi.
+ *
+ * Il attend le texte sans blancs, tel que xml_load le produisait.
+ */
+static void bench_csv_atoi(const char *text, int32_t *tiles, size_t count) {
+    size_t index = 0;
+    for (size_t i = 0; i < count; i++) {
+	char number[4];
+	int num_index = 0;
+	while (isdigit(text[index])) {
+	    number[num_index++] = text[index++];
+	}
+	number[num_index] = '\0';
+	index++;
+	tiles[i] = atoi(number);
+    }
+}
+
+/**
+ * @brief Décodeur octet par octet sans validation (celui du LevelReader avant le décodeur SWAR).
+ */
+static void bench_csv_scalar(const char *text, size_t size, int32_t *tiles, size_t count) {
+    size_t tile = 0;
+    int value = 0;
+    bool digits = false;
+    for (size_t i = 0; i < size; i++) {
+	char c = text[i];
+	if (c >= '0' && c <= '9') {
+	    value = value * 10 + (c - '0');
+	    digits = true;
+	} else if (digits) {
+	    if (tile < count) tiles[tile] = value;
+	    tile++;
+	    value = 0;
+	    digits = false;
+	}
+    }
+    if (digits && tile < count) tiles[tile] = value;
+}
+
+static bool bench_csv_swar(const char *text, size_t size, int32_t *tiles, size_t count, size_t chunk) {
+    LevelCsv csv;
+    level_csv_init(&csv, tiles, count);
+    for (size_t i = 0; i < size; i += chunk) {
+	size_t n = size - i < chunk ? size - i : chunk;
+	if (!level_csv_feed(&csv, text + i, n)) break;
+    }
+    if (!level_csv_finish(&csv)) {
+	fprintf(stderr, "ERROR: csv: %s at byte %zu\n", csv.error, csv.offset);
+	return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Compare les décodeurs du texte CSV des tuiles sur une carte synthétique.
+ */
+static int bench_csv(int argc, char **argv) {
+    size_t tiles_count = argc > 0 ? strtoul(argv[0], NULL, 10) : (1 << 20);
+    int max_value = argc > 1 ? atoi(argv[1]) : 39;
+    size_t iterations = argc > 2 ? strtoul(argv[2], NULL, 10) : 5;
+    size_t width = 1024;
+    size_t height = (tiles_count + width - 1) / width;
+    tiles_count = width * height;
+
+    // même mise en forme que level_save_xml : une ligne de la carte par ligne de texte
+    char *text = array_create_init(tiles_count * 3, sizeof(char));
+    char *stripped = array_create_init(tiles_count * 3, sizeof(char));
+    char number[16];
+    srand(42);
+    for (size_t i = 0; i < tiles_count; i++) {
+	int n = snprintf(number, sizeof(number), "%d", rand() % 4 == 0 ? rand() % max_value : 0);
+	for (int j = 0; j < n; j++) {
+	    array_push(text, number[j]);
+	    array_push(stripped, number[j]);
+	}
+	if (i != tiles_count - 1) {
+	    array_push(text, ',');
+	    array_push(stripped, ',');
+	    if ((i + 1) % width == 0) array_push(text, '\n');
+	}
+    }
+    array_push(stripped, '\0');
+    size_t size = array_size(text);
+    double mb = size / (1024.0 * 1024.0);
+
+    int32_t *expected = malloc(sizeof(int32_t) * tiles_count);
+    int32_t *tiles = malloc(sizeof(int32_t) * tiles_count);
+    bench_csv_scalar(text, size, expected, tiles_count);
+    printf("csv: %zux%zu tiles, 1 in 4 non-empty, values < %d, %.1f MB, %zu iterations\n", width, height, max_value, mb, iterations);
+    printf("%-16s %10s %10s %10s\n", "decoder", "ms", "MB/s", "Mtiles/s");
+
+    const char *names[] = {"atoi", "scalar", "swar", "swar 16K chunks"};
+    for (size_t d = 0; d < 4; d++) {
+	// le décodeur d'origine ne lit que trois chiffres
+	if (d == 0 && max_value > 1000) continue;
+
+	double best = 1e9;
+	for (size_t it = 0; it < iterations; it++) {
+	    memset(tiles, 0xFF, sizeof(int32_t) * tiles_count);
+	    double start = bench_time();
+	    switch (d) {
+	    case 0: bench_csv_atoi(stripped, tiles, tiles_count); break;
+	    case 1: bench_csv_scalar(text, size, tiles, tiles_count); break;
+	    case 2: if (!bench_csv_swar(text, size, tiles, tiles_count, size)) return 1; break;
+	    case 3: if (!bench_csv_swar(text, size, tiles, tiles_count, 16 * 1024)) return 1; break;
+	    }
+	    double elapsed = bench_time() - start;
+	    if (elapsed < best) best = elapsed;
+	}
+
+	if (memcmp(tiles, expected, sizeof(int32_t) * tiles_count) != 0) {
+	    fprintf(stderr, "ERROR: %s decoded different tiles\n", names[d]);
+	    return 1;
+	}
+	printf("%-16s %10.2f %10.1f %10.1f\n", names[d], best * 1e3, mb / best, tiles_count / best / 1e6);
+    }
+
+    free(expected);
+    free(tiles);
+    array_free(text);
+    array_free(stripped);
+    return 0;
+}
+
+/**
+ * @brief Construction d'origine du texte CSV de plug_save : sprintf puis strcat à la fin de la chaîne.
+ *
+ * Chaque strcat reparcourt toute la chaîne déjà écrite, le coût est quadratique.
+ */
+static char *bench_save_strcat(const Level *level) {
+    size_t count = (size_t)level->width * level->height;
+    char *text = malloc(count * 12 + 1);
+    text[0] = '\0';
+    for (size_t i = 0; i < count; i++) {
+	char number[12];
+	sprintf(number, "%d", level->tiles[i]);
+	strcat(text, number);
+	if (i != count - 1) {
+	    strcat(text, ",");
+	    if ((i + 1) % level->width == 0) strcat(text, "\n");
+	}
+    }
+    return text;
+}
+
+/**
+ * @brief Compare l'ancienne construction du texte CSV (strcat) à level_save_xml (Buffer, une seule écriture).
+ */
+static int bench_save(int argc, char **argv) {
+    size_t tiles_count = argc > 0 ? strtoul(argv[0], NULL, 10) : 100000;
+    size_t iterations = argc > 1 ? strtoul(argv[1], NULL, 10) : 3;
+    const char *file_path = argc > 2 ? argv[2] : "/tmp/lemmings-bench-save.xml";
+    int width = 400;
+    int height = (tiles_count + width - 1) / width;
+
+    Level level;
+    level_init(&level, width, height);
+    srand(42);
+    for (size_t i = 0; i < (size_t)width * height; i++) {
+	level.tiles[i] = rand() % 4 == 0 ? rand() % 39 : 0;
+    }
+    for (int i = 0; i < BENCH_PLAYERS; i++) {
+	level_add_entity(&level, (LevelEntity){LEVEL_ENTITY_PLAYER, rand() % width, rand() % height});
+    }
+    printf("save: %dx%d tiles, %zu iterations\n", width, height, iterations);
+
+    double best_strcat = 1e9, best_save = 1e9;
+    for (size_t it = 0; it < iterations; it++) {
+	double start = bench_time();
+	char *text = bench_save_strcat(&level);
+	double elapsed = bench_time() - start;
+	free(text);
+	if (elapsed < best_strcat) best_strcat = elapsed;
+
+	start = bench_time();
+	if (!level_save_xml(&level, file_path)) return 1;
+	elapsed = bench_time() - start;
+	if (elapsed < best_save) best_save = elapsed;
+    }
+
+    Level loaded;
+    if (!level_load_xml(&loaded, file_path)) return 1;
+    bool same = loaded.width == width && loaded.height == height
+	&& memcmp(loaded.tiles, level.tiles, sizeof(int32_t) * width * height) == 0;
+    level_free(&loaded);
+    level_free(&level);
+    if (!same) {
+	fprintf(stderr, "ERROR: %s does not match the saved level\n", file_path);
+	return 1;
+    }
+
+    printf("%-24s %10s\n", "writer", "ms");
+    printf("%-24s %10.2f\n", "strcat (csv only)", best_strcat * 1e3);
+    printf("%-24s %10.2f\n", "level_save_xml", best_save * 1e3);
+    return 0;
+}
+
+/**
+ * @brief Écrit `count` niveaux XML dans `dir`, sauf s'ils existent déjà.
+ */
+static bool bench_index_generate(const char *dir, size_t count) {
+    mkdir(dir, 0777);
+    char path[256];
+    srand(42);
+    for (size_t i = 0; i < count; i++) {
+	snprintf(path, sizeof(path), "%s/level%05zu.xml", dir, i);
+	struct stat st;
+	if (stat(path, &st) == 0) continue;
+
+	FILE *file = fopen(path, "w");
+	if (!file) {
+	    fprintf(stderr, "ERROR: Could not fopen the file %s\n", path);
+	    return false;
+	}
+	fprintf(file, "<root>\n<csv>\n");
+	for (size_t t = 0; t < BENCH_TILESX * BENCH_TILESY; t++) {
+	    fprintf(file, "%d", rand() % 8 == 0 ? LEVEL_TILE_COIN : 0);
+	    if (t == BENCH_TILESX * BENCH_TILESY - 1) continue;
+	    fputc(',', file);
+	    if ((t + 1) % BENCH_TILESX == 0) fputc('\n', file);
+	}
+	fprintf(file, "\n</csv>\n");
+	for (size_t p = 0; p < BENCH_PLAYERS; p++) {
+	    fprintf(file, "<player x=\"%d\" y=\"%d\"/>\n", rand() % BENCH_TILESX, rand() % BENCH_TILESY);
+	}
+	fprintf(file, "</root>\n");
+	fclose(file);
+    }
+    return true;
+}
+
+/**
+ * @brief Mesure l'ouverture de l'index d'un répertoire de niveaux : sans fichier d'index,
+ * avec un index à jour, puis après la modification de quelques niveaux.
+ */
+static int bench_index(int argc, char **argv) {
+    size_t count = argc > 0 ? strtoul(argv[0], NULL, 10) : 10000;
+    const char *dir = argc > 1 ? argv[1] : "/tmp/lemmings-bench-levels";
+    size_t touched = count < 10 ? count : 10;
+    if (!bench_index_generate(dir, count)) return 1;
+
+    char path[256];
+    snprintf(path, sizeof(path), "%s/%s", dir, CATALOG_FILE);
+    unlink(path);
+
+    printf("index: %s, %zu levels\n", dir, count);
+    printf("%-18s %10s %10s %10s\n", "open", "ms", "levels", "parsed");
+    const char *names[] = {"no index", "up to date", "10 levels touched"};
+    for (size_t run = 0; run < 3; run++) {
+	if (run == 2) {
+	    for (size_t i = 0; i < touched; i++) {
+		snprintf(path, sizeof(path), "%s/level%05zu.xml", dir, i * (count / touched));
+		utime(path, NULL);
+	    }
+	}
+
+	Catalog catalog;
+	double start = bench_time();
+	if (!catalog_open(&catalog, dir, false)) return 1;
+	double elapsed = bench_time() - start;
+	printf("%-18s %10.2f %10zu %10zu\n", names[run], elapsed * 1e3, catalog_count(&catalog), catalog.parsed);
+
+	if (run == 0) {
+	    size_t players = 0, coins = 0;
+	    for (size_t i = 0; i < catalog_count(&catalog); i++) {
+		players += catalog.entries[i].players;
+		coins += catalog.entries[i].coins;
+	    }
+	    if (players != count * BENCH_PLAYERS) {
+		fprintf(stderr, "ERROR: Expected %zu players, found %zu\n", count * BENCH_PLAYERS, players);
+		return 1;
+	    }
+	}
+	catalog_close(&catalog);
+    }
+    return 0;
+}
+
+/**
+ * @brief Compare le chargement séquentiel de tous les niveaux d'un répertoire avec library_open.
+ */
+static int bench_library(int argc, char **argv) {
+    size_t count = argc > 0 ? strtoul(argv[0], NULL, 10) : 10000;
+    size_t threads = argc > 1 ? strtoul(argv[1], NULL, 10) : library_default_threads();
+    size_t capacity = argc > 2 ? strtoul(argv[2], NULL, 10) : 0;
+    const char *dir = argc > 3 ? argv[3] : "/tmp/lemmings-bench-levels";
+    if (!bench_index_generate(dir, count)) return 1;
+
+    char **paths = xml_get_filepaths(dir);
+    size_t total = array_size(paths);
+    printf("library: %s, %zu levels, %zu threads\n", dir, total, threads);
+    printf("%-18s %10s %12s %10s\n", "loader", "ms", "levels/s", "entities");
+
+    size_t entities = 0;
+    double start = bench_time();
+    for (size_t i = 0; i < total; i++) {
+	Level level;
+	if (!level_load(&level, paths[i])) return 1;
+	entities += level.entity_count;
+	level_free(&level);
+    }
+    double elapsed = bench_time() - start;
+    printf("%-18s %10.2f %12.0f %10zu\n", "sequential", elapsed * 1e3, total / elapsed, entities);
+
+    size_t runs[] = {1, threads};
+    for (size_t r = 0; r < 2; r++) {
+	Library library;
+	size_t expected = entities;
+	entities = 0;
+	start = bench_time();
+	library_open(&library, (const char *const *)paths, total, runs[r], capacity);
+	LibraryResult result;
+	while (library_next(&library, &result)) {
+	    if (!result.ok) return 1;
+	    entities += result.level.entity_count;
+	    level_free(&result.level);
+	}
+	library_close(&library);
+	elapsed = bench_time() - start;
+
+	char name[32];
+	snprintf(name, sizeof(name), "library x%zu", runs[r]);
+	printf("%-18s %10.2f %12.0f %10zu\n", name, elapsed * 1e3, total / elapsed, entities);
+	if (entities != expected) {
+	    fprintf(stderr, "ERROR: Expected %zu entities, found %zu\n", expected, entities);
+	    return 1;
+	}
+    }
+
+    for (size_t i = 0; i < total; i++) free(paths[i]);
+    array_free(paths);
+    return 0;
+}
+
+/**
+ * @brief File d'attente d'origine : array_push à la fin, array_pop_front au début (memmove).
+ *
+ * Remplit la file jusqu'à `depth` éléments, puis retire et ajoute un élément
+ * `operations` fois. Renvoie la somme des éléments retirés.
+ */
+static uint64_t bench_deque_array(size_t depth, size_t operations) {
+    uint32_t *queue = array_create_init(depth, sizeof(uint32_t));
+    uint64_t sum = 0;
+    for (size_t i = 0; i < depth; i++) array_push(queue, (uint32_t)i);
+    for (size_t i = depth; i < depth + operations; i++) {
+	sum += queue[0];
+	array_pop_front(queue);
+	array_push(queue, (uint32_t)i);
+    }
+    array_free(queue);
+    return sum;
+}
+
+/**
+ * @brief Même file d'attente avec deque_push_back et deque_pop_front.
+ */
+static uint64_t bench_deque_ring(size_t depth, size_t operations) {
+    uint32_t *queue = NULL;
+    uint64_t sum = 0;
+    for (size_t i = 0; i < depth; i++) deque_push_back(queue, (uint32_t)i);
+    for (size_t i = depth; i < depth + operations; i++) {
+	sum += deque_front(queue);
+	deque_pop_front(queue);
+	deque_push_back(queue, (uint32_t)i);
+    }
+    deque_free(queue);
+    return sum;
+}
+
+/**
+ * @brief Compare une file d'attente sur Array (memmove à chaque retrait) et sur Deque, à plusieurs profondeurs.
+ */
+static int bench_deque(int argc, char **argv) {
+    size_t operations = argc > 0 ? strtoul(argv[0], NULL, 10) : 1000000;
+    size_t max_depth = argc > 1 ? strtoul(argv[1], NULL, 10) : 4096;
+    printf("deque: %zu pop/push per depth, uint32_t elements\n", operations);
+    printf("%-8s %12s %12s %10s\n", "depth", "array ms", "deque ms", "speedup");
+
+    for (size_t depth = 1; depth <= max_depth; depth *= 16) {
+	double start = bench_time();
+	uint64_t expected = bench_deque_array(depth, operations);
+	double array = bench_time() - start;
+
+	start = bench_time();
+	uint64_t sum = bench_deque_ring(depth, operations);
+	double deque = bench_time() - start;
+
+	if (sum != expected) {
+	    fprintf(stderr, "ERROR: The deque popped %llu, the array %llu\n", (unsigned long long)sum, (unsigned long long)expected);
+	    return 1;
+	}
+	printf("%-8zu %12.2f %12.2f %9.1fx\n", depth, array * 1e3, deque * 1e3, array / deque);
+    }
+    return 0;
+}
+
+// place réservée à chaque chemin des tables de bench_map
+#define BENCH_MAP_NAME 48
+
+/**
+ * @struct BenchIntEntry
+ * @brief Entrée d'une table à clé entière.
+ */
+typedef struct {
+    uint64_t key;   /**< Clé. */
+    uint32_t value; /**< Position de la clé dans la liste de départ. */
+} BenchIntEntry;
+
+/**
+ * @struct BenchStrEntry
+ * @brief Entrée d'une table à clé chaîne (un chemin de niveau).
+ */
+typedef struct {
+    const char *key; /**< Clé. */
+    uint32_t value;  /**< Position de la clé dans la liste de départ. */
+} BenchStrEntry;
+
+/**
+ * @brief Compare la recherche par parcours d'un tableau et par une table (map_get), avec des clés entières et des chemins.
+ */
+static int bench_map(int argc, char **argv) {
+    size_t lookups = argc > 0 ? strtoul(argv[0], NULL, 10) : 1000000;
+    size_t max_entries = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+    static const size_t sizes[] = {10, 1000, 1000000};
+    printf("map: %zu lookups per size (fewer for the scans of large sizes), ns per operation\n", lookups);
+    printf("%-8s %10s %10s %10s %10s %10s %10s\n", "entries", "int scan", "int map", "str scan", "str map", "int put", "str put");
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]) && sizes[s] <= max_entries; s++) {
+	size_t n = sizes[s];
+	BenchIntEntry *ints = malloc(n * sizeof(BenchIntEntry));
+	BenchStrEntry *strs = malloc(n * sizeof(BenchStrEntry));
+	char *names = malloc(n * BENCH_MAP_NAME);
+	uint32_t *queries = malloc(lookups * sizeof(uint32_t));
+	if (!ints || !strs || !names || !queries) {
+	    fprintf(stderr, "ERROR: Could not allocate %zu entries\n", n);
+	    return 1;
+	}
+	for (size_t i = 0; i < n; i++) {
+	    ints[i] = (BenchIntEntry){(uint64_t)i * 2654435761u, (uint32_t)i};
+	    snprintf(names + i * BENCH_MAP_NAME, BENCH_MAP_NAME, "levels/level-%zu.xml", i);
+	    strs[i] = (BenchStrEntry){names + i * BENCH_MAP_NAME, (uint32_t)i};
+	}
+	uint64_t expected = 0;
+	for (size_t i = 0; i < lookups; i++) queries[i] = (uint32_t)(rand() % n);
+
+	// un parcours de 1M entrées par recherche : le nombre de parcours est borné
+	size_t scans = n * lookups > 100000000 ? 100000000 / n : lookups;
+	for (size_t i = 0; i < scans; i++) expected += queries[i];
+
+	double start = bench_time();
+	uint64_t int_scan_sum = 0;
+	for (size_t q = 0; q < scans; q++) {
+	    uint64_t key = (uint64_t)queries[q] * 2654435761u;
+	    for (size_t i = 0; i < n; i++) {
+		if (ints[i].key == key) {
+		    int_scan_sum += ints[i].value;
+		    break;
+		}
+	    }
+	}
+	double int_scan = (bench_time() - start) / scans;
+
+	start = bench_time();
+	uint64_t str_scan_sum = 0;
+	for (size_t q = 0; q < scans; q++) {
+	    const char *key = names + queries[q] * BENCH_MAP_NAME;
+	    for (size_t i = 0; i < n; i++) {
+		if (strcmp(strs[i].key, key) == 0) {
+		    str_scan_sum += strs[i].value;
+		    break;
+		}
+	    }
+	}
+	double str_scan = (bench_time() - start) / scans;
+
+	start = bench_time();
+	BenchIntEntry *int_map = map_create_init(0, sizeof(BenchIntEntry), sizeof(uint64_t));
+	for (size_t i = 0; i < n; i++) map_put(int_map, ints[i]);
+	double int_put = (bench_time() - start) / n;
+
+	start = bench_time();
+	BenchStrEntry *str_map = map_create_init(0, sizeof(BenchStrEntry), MAP_KEY_STRING);
+	for (size_t i = 0; i < n; i++) map_put(str_map, strs[i]);
+	double str_put = (bench_time() - start) / n;
+
+	start = bench_time();
+	uint64_t int_map_sum = 0;
+	for (size_t q = 0; q < lookups; q++) {
+	    uint64_t key = (uint64_t)queries[q] * 2654435761u;
+	    BenchIntEntry *entry = map_get(int_map, &key);
+	    if (entry) int_map_sum += entry->value;
+	}
+	double int_lookup = (bench_time() - start) / lookups;
+
+	start = bench_time();
+	uint64_t str_map_sum = 0;
+	for (size_t q = 0; q < lookups; q++) {
+	    BenchStrEntry *entry = map_get(str_map, names + queries[q] * BENCH_MAP_NAME);
+	    if (entry) str_map_sum += entry->value;
+	}
+	double str_lookup = (bench_time() - start) / lookups;
+
+	uint64_t expected_all = 0;
+	for (size_t i = 0; i < lookups; i++) expected_all += queries[i];
+	if (int_scan_sum != expected || str_scan_sum != expected || int_map_sum != expected_all || str_map_sum != expected_all) {
+	    fprintf(stderr, "ERROR: The lookups of %zu entries disagree\n", n);
+	    return 1;
+	}
+	printf("%-8zu %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f\n", n,
+	       int_scan * 1e9, int_lookup * 1e9, str_scan * 1e9, str_lookup * 1e9, int_put * 1e9, str_put * 1e9);
+
+	map_free(int_map);
+	map_free(str_map);
+	free(queries);
+	free(names);
+	free(strs);
+	free(ints);
+    }
+    return 0;
+}
+
+/**
+ * @brief Ajoute au tampon les commandes d'une frame de jeu : le fond, les tuiles non
+ * vides puis les joueurs, tournés alternativement à gauche et à droite.
+ *
+ * Les textures ne sont pas chargées : seul leur id compte pour le tri et les lots.
+ */
+static void bench_render_frame(RenderBuffer *rb, const Level *level) {
+    Texture2D background = {.id = 1, .width = 120, .height = 70};
+    Texture2D tileset = {.id = 2};
+    Texture2D players[2] = {{.id = 3}, {.id = 4}};
+
+    render_begin(rb);
+    render_push(rb, LAYER_BACKGROUND, background, (Rectangle){0, 0, background.width, background.height},
+		(Rectangle){0, 0, background.width * 6.67f, background.height * 6.67f}, WHITE);
+    for (int y = 0; y < level->height; y++) {
+	for (int x = 0; x < level->width; x++) {
+	    int tile = level->tiles[y * level->width + x];
+	    if (!tile) continue;
+	    Rectangle source = {(tile % 4) * BENCH_TILE_SIZE, (tile / 4 % 8) * BENCH_TILE_SIZE, BENCH_TILE_SIZE, BENCH_TILE_SIZE};
+	    render_push_rec(rb, LAYER_TILES, tileset, source, (Vector2){x * BENCH_TILE_SIZE, y * BENCH_TILE_SIZE}, WHITE);
+	}
+    }
+    for (size_t i = 0; i < level->entity_count; i++) {
+	Vector2 position = {level->entities[i].x * BENCH_TILE_SIZE - 12, level->entities[i].y * BENCH_TILE_SIZE - 12};
+	render_push_rec(rb, LAYER_ENTITIES, players[i % 2], (Rectangle){0, 0, 48, 48}, position, WHITE);
+    }
+    render_flush(rb);
+}
+
+static int bench_render_order_cmp(const void *a, const void *b) {
+    const RenderCommand *ca = a;
+    const RenderCommand *cb = b;
+    return ca->order < cb->order ? -1 : ca->order > cb->order;
+}
+
+/**
+ * @brief Compte les paires de sprites d'une même couche qui se chevauchent et sont
+ * dessinées dans l'ordre inverse de leur soumission.
+ */
+static size_t bench_render_inversions(const RenderCommand *commands) {
+    size_t inversions = 0;
+    for (size_t i = 0; i < array_size(commands); i++) {
+	for (size_t j = i + 1; j < array_size(commands); j++) {
+	    const RenderCommand *a = &commands[i];
+	    const RenderCommand *b = &commands[j];
+	    if (a->layer != b->layer || a->order < b->order) continue;
+	    if (a->dest.x < b->dest.x + b->dest.width && b->dest.x < a->dest.x + a->dest.width
+		&& a->dest.y < b->dest.y + b->dest.height && b->dest.y < a->dest.y + a->dest.height) {
+		inversions++;
+	    }
+	}
+    }
+    return inversions;
+}
+
+/**
+ * @brief Enregistre des frames d'un niveau avec le backend NULL de render.h et affiche
+ * le nombre de lots, comparé à une soumission dans l'ordre d'ajout.
+ *
+ * Sans fichier, le niveau est généré à la taille de l'écran avec `players` joueurs.
+ */
+static int bench_render(int argc, char **argv) {
+    size_t players = argc > 0 ? strtoul(argv[0], NULL, 10) : 64;
+    size_t iterations = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000;
+
+    Level level;
+    if (argc > 2) {
+	if (!level_load(&level, argv[2])) return 1;
+    } else {
+	level_init(&level, BENCH_TILESX, BENCH_TILESY);
+	srand(42);
+	for (size_t i = 0; i < BENCH_TILESX * BENCH_TILESY; i++) {
+	    level.tiles[i] = rand() % 4 == 0 ? rand() % 39 : 0;
+	}
+	for (size_t i = 0; i < players; i++) {
+	    level_add_entity(&level, (LevelEntity){LEVEL_ENTITY_PLAYER, rand() % BENCH_TILESX, rand() % BENCH_TILESY});
+	}
+    }
+    printf("render: %dx%d tiles, %zu players, %zu iterations\n", level.width, level.height, level.entity_count, iterations);
+
+    RenderBuffer rb;
+    render_init(&rb, RENDER_BACKEND_NULL);
+    double best = 1e9;
+    for (size_t it = 0; it < iterations; it++) {
+	double start = bench_time();
+	bench_render_frame(&rb, &level);
+	double elapsed = bench_time() - start;
+	if (elapsed < best) best = elapsed;
+    }
+
+    // lots qu'aurait donnés une soumission sans tri
+    size_t count = array_size(rb.recorded);
+    RenderCommand *submitted = malloc(count * sizeof(RenderCommand));
+    memcpy(submitted, rb.recorded, count * sizeof(RenderCommand));
+    qsort(submitted, count, sizeof(RenderCommand), bench_render_order_cmp);
+    size_t unsorted = 0;
+    for (size_t i = 0; i < count; i++) {
+	if (i == 0 || submitted[i].texture.id != submitted[i - 1].texture.id
+	    || submitted[i].shader.id != submitted[i - 1].shader.id) unsorted++;
+    }
+    free(submitted);
+
+    printf("%-32s %10zu\n", "commands", rb.stats.commands);
+    printf("%-32s %10zu\n", "batches", rb.stats.batches);
+    printf("%-32s %10zu\n", "batches in submission order", unsorted);
+    size_t inversions = bench_render_inversions(rb.recorded);
+    printf("%-32s %10zu\n", "overlapping sprites reordered", inversions);
+    printf("%-32s %10.2f\n", "us per frame", best * 1e6);
+
+    render_free(&rb);
+    level_free(&level);
+    if (inversions) {
+	fprintf(stderr, "ERROR: %zu overlapping sprites were drawn out of submission order\n", inversions);
+	return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Compare deux noms de fichiers pour qsort.
+ */
+static int bench_fixtures_compare(const void *a, const void *b) {
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+/**
+ * @brief Charge chaque fichier de `fixtures/` avec xml_load, xml_view_load, l'analyseur en flux et, pour un niveau, level_load.
+ *
+ * Un fichier `ok-*.xml` doit être accepté et un fichier `bad-*.xml` refusé (les
+ * analyseurs affichent alors leur erreur) ; level_load n'est essayé que si le
+ * nom contient `level`.
+ */
+static int bench_fixtures(int argc, char **argv) {
+    const char *dir_path = argc > 0 ? argv[0] : "fixtures";
+    DIR *dir = opendir(dir_path);
+    if (dir == NULL) {
+	fprintf(stderr, "ERROR: Could not open the directory %s: %s\n", dir_path, strerror(errno));
+	return 1;
+    }
+    char **names = array_create_init(16, sizeof(char *));
+    struct dirent *ent;
+    while ((ent = readdir(dir)) != NULL) {
+	if (strncmp(ent->d_name, "ok-", 3) != 0 && strncmp(ent->d_name, "bad-", 4) != 0) continue;
+	char *name = strdup(ent->d_name);
+	array_push(names, name);
+    }
+    closedir(dir);
+    qsort(names, array_size(names), sizeof(char *), bench_fixtures_compare);
+
+    printf("%-32s %-6s %-6s %-6s %s\n", "fixture", "dom", "view", "sax", "level");
+    size_t failures = 0;
+    for (size_t i = 0; i < array_size(names); i++) {
+	char path[512];
+	snprintf(path, sizeof(path), "%s/%s", dir_path, names[i]);
+	bool expected = strncmp(names[i], "ok-", 3) == 0;
+
+	XMLDocument doc;
+	bool dom = xml_load(&doc, path);
+	if (dom) xml_doc_free(&doc);
+	XMLView view;
+	bool mapped = xml_view_load(&view, path);
+	if (mapped) xml_view_free(&view);
+	bool sax = xml_sax_parse_file(path, (XMLSaxHandler){0});
+	bool is_level = strstr(names[i], "level") != NULL;
+	Level level;
+	bool loaded = is_level && level_load(&level, path);
+	if (loaded) level_free(&level);
+
+	bool ok = dom == expected && mapped == expected && sax == expected && (!is_level || loaded == expected);
+	if (!ok) failures++;
+	printf("%-32s %-6s %-6s %-6s %s%s\n", names[i], dom ? "ok" : "fail", mapped ? "ok" : "fail", sax ? "ok" : "fail",
+	       is_level ? (loaded ? "ok" : "fail") : "-", ok ? "" : " (unexpected)");
+	free(names[i]);
+    }
+    array_free(names);
+
+    if (failures) {
+	fprintf(stderr, "ERROR: %zu fixtures gave an unexpected result\n", failures);
+	return 1;
+    }
+    return 0;
+}
+
+/**
+ * @struct Bench
+ * @brief Sous-commande du programme de mesure.
+ */
+typedef struct {
+    const char *name;                /**< Nom de la sous-commande. */
+    const char *usage;               /**< Arguments acceptés. */
+    int (*run)(int argc, char **argv); /**< Point d'entrée, avec les arguments qui suivent le nom. */
+} Bench;
+
+static const Bench benches[] = {
+    {"xml", "[megabytes] [iterations] [file]", bench_xml},
+    {"query", "[megabytes] [queries] [file]", bench_query},
+    {"corpus", "[max megabytes] [iterations] [directory]", bench_corpus},
+    {"csv", "[tiles] [max value] [iterations]", bench_csv},
+    {"save", "[tiles] [iterations] [file]", bench_save},
+    {"index", "[levels] [directory]", bench_index},
+    {"library", "[levels] [threads] [in flight] [directory]", bench_library},
+    {"deque", "[operations] [max depth]", bench_deque},
+    {"map", "[lookups] [max entries]", bench_map},
+    {"render", "[players] [iterations] [level]", bench_render},
+    {"fixtures", "[directory]", bench_fixtures},
+};
+
+#define BENCH_COUNT (sizeof(benches) / sizeof(benches[0]))
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+	fprintf(stderr, "usage: %s <bench> [args...]\n", argv[0]);
+	for (size_t i = 0; i < BENCH_COUNT; i++) {
+	    fprintf(stderr, "    %s %s\n", benches[i].name, benches[i].usage);
+	}
+	return 1;
+    }
+
+    for (size_t i = 0; i < BENCH_COUNT; i++) {
+	if (strcmp(argv[1], benches[i].name) == 0) {
+	    return benches[i].run(argc - 2, argv + 2);
+	}
+    }
+
+    fprintf(stderr, "ERROR: Unknown bench %s\n", argv[1]);
+    return 1;
+}
@@ -0,0 +1,147 @@
+/* -*- compile-command: "make -C .. libplug" -*- */
+#include "buffer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <limits.h>
+
+void buffer_init(Buffer *buffer, size_t capacity) {
+    buffer->data = malloc(capacity ? capacity : 1);
+    buffer->size = 0;
+    buffer->capacity = capacity ? capacity : 1;
+    if (!buffer->data) {
+	fprintf(stderr, "ERROR: Could not allocate a buffer of %zu bytes: %s\n", capacity, strerror(errno));
+	exit(1);
+    }
+}
+
+void buffer_reserve(Buffer *buffer, size_t size) {
+    if (buffer->size + size <= buffer->capacity) return;
+    size_t capacity = 2 * buffer->capacity;
+    if (capacity < buffer->size + size) capacity = buffer->size + size;
+    char *data = realloc(buffer->data, capacity);
+    if (!data) {
+	fprintf(stderr, "ERROR: Could not grow a buffer to %zu bytes: %s\n", capacity, strerror(errno));
+	exit(1);
+    }
+    buffer->data = data;
+    buffer->capacity = capacity;
+}
+
+void buffer_append(Buffer *buffer, const char *data, size_t size) {
+    buffer_reserve(buffer, size);
+    memcpy(buffer->data + buffer->size, data, size);
+    buffer->size += size;
+}
+
+void buffer_append_cstr(Buffer *buffer, const char *str) {
+    buffer_append(buffer, str, strlen(str));
+}
+
+void buffer_append_char(Buffer *buffer, char c) {
+    buffer_reserve(buffer, 1);
+    buffer->data[buffer->size++] = c;
+}
+
+void buffer_append_repeat(Buffer *buffer, char c, size_t count) {
+    buffer_reserve(buffer, count);
+    memset(buffer->data + buffer->size, c, count);
+    buffer->size += count;
+}
+
+void buffer_append_int(Buffer *buffer, int value) {
+    // chiffres écrits depuis la fin, au plus 10 chiffres et le signe
+    char digits[11];
+    size_t n = sizeof(digits);
+    unsigned int u = value < 0 ? -(unsigned int)value : (unsigned int)value;
+    do {
+	digits[--n] = '0' + u % 10;
+	u /= 10;
+    } while (u);
+    if (value < 0) digits[--n] = '-';
+    buffer_append(buffer, digits + n, sizeof(digits) - n);
+}
+
+const char *buffer_cstr(Buffer *buffer) {
+    buffer_reserve(buffer, 1);
+    buffer->data[buffer->size] = '\0';
+    return buffer->data;
+}
+
+/**
+ * @brief Force l'écriture sur le disque du répertoire qui contient `file_path`, pour que le renommage survive à une coupure.
+ */
+static void buffer_sync_dir(const char *file_path) {
+    const char *slash = strrchr(file_path, '/');
+    char dir_path[PATH_MAX] = ".";
+    if (slash) {
+	size_t size = slash == file_path ? 1 : (size_t)(slash - file_path);
+	if (size >= sizeof(dir_path)) return;
+	memcpy(dir_path, file_path, size);
+	dir_path[size] = '\0';
+    }
+
+    int fd = open(dir_path, O_RDONLY | O_DIRECTORY);
+    if (fd == -1) return;
+    fsync(fd);
+    close(fd);
+}
+
+bool buffer_write_file(const Buffer *buffer, const char *file_path) {
+    // Le contenu est écrit dans un fichier temporaire renommé à la fin : une
+    // écriture interrompue ne laisse jamais un fichier tronqué à `file_path`.
+    char tmp_path[PATH_MAX];
+    if (snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", file_path) >= (int)sizeof(tmp_path)) {
+	fprintf(stderr, "ERROR: File path too long: %s\n", file_path);
+	return false;
+    }
+
+    int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (fd == -1) {
+	fprintf(stderr, "ERROR: Could not open the file %s: %s\n", tmp_path, strerror(errno));
+	return false;
+    }
+
+    // write peut écrire moins que demandé : on boucle jusqu'à la fin du tampon
+    bool result = true;
+    size_t written = 0;
+    while (result && written < buffer->size) {
+	ssize_t n = write(fd, buffer->data + written, buffer->size - written);
+	if (n >= 0) {
+	    written += n;
+	} else if (errno != EINTR) {
+	    fprintf(stderr, "ERROR: Could not write the file %s: %s\n", tmp_path, strerror(errno));
+	    result = false;
+	}
+    }
+
+    if (result && fsync(fd) == -1) {
+	fprintf(stderr, "ERROR: Could not sync the file %s: %s\n", tmp_path, strerror(errno));
+	result = false;
+    }
+    if (close(fd) == -1) {
+	fprintf(stderr, "ERROR: Could not close the file %s: %s\n", tmp_path, strerror(errno));
+	result = false;
+    }
+    if (result && rename(tmp_path, file_path) == -1) {
+	fprintf(stderr, "ERROR: Could not rename %s to %s: %s\n", tmp_path, file_path, strerror(errno));
+	result = false;
+    }
+
+    if (result) {
+	buffer_sync_dir(file_path);
+    } else {
+	unlink(tmp_path);
+    }
+    return result;
+}
+
+void buffer_free(Buffer *buffer) {
+    free(buffer->data);
+    buffer->data = NULL;
+    buffer->size = 0;
+    buffer->capacity = 0;
+}
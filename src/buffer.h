@@ -0,0 +1,103 @@
+#ifndef BUFFER_H_
+#define BUFFER_H_
+
+#include <stddef.h>
+#include <stdbool.h>
+
+/**
+ * @struct Buffer
+ * @brief Tampon de sortie extensible : le texte y est construit puis écrit en une fois.
+ */
+typedef struct {
+    char *data;      /**< Contenu du tampon (sans zéro final). */
+    size_t size;     /**< Nombre d'octets écrits. */
+    size_t capacity; /**< Capacité allouée. */
+} Buffer;
+
+/**
+ * @brief Initialise un tampon vide.
+ *
+ * @param buffer Tampon à initialiser.
+ * @param capacity Capacité initiale en octets.
+ */
+void buffer_init(Buffer *buffer, size_t capacity);
+
+/**
+ * @brief Réserve de la place pour au moins `size` octets supplémentaires.
+ *
+ * @param buffer Tampon.
+ * @param size Nombre d'octets à réserver.
+ */
+void buffer_reserve(Buffer *buffer, size_t size);
+
+/**
+ * @brief Ajoute `size` octets à la fin du tampon.
+ *
+ * @param buffer Tampon.
+ * @param data Octets à ajouter.
+ * @param size Nombre d'octets.
+ */
+void buffer_append(Buffer *buffer, const char *data, size_t size);
+
+/**
+ * @brief Ajoute une chaîne terminée par zéro (sans le zéro).
+ *
+ * @param buffer Tampon.
+ * @param str Chaîne à ajouter.
+ */
+void buffer_append_cstr(Buffer *buffer, const char *str);
+
+/**
+ * @brief Ajoute un caractère.
+ *
+ * @param buffer Tampon.
+ * @param c Caractère à ajouter.
+ */
+void buffer_append_char(Buffer *buffer, char c);
+
+/**
+ * @brief Ajoute `count` fois le caractère `c`.
+ *
+ * @param buffer Tampon.
+ * @param c Caractère à répéter.
+ * @param count Nombre de répétitions.
+ */
+void buffer_append_repeat(Buffer *buffer, char c, size_t count);
+
+/**
+ * @brief Ajoute un entier en base 10, sans passer par printf.
+ *
+ * @param buffer Tampon.
+ * @param value Entier à ajouter.
+ */
+void buffer_append_int(Buffer *buffer, int value);
+
+/**
+ * @brief Ajoute un zéro final sans le compter dans la taille, pour lire le tampon comme une chaîne.
+ *
+ * @param buffer Tampon.
+ * @return Le contenu du tampon terminé par zéro.
+ */
+const char *buffer_cstr(Buffer *buffer);
+
+/**
+ * @brief Écrit tout le tampon dans un fichier (le fichier est remplacé).
+ *
+ * Le tampon est écrit dans `file_path` suivi de ".tmp", synchronisé avec fsync
+ * puis renommé : après une coupure, le fichier contient l'ancienne ou la nouvelle
+ * version, jamais un mélange des deux.
+ *
+ * @param buffer Tampon à écrire.
+ * @param file_path Chemin du fichier.
+ * @return `true` si l'écriture est réussie, sinon `false`.
+ */
+bool buffer_write_file(const Buffer *buffer, const char *file_path);
+
+/**
+ * @brief Libère la mémoire du tampon.
+ *
+ * @param buffer Tampon à libérer.
+ */
+void buffer_free(Buffer *buffer);
+
+#endif // BUFFER_H_
@@ -0,0 +1,438 @@
+/* -*- compile-command: "make -C .. libplug" -*- */
+#include "catalog.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/inotify.h>
+
+#include "array.h"
+#include "buffer.h"
+#include "level.h"
+
+#define FNV_OFFSET 14695981039346656037ull
+#define FNV_PRIME 1099511628211ull
+
+// événements qui modifient un niveau du répertoire surveillé
+#define CATALOG_WATCH_MASK (IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE)
+
+/**
+ * @struct CatalogHeader
+ * @brief En-tête du fichier d'index (16 octets), suivi de `count` enregistrements.
+ */
+typedef struct {
+    char magic[4];     /**< CATALOG_MAGIC. */
+    uint32_t version;  /**< CATALOG_VERSION. */
+    uint32_t count;    /**< Nombre d'enregistrements. */
+    uint32_t reserved; /**< Réservé, à zéro. */
+} CatalogHeader;
+
+/**
+ * @struct CatalogRecord
+ * @brief Enregistrement d'un niveau dans le fichier d'index (48 octets), suivi du nom du fichier.
+ */
+typedef struct {
+    int64_t mtime;
+    int64_t size;
+    uint64_t hash;
+    int32_t width;
+    int32_t height;
+    int32_t players;
+    int32_t coins;
+    uint32_t valid;
+    uint32_t name_size; /**< Taille du nom qui suit, sans zéro final ni répertoire. */
+} CatalogRecord;
+
+static char *catalog_path(const char *dir, const char *name) {
+    size_t dir_size = strlen(dir);
+    size_t name_size = strlen(name);
+    char *path = malloc(dir_size + 1 + name_size + 1);
+    memcpy(path, dir, dir_size);
+    path[dir_size] = '/';
+    memcpy(path + dir_size + 1, name, name_size + 1);
+    return path;
+}
+
+static int64_t catalog_mtime(const struct stat *st) {
+    return (int64_t)st->st_mtim.tv_sec * 1000000000 + st->st_mtim.tv_nsec;
+}
+
+static int catalog_compare(const void *a, const void *b) {
+    return strcmp(((const CatalogEntry *)a)->path, ((const CatalogEntry *)b)->path);
+}
+
+/**
+ * @brief Recherche dichotomique d'un chemin dans les entrées triées.
+ *
+ * @param index Position de l'entrée, ou position où l'insérer si elle est absente.
+ * @return `true` si l'entrée existe.
+ */
+static bool catalog_search(const Catalog *catalog, const char *path, size_t *index) {
+    size_t lo = 0, hi = array_size(catalog->entries);
+    while (lo < hi) {
+	size_t mid = lo + (hi - lo) / 2;
+	int cmp = strcmp(catalog->entries[mid].path, path);
+	if (cmp == 0) {
+	    *index = mid;
+	    return true;
+	}
+	if (cmp < 0) lo = mid + 1;
+	else hi = mid;
+    }
+    *index = lo;
+    return false;
+}
+
+static uint64_t catalog_hash_file(const char *path, size_t size) {
+    uint64_t hash = FNV_OFFSET;
+    if (size == 0) return hash;
+
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) return hash;
+    const unsigned char *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return hash;
+
+    for (size_t i = 0; i < size; i++) {
+	hash = (hash ^ data[i]) * FNV_PRIME;
+    }
+    munmap((void *)data, size);
+    return hash;
+}
+
+/**
+ * @brief Ouvre un niveau pour remplir les métadonnées de son entrée.
+ */
+static void catalog_read_entry(Catalog *catalog, CatalogEntry *entry, const struct stat *st) {
+    entry->mtime = catalog_mtime(st);
+    entry->size = st->st_size;
+    entry->hash = catalog_hash_file(entry->path, st->st_size);
+    entry->width = 0;
+    entry->height = 0;
+    entry->players = 0;
+    entry->coins = 0;
+    entry->valid = false;
+    catalog->parsed += 1;
+
+    Level level;
+    if (!level_load(&level, entry->path)) return;
+    entry->width = level.width;
+    entry->height = level.height;
+    for (size_t i = 0; i < level.entity_count; i++) {
+	if (level.entities[i].type == LEVEL_ENTITY_PLAYER) entry->players += 1;
+    }
+    for (size_t i = 0; i < (size_t)level.width * level.height; i++) {
+	if (level.tiles[i] == LEVEL_TILE_COIN) entry->coins += 1;
+    }
+    entry->valid = true;
+    level_free(&level);
+}
+
+static void catalog_clear(Catalog *catalog) {
+    for (size_t i = 0; i < array_size(catalog->entries); i++) {
+	free(catalog->entries[i].path);
+    }
+    array_clear(catalog->entries);
+}
+
+/**
+ * @brief Relit le fichier d'index ; un index absent, d'une autre version ou invalide est ignoré.
+ */
+static void catalog_load(Catalog *catalog) {
+    char *index_path = catalog_path(catalog->dir, CATALOG_FILE);
+    int fd = open(index_path, O_RDONLY);
+    free(index_path);
+    if (fd == -1) return;
+
+    struct stat st;
+    if (fstat(fd, &st) == -1 || (size_t)st.st_size < sizeof(CatalogHeader)) {
+	close(fd);
+	return;
+    }
+    size_t size = st.st_size;
+    const char *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return;
+
+    CatalogHeader header;
+    memcpy(&header, data, sizeof(header));
+    if (memcmp(header.magic, CATALOG_MAGIC, 4) != 0 || header.version != CATALOG_VERSION) {
+	munmap((void *)data, size);
+	return;
+    }
+
+    // Les enregistrements ont été écrits triés par chemin.
+    size_t offset = sizeof(header);
+    for (uint32_t i = 0; i < header.count; i++) {
+	CatalogRecord record;
+	if (size - offset < sizeof(record)) break;
+	memcpy(&record, data + offset, sizeof(record));
+	offset += sizeof(record);
+	if (size - offset < record.name_size) break;
+
+	char *name = malloc(record.name_size + 1);
+	memcpy(name, data + offset, record.name_size);
+	name[record.name_size] = '\0';
+	offset += record.name_size;
+
+	CatalogEntry entry = {
+	    .path = catalog_path(catalog->dir, name),
+	    .mtime = record.mtime,
+	    .size = record.size,
+	    .hash = record.hash,
+	    .width = record.width,
+	    .height = record.height,
+	    .players = record.players,
+	    .coins = record.coins,
+	    .valid = record.valid,
+	};
+	free(name);
+	array_push(catalog->entries, entry);
+    }
+    munmap((void *)data, size);
+
+    // Un index écrit à la main ou tronqué peut ne pas être trié.
+    for (size_t i = 1; i < array_size(catalog->entries); i++) {
+	if (strcmp(catalog->entries[i - 1].path, catalog->entries[i].path) >= 0) {
+	    qsort(catalog->entries, array_size(catalog->entries), sizeof(CatalogEntry), catalog_compare);
+	    break;
+	}
+    }
+}
+
+bool catalog_open(Catalog *catalog, const char *dir, bool watch) {
+    memset(catalog, 0, sizeof(*catalog));
+    catalog->dir = strdup(dir);
+    catalog->entries = array_create_init(16, sizeof(CatalogEntry));
+    catalog->watch = -1;
+
+    if (mkdir(dir, 0777) == -1 && errno != EEXIST) {
+	fprintf(stderr, "ERROR: Could not create a directory: %s\n", strerror(errno));
+	return false;
+    }
+
+    // La surveillance commence avant le parcours pour ne perdre aucun changement.
+    if (watch) {
+	catalog->watch = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (catalog->watch != -1 && inotify_add_watch(catalog->watch, dir, CATALOG_WATCH_MASK) == -1) {
+	    close(catalog->watch);
+	    catalog->watch = -1;
+	}
+	if (catalog->watch == -1) {
+	    fprintf(stderr, "ERROR: Could not watch %s, the level list will not follow external changes: %s\n", dir, strerror(errno));
+	}
+    }
+
+    catalog_load(catalog);
+    bool result = catalog_scan(catalog);
+    if (catalog->dirty) catalog_save(catalog);
+    return result;
+}
+
+bool catalog_scan(Catalog *catalog) {
+    DIR *dir = opendir(catalog->dir);
+    if (dir == NULL) {
+	fprintf(stderr, "ERROR: Could not open the directory %s: %s\n", catalog->dir, strerror(errno));
+	return false;
+    }
+
+    for (size_t i = 0; i < array_size(catalog->entries); i++) {
+	catalog->entries[i].seen = false;
+    }
+
+    // Les nouveaux niveaux sont triés en une fois à la fin, pas insérés un par un.
+    CatalogEntry *added = array_create_init(16, sizeof(CatalogEntry));
+    struct dirent *ent;
+    while ((ent = readdir(dir)) != NULL) {
+	if (level_format(ent->d_name) == LEVEL_FORMAT_UNKNOWN) continue;
+
+	struct stat st;
+	if (fstatat(dirfd(dir), ent->d_name, &st, 0) == -1 || !S_ISREG(st.st_mode)) continue;
+
+	char *path = catalog_path(catalog->dir, ent->d_name);
+	size_t index;
+	if (catalog_search(catalog, path, &index)) {
+	    CatalogEntry *entry = &catalog->entries[index];
+	    entry->seen = true;
+	    if (entry->mtime != catalog_mtime(&st) || entry->size != st.st_size) {
+		catalog_read_entry(catalog, entry, &st);
+		catalog->dirty = true;
+	    }
+	    free(path);
+	} else {
+	    CatalogEntry entry = {.path = path, .seen = true};
+	    catalog_read_entry(catalog, &entry, &st);
+	    array_push(added, entry);
+	}
+    }
+    closedir(dir);
+
+    // Retire les niveaux supprimés depuis le dernier parcours.
+    size_t count = 0;
+    for (size_t i = 0; i < array_size(catalog->entries); i++) {
+	if (catalog->entries[i].seen) {
+	    catalog->entries[count++] = catalog->entries[i];
+	} else {
+	    free(catalog->entries[i].path);
+	    catalog->dirty = true;
+	}
+    }
+    array_resize(catalog->entries, count);
+
+    if (array_size(added)) {
+	for (size_t i = 0; i < array_size(added); i++) {
+	    array_push(catalog->entries, added[i]);
+	}
+	qsort(catalog->entries, array_size(catalog->entries), sizeof(CatalogEntry), catalog_compare);
+	catalog->dirty = true;
+    }
+    array_free(added);
+    return true;
+}
+
+/**
+ * @brief Met à jour l'entrée d'un chemin.
+ *
+ * @return `true` si l'index a changé.
+ */
+static bool catalog_update(Catalog *catalog, const char *path, size_t *index) {
+    // Seuls les fichiers placés directement dans le répertoire font partie de l'index.
+    size_t dir_size = strlen(catalog->dir);
+    if (strncmp(path, catalog->dir, dir_size) != 0 || path[dir_size] != '/' || strchr(path + dir_size + 1, '/')) {
+	return false;
+    }
+
+    bool found = catalog_search(catalog, path, index);
+
+    struct stat st;
+    if (level_format(path) == LEVEL_FORMAT_UNKNOWN || stat(path, &st) == -1 || !S_ISREG(st.st_mode)) {
+	if (!found) return false;
+	free(catalog->entries[*index].path);
+	array_pop_at(catalog->entries, *index);
+	return true;
+    }
+
+    if (found) {
+	CatalogEntry *entry = &catalog->entries[*index];
+	if (entry->mtime == catalog_mtime(&st) && entry->size == st.st_size) return false;
+	catalog_read_entry(catalog, entry, &st);
+	return true;
+    }
+
+    CatalogEntry entry = {.path = strdup(path), .seen = true};
+    catalog_read_entry(catalog, &entry, &st);
+    array_push(catalog->entries, entry);
+    memmove(&catalog->entries[*index + 1], &catalog->entries[*index], sizeof(CatalogEntry) * (array_size(catalog->entries) - *index - 1));
+    catalog->entries[*index] = entry;
+    return true;
+}
+
+const CatalogEntry *catalog_refresh(Catalog *catalog, const char *path) {
+    size_t index;
+    if (catalog_update(catalog, path, &index)) catalog->dirty = true;
+    return catalog_find(catalog, path);
+}
+
+size_t catalog_poll(Catalog *catalog) {
+    if (catalog->watch == -1) return 0;
+
+    size_t changes = 0;
+    bool overflow = false;
+    char events[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    for (;;) {
+	ssize_t n = read(catalog->watch, events, sizeof(events));
+	if (n <= 0) break;
+
+	for (char *p = events; p < events + n;) {
+	    const struct inotify_event *event = (const struct inotify_event *)p;
+	    p += sizeof(struct inotify_event) + event->len;
+
+	    if (event->mask & IN_Q_OVERFLOW) {
+		overflow = true;
+	    } else if (event->mask & IN_IGNORED) {
+		// Le répertoire a été supprimé ou démonté.
+		close(catalog->watch);
+		catalog->watch = -1;
+		return changes;
+	    } else if (event->len && level_format(event->name) != LEVEL_FORMAT_UNKNOWN) {
+		char *path = catalog_path(catalog->dir, event->name);
+		size_t index;
+		if (catalog_update(catalog, path, &index)) {
+		    catalog->dirty = true;
+		    changes += 1;
+		}
+		free(path);
+	    }
+	}
+    }
+
+    // Des événements ont été perdus : seul un parcours complet remet l'index à jour.
+    if (overflow) {
+	catalog_scan(catalog);
+	changes += 1;
+    }
+    if (catalog->dirty) catalog_save(catalog);
+    return changes;
+}
+
+const CatalogEntry *catalog_find(const Catalog *catalog, const char *path) {
+    size_t index;
+    return catalog_search(catalog, path, &index) ? &catalog->entries[index] : NULL;
+}
+
+size_t catalog_count(const Catalog *catalog) {
+    return array_size(catalog->entries);
+}
+
+bool catalog_save(Catalog *catalog) {
+    size_t dir_size = strlen(catalog->dir) + 1;
+    CatalogHeader header = {
+	.magic = CATALOG_MAGIC,
+	.version = CATALOG_VERSION,
+	.count = array_size(catalog->entries),
+    };
+
+    Buffer out;
+    buffer_init(&out, sizeof(header) + array_size(catalog->entries) * (sizeof(CatalogRecord) + 16));
+    buffer_append(&out, (const char *)&header, sizeof(header));
+    for (size_t i = 0; i < array_size(catalog->entries); i++) {
+	const CatalogEntry *entry = &catalog->entries[i];
+	const char *name = entry->path + dir_size;
+	CatalogRecord record = {
+	    .mtime = entry->mtime,
+	    .size = entry->size,
+	    .hash = entry->hash,
+	    .width = entry->width,
+	    .height = entry->height,
+	    .players = entry->players,
+	    .coins = entry->coins,
+	    .valid = entry->valid,
+	    .name_size = strlen(name),
+	};
+	buffer_append(&out, (const char *)&record, sizeof(record));
+	buffer_append(&out, name, record.name_size);
+    }
+
+    char *index_path = catalog_path(catalog->dir, CATALOG_FILE);
+    bool result = buffer_write_file(&out, index_path);
+    free(index_path);
+    buffer_free(&out);
+    if (result) catalog->dirty = false;
+    return result;
+}
+
+void catalog_close(Catalog *catalog) {
+    if (catalog->dirty) catalog_save(catalog);
+    if (catalog->watch != -1) close(catalog->watch);
+    catalog->watch = -1;
+    catalog_clear(catalog);
+    array_free(catalog->entries);
+    catalog->entries = NULL;
+    free(catalog->dir);
+    catalog->dir = NULL;
+}
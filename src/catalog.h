@@ -0,0 +1,128 @@
+#ifndef CATALOG_H_
+#define CATALOG_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @def CATALOG_FILE
+ * @brief Nom du fichier d'index, dans le répertoire des niveaux.
+ */
+#define CATALOG_FILE ".catalog"
+
+/**
+ * @def CATALOG_MAGIC
+ * @brief Signature des quatre premiers octets du fichier d'index.
+ */
+#define CATALOG_MAGIC "LMIX"
+
+/**
+ * @def CATALOG_VERSION
+ * @brief Version du fichier d'index écrite par catalog_save.
+ */
+#define CATALOG_VERSION 1
+
+/**
+ * @struct CatalogEntry
+ * @brief Métadonnées d'un fichier de niveau, gardées dans l'index.
+ */
+typedef struct {
+    char *path;      /**< Chemin du niveau (répertoire compris). */
+    int64_t mtime;   /**< Date de modification du fichier, en nanosecondes. */
+    int64_t size;    /**< Taille du fichier en octets. */
+    uint64_t hash;   /**< Empreinte FNV-1a 64 bits du contenu. */
+    int32_t width;   /**< Largeur en tuiles (0 si le niveau ne se charge pas). */
+    int32_t height;  /**< Hauteur en tuiles. */
+    int32_t players; /**< Nombre de joueurs. */
+    int32_t coins;   /**< Nombre de pièces (tuiles LEVEL_TILE_COIN). */
+    bool valid;      /**< Le niveau a pu être chargé. */
+    bool seen;       /**< Trouvé par le dernier parcours du répertoire. */
+} CatalogEntry;
+
+/**
+ * @struct Catalog
+ * @brief Index des niveaux d'un répertoire, enregistré dans CATALOG_FILE et tenu à jour avec inotify.
+ *
+ * À l'ouverture, l'index enregistré est relu puis comparé au répertoire avec un
+ * simple stat par fichier : seuls les niveaux nouveaux ou modifiés sont ouverts.
+ * Ensuite, catalog_poll applique les événements inotify du répertoire.
+ */
+typedef struct {
+    char *dir;              /**< Répertoire des niveaux. */
+    CatalogEntry *entries;  /**< Niveaux triés par chemin (tableau dynamique). */
+    int watch;              /**< Descripteur inotify, ou -1. */
+    bool dirty;             /**< L'index a changé depuis le dernier catalog_save. */
+    size_t parsed;          /**< Nombre de niveaux ouverts depuis catalog_open. */
+} Catalog;
+
+/**
+ * @brief Ouvre l'index d'un répertoire de niveaux (le répertoire est créé s'il n'existe pas).
+ *
+ * @param catalog Index à remplir.
+ * @param dir Répertoire des niveaux.
+ * @param watch Surveille le répertoire avec inotify (voir catalog_poll).
+ * @return `true` si le répertoire a pu être lu, sinon `false` (l'index est alors vide).
+ */
+bool catalog_open(Catalog *catalog, const char *dir, bool watch);
+
+/**
+ * @brief Compare l'index au contenu du répertoire et met à jour les niveaux ajoutés, modifiés ou supprimés.
+ *
+ * @param catalog Index.
+ * @return `true` si le répertoire a pu être lu, sinon `false`.
+ */
+bool catalog_scan(Catalog *catalog);
+
+/**
+ * @brief Met à jour l'entrée d'un fichier de niveau, ou la retire si le fichier n'existe plus.
+ *
+ * Le fichier n'est ouvert que si sa date ou sa taille a changé.
+ *
+ * @param catalog Index.
+ * @param path Chemin du niveau (répertoire compris).
+ * @return L'entrée à jour, ou NULL si le fichier n'est pas (ou plus) un niveau.
+ */
+const CatalogEntry *catalog_refresh(Catalog *catalog, const char *path);
+
+/**
+ * @brief Applique les événements inotify en attente et enregistre l'index s'il a changé.
+ *
+ * @param catalog Index.
+ * @return Le nombre de niveaux ajoutés, modifiés ou retirés.
+ */
+size_t catalog_poll(Catalog *catalog);
+
+/**
+ * @brief Cherche l'entrée d'un niveau.
+ *
+ * @param catalog Index.
+ * @param path Chemin du niveau (répertoire compris).
+ * @return L'entrée, ou NULL si le niveau n'est pas dans l'index.
+ */
+const CatalogEntry *catalog_find(const Catalog *catalog, const char *path);
+
+/**
+ * @brief Donne le nombre de niveaux de l'index.
+ *
+ * @param catalog Index.
+ * @return Le nombre de niveaux.
+ */
+size_t catalog_count(const Catalog *catalog);
+
+/**
+ * @brief Enregistre l'index dans CATALOG_FILE.
+ *
+ * @param catalog Index.
+ * @return `true` si l'écriture est réussie, sinon `false`.
+ */
+bool catalog_save(Catalog *catalog);
+
+/**
+ * @brief Enregistre l'index s'il a changé, arrête la surveillance et libère l'index.
+ *
+ * @param catalog Index.
+ */
+void catalog_close(Catalog *catalog);
+
+#endif // CATALOG_H_
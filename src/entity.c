@@ -4,24 +4,106 @@
 #include "plug.h"
 #include "array.h"
 
-#define G 32.0f
+// gravité en pixels/s² et impulsion de saut en pixels/s
+#define G 1920.0f
 #define PLAYER_JUMP_SPD 400.0f
 #define PLAYER_RECT (Rectangle){0, 0, 48 - (12 * 2), 48 - 12}
 
 //#define SPIKE_RECT (Rectangle){0, 0, 48 - (12 * 2), 48 - 12}
 
-void entity_update(Plug *plug) {
-    for (size_t i = 0; i < array_size(plug->players); i++) {
-	Entity *player = &(plug->players[i]);
-	float dt = GetFrameTime();
+void entity_map_init(EntityMap *map, ArrayAllocator *allocator) {
+    map->entities = array_create_with(allocator, 2, sizeof(Entity));
+    map->owners = array_create_with(allocator, 2, sizeof(uint32_t));
+    map->slots = array_create_with(allocator, 2, sizeof(EntitySlot));
+    map->free_slot = ENTITY_SLOT_NONE;
+    map->removed = array_create_with(allocator, 2, sizeof(EntityHandle));
+}
+
+void entity_map_free(EntityMap *map) {
+    array_free(map->entities);
+    array_free(map->owners);
+    array_free(map->slots);
+    array_free(map->removed);
+}
+
+EntityHandle entity_map_insert(EntityMap *map, Entity entity) {
+    uint32_t index = map->free_slot;
+    if (index != ENTITY_SLOT_NONE) {
+	map->free_slot = map->slots[index].dense;
+    } else {
+	index = array_size(map->slots);
+	array_push(map->slots, ((EntitySlot){.generation = 1}));
+    }
+    map->slots[index].dense = array_size(map->entities);
+    array_push(map->entities, entity);
+    array_push(map->owners, index);
+    return (EntityHandle){index, map->slots[index].generation};
+}
+
+EntityHandle entity_map_handle(const EntityMap *map, size_t i) {
+    uint32_t index = map->owners[i];
+    return (EntityHandle){index, map->slots[index].generation};
+}
+
+Entity *entity_map_get(EntityMap *map, EntityHandle handle) {
+    if (handle.index >= array_size(map->slots) || map->slots[handle.index].generation != handle.generation) return NULL;
+    return &map->entities[map->slots[handle.index].dense];
+}
+
+bool entity_map_remove(EntityMap *map, EntityHandle handle) {
+    if (!entity_map_get(map, handle)) return false;
+    EntitySlot *slot = &map->slots[handle.index];
+
+    // la dernière entité prend la place de l'entité supprimée
+    size_t last = array_size(map->entities) - 1;
+    map->entities[slot->dense] = map->entities[last];
+    map->owners[slot->dense] = map->owners[last];
+    map->slots[map->owners[last]].dense = slot->dense;
+    array_pop_last(map->entities);
+    array_pop_last(map->owners);
+
+    // la génération 0 est réservée à la poignée nulle
+    slot->generation = slot->generation + 1 ? slot->generation + 1 : 1;
+    slot->dense = map->free_slot;
+    map->free_slot = handle.index;
+    return true;
+}
+
+void entity_map_defer_remove(EntityMap *map, EntityHandle handle) {
+    array_push(map->removed, handle);
+}
+
+void entity_map_flush(EntityMap *map) {
+    for (size_t i = 0; i < array_size(map->removed); i++) {
+	entity_map_remove(map, map->removed[i]);
+    }
+    array_clear(map->removed);
+}
+
+void entity_map_clear(EntityMap *map) {
+    while (entity_map_size(map)) {
+	entity_map_remove(map, entity_map_handle(map, entity_map_size(map) - 1));
+    }
+    array_clear(map->removed);
+}
+
+void entity_update(Plug *plug, float dt) {
+    EntityMap *players = &plug->players;
+    for (size_t i = 0; i < entity_map_size(players); i++) {
+	Entity *player = &players->entities[i];
+	// identifiant stable du joueur dans les messages
+	EntityHandle handle = entity_map_handle(players, i);
+	player->previous = (Vector2){player->rect.x, player->rect.y};
 
 	if (plug->state != EDITOR) {
 	    player->velocity.y += G * dt;
 	}
 
+	// Les joueurs sortis, tombés ou tués sont supprimés à la fin du pas, sans décaler le parcours.
 	//if (player->rect.x > SCREEN_WIDTH || player->rect.x < 0 || player->rect.y < 0 || player->rect.y > SCREEN_HEIGHT) {
 	if (player->rect.x > SCREEN_WIDTH || player->rect.x < 0 || player->rect.y > SCREEN_HEIGHT) {
-	    array_pop_at(plug->players, i);
+	    entity_map_defer_remove(players, handle);
+	    continue;
 	}
 
 	switch (player->state) {
@@ -34,15 +116,16 @@ void entity_update(Plug *plug) {
 	default: break;
 	}
 
-	player->rect.y += player->velocity.y;
+	player->rect.y += player->velocity.y * dt;
 
 	player->on_ground = false;
 
 	bool auto_jump = false;
+	bool removed = false;
 
-	for (size_t j = 0; j < array_size(plug->players); j++) {
-	    if (CheckCollisionRecs(player->rect, plug->players[j].rect) && j != i) {
-		if (player->rect.x < plug->players[j].rect.x) {
+	for (size_t j = 0; j < entity_map_size(players); j++) {
+	    if (CheckCollisionRecs(player->rect, players->entities[j].rect) && j != i) {
+		if (player->rect.x < players->entities[j].rect.x) {
 		    player->state = MOVE_LEFT;
 		} else {
 		    player->state = MOVE_RIGHT;
@@ -50,8 +133,8 @@ void entity_update(Plug *plug) {
 	    }
 	}
 
-	for (size_t y = 0; y < TILESY; y++) {
-	    for (size_t x = 0; x < TILESX; x++) {
+	for (size_t y = 0; y < TILESY && !removed; y++) {
+	    for (size_t x = 0; x < TILESX && !removed; x++) {
 		if (0 < plug->tilemap[y][x] && plug->tilemap[y][x] <= BLOCK_BRICK) {
 		    Rectangle block = {
 			.x = MAP_TILE_SIZE * x,
@@ -62,32 +145,36 @@ void entity_update(Plug *plug) {
 
 		    if (CheckCollisionRecs(player->rect, block) && plug->tilemap[y][x] == BLOCK_DOOR) {
 			plug->score_players += 1;
-			array_pop_at(plug->players, i);
-			printf("player %ld get the exit !\n", i);
+			entity_map_defer_remove(players, handle);
+			removed = true;
+			printf("player %u get the exit !\n", handle.index);
+			continue;
 		    }
 
 		    if (CheckCollisionRecs(player->rect, block) && plug->tilemap[y][x] == BLOCK_COIN) {
 			plug->tilemap[y][x] = BLOCK_EMPTY;
 			plug->coins++;
-			printf("player %ld get the coin !\n", i);
+			printf("player %u get the coin !\n", handle.index);
 		    }
 
 		    if (CheckCollisionRecs(player->rect, block) && plug->tilemap[y][x] == BLOCK_S_BRICK) {
 			plug->tilemap[y][x] = BLOCK_EMPTY;
 			plug->bricks+= 1;
-			printf("player %ld get the small brick !\n", i);
+			printf("player %u get the small brick !\n", handle.index);
 		    }
 
 		    if (CheckCollisionRecs(player->rect, block) && plug->tilemap[y][x] == BLOCK_B_BRICK) {
 			plug->tilemap[y][x] = BLOCK_EMPTY;
 			plug->bricks += 2;
-			printf("player %ld get the small brick !\n", i);
+			printf("player %u get the small brick !\n", handle.index);
 		    }
 
 		    // check if the player collide with a spike
 		    if (CheckCollisionRecs(player->rect, block) && plug->tilemap[y][x] == BLOCK_SPIKE) {
-			array_pop_at(plug->players, i);
-			printf("player %ld get killed by the spike !\n", i);
+			entity_map_defer_remove(players, handle);
+			removed = true;
+			printf("player %u get killed by the spike !\n", handle.index);
+			continue;
 		    }
 
 		    if (CheckCollisionRecs(player->rect, block) && (plug->tilemap[y][x] < 32 || plug->tilemap[y][x] == BLOCK_BRICK)) {
@@ -159,9 +246,10 @@ void entity_update(Plug *plug) {
 	//}
 
 	if (player->on_ground && auto_jump) {
-	    player->velocity.y -= PLAYER_JUMP_SPD * dt;
+	    player->velocity.y -= PLAYER_JUMP_SPD;
 	}
     }
+    entity_map_flush(players);
 }
 
 Entity entity_init(int x, int y) {
@@ -174,5 +262,6 @@ Entity entity_init(int x, int y) {
     };
     entity.rect.x += x;
     entity.rect.y += y;
+    entity.previous = (Vector2){entity.rect.x, entity.rect.y};
     return entity;
 }
@@ -2,10 +2,30 @@
 #define ENTITY_H_
 
 #include <stdbool.h>
+#include <stdint.h>
 #include "raylib.h"
+#include "array.h"
 
 #define PLAYER_SPEED 90
 
+/**
+ * @def SIM_TICK_RATE
+ * @brief Fréquence (en Hz) du pas fixe de la simulation des entités.
+ */
+#define SIM_TICK_RATE 60
+
+/**
+ * @def SIM_DT
+ * @brief Durée (en secondes) d'un pas de simulation.
+ */
+#define SIM_DT (1.0f / SIM_TICK_RATE)
+
+/**
+ * @def SIM_MAX_FRAME_TIME
+ * @brief Temps maximal accumulé par frame, pour éviter d'enchaîner trop de pas après un ralentissement.
+ */
+#define SIM_MAX_FRAME_TIME 0.25f
+
 /**
  * @struct Plug
  * @brief Représente la structure principale contenant des informations sur l'état du jeu.
@@ -37,20 +57,151 @@ typedef enum State {
  */
 typedef struct {
     Rectangle rect;   /**< Rectangle représentant la position et la taille de l'entité. */
+    Vector2 previous; /**< Position au pas de simulation précédent, pour l'interpolation du rendu. */
     Vector2 velocity; /**< Vecteur de vélocité de l'entité. */
     EntityType type;  /**< Type de l'entité (par exemple, Joueur ou Ennemi). */
     State state;      /**< État de l'entité (par exemple, Statique, Déplacement à gauche, Déplacement à droite). */
     bool on_ground;   /**< Booléen indiquant si l'entité est actuellement au sol. */
 } Entity;
 
+/**
+ * @def ENTITY_SLOT_NONE
+ * @brief Fin de la liste des cases libres d'un EntityMap.
+ */
+#define ENTITY_SLOT_NONE UINT32_MAX
+
+/**
+ * @struct EntityHandle
+ * @brief Poignée stable vers une entité d'un EntityMap.
+ *
+ * La poignée reste valide tant que l'entité existe, quels que soient les ajouts
+ * et suppressions d'autres entités. Une fois l'entité supprimée, sa case change
+ * de génération et la poignée est périmée. La poignée nulle `(EntityHandle){0}`
+ * ne désigne jamais une entité.
+ */
+typedef struct {
+    uint32_t index;      /**< Case de l'entité dans `slots`. */
+    uint32_t generation; /**< Génération de la case quand l'entité a été ajoutée (jamais 0). */
+} EntityHandle;
+
+/**
+ * @struct EntitySlot
+ * @brief Case d'un EntityMap : position de l'entité, ou case libre suivante.
+ */
+typedef struct {
+    uint32_t dense;      /**< Position de l'entité dans `entities`, ou case libre suivante (ENTITY_SLOT_NONE à la fin). */
+    uint32_t generation; /**< Incrémentée à chaque suppression. */
+} EntitySlot;
+
+/**
+ * @struct EntityMap
+ * @brief Entités rangées de façon contiguë et désignées par des poignées générationnelles (slot map).
+ *
+ * Les entités se parcourent dans `entities`, de 0 à entity_map_size : l'ordre
+ * change quand une entité est supprimée (la dernière prend sa place), donc une
+ * position n'est valide que jusqu'à la prochaine suppression. Une entité se
+ * garde par sa poignée (voir entity_map_handle et entity_map_get). Ajout,
+ * suppression et accès par poignée sont en temps constant.
+ */
+typedef struct {
+    Entity *entities;      /**< Entités, contiguës (tableau dynamique). */
+    uint32_t *owners;      /**< Case de chaque entité de `entities` (tableau dynamique, même taille). */
+    EntitySlot *slots;     /**< Cases désignées par les poignées (tableau dynamique). */
+    uint32_t free_slot;    /**< Première case libre, ou ENTITY_SLOT_NONE. */
+    EntityHandle *removed; /**< Suppressions différées jusqu'à entity_map_flush (tableau dynamique). */
+} EntityMap;
+
+/**
+ * @brief Macro pour obtenir le nombre d'entités d'un EntityMap.
+ */
+#define entity_map_size(map) \
+    array_size((map)->entities)
+
+/**
+ * @brief Initialise un EntityMap vide.
+ *
+ * @param map EntityMap à initialiser.
+ * @param allocator Allocateur des tableaux, ou NULL pour malloc.
+ */
+void entity_map_init(EntityMap *map, ArrayAllocator *allocator);
+
+/**
+ * @brief Libère un EntityMap.
+ *
+ * @param map EntityMap à libérer.
+ */
+void entity_map_free(EntityMap *map);
+
+/**
+ * @brief Ajoute une entité à la fin de `entities`.
+ *
+ * @param map EntityMap.
+ * @param entity Entité à ajouter.
+ * @return La poignée de l'entité.
+ */
+EntityHandle entity_map_insert(EntityMap *map, Entity entity);
+
+/**
+ * @brief Donne la poignée de l'entité à une position de `entities`.
+ *
+ * @param map EntityMap.
+ * @param i Position, inférieure à entity_map_size.
+ * @return La poignée de l'entité.
+ */
+EntityHandle entity_map_handle(const EntityMap *map, size_t i);
+
+/**
+ * @brief Obtient l'entité désignée par une poignée.
+ *
+ * @param map EntityMap.
+ * @param handle Poignée.
+ * @return L'entité, valide jusqu'au prochain ajout ou suppression, ou NULL si la poignée est périmée.
+ */
+Entity *entity_map_get(EntityMap *map, EntityHandle handle);
+
+/**
+ * @brief Supprime une entité ; la dernière entité de `entities` prend sa place.
+ *
+ * @param map EntityMap.
+ * @param handle Poignée de l'entité.
+ * @return `false` si la poignée était périmée.
+ */
+bool entity_map_remove(EntityMap *map, EntityHandle handle);
+
+/**
+ * @brief Note une suppression à faire par entity_map_flush, pour supprimer pendant un parcours de `entities`.
+ *
+ * @param map EntityMap.
+ * @param handle Poignée de l'entité (une entité notée deux fois n'est supprimée qu'une fois).
+ */
+void entity_map_defer_remove(EntityMap *map, EntityHandle handle);
+
+/**
+ * @brief Fait les suppressions notées par entity_map_defer_remove.
+ *
+ * @param map EntityMap.
+ */
+void entity_map_flush(EntityMap *map);
+
+/**
+ * @brief Supprime toutes les entités (leurs poignées deviennent périmées).
+ *
+ * @param map EntityMap.
+ */
+void entity_map_clear(EntityMap *map);
+
 /**
  * @brief Met à jour les entités de jeu en fonction de l'état actuel du jeu.
  *
  * Cette fonction est responsable de la mise à jour de la position et de l'état des entités dans le jeu.
+ * Elle avance la simulation d'un pas de durée `dt` et conserve la position précédente
+ * de chaque entité dans `previous`. Les joueurs sortis, tombés ou tués sont
+ * supprimés à la fin du pas.
  *
  * @param plug Pointeur vers la structure principale du jeu.
+ * @param dt Durée du pas de simulation en secondes (normalement SIM_DT).
  */
-void entity_update(Plug *plug);
+void entity_update(Plug *plug, float dt);
 
 /**
  * @brief Initialise une nouvelle entité avec les coordonnées spécifiées.
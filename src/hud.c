@@ -0,0 +1,195 @@
+/* -*- compile-command: "make -C .. libplug" -*- */
+#include "hud.h"
+#include <stdio.h>
+#include <string.h>
+
+#include "array.h"
+
+// taille de base des glyphes de l'atlas SDF et nombre de glyphes (ASCII 32..126)
+#define HUD_SDF_BASE_SIZE 32
+#define HUD_SDF_GLYPHS 95
+
+// shader de rendu SDF (voir l'exemple text_font_sdf de raylib)
+static const char *hud_sdf_fs =
+    "#version 330\n"
+    "in vec2 fragTexCoord;\n"
+    "in vec4 fragColor;\n"
+    "uniform sampler2D texture0;\n"
+    "uniform vec4 colDiffuse;\n"
+    "out vec4 finalColor;\n"
+    "void main()\n"
+    "{\n"
+    "    float distanceFromOutline = texture(texture0, fragTexCoord).a - 0.5;\n"
+    "    float distanceChangePerFragment = length(vec2(dFdx(distanceFromOutline), dFdy(distanceFromOutline)));\n"
+    "    float alpha = smoothstep(-distanceChangePerFragment, distanceChangePerFragment, distanceFromOutline);\n"
+    "    finalColor = vec4(fragColor.rgb, fragColor.a*alpha);\n"
+    "}\n";
+
+void hud_font_init(HudFont *hf, bool sdf) {
+    hf->font = GetFontDefault();
+    hf->sdf = false;
+    hf->shader = (Shader){0};
+    if (!sdf) return;
+
+    unsigned int size = 0;
+    unsigned char *data = LoadFileData(HUD_FONT_PATH, &size);
+    if (data == NULL) {
+	fprintf(stderr, "ERROR: Could not load the HUD font %s, using the default font\n", HUD_FONT_PATH);
+	return;
+    }
+
+    Font font = {0};
+    font.baseSize = HUD_SDF_BASE_SIZE;
+    font.glyphCount = HUD_SDF_GLYPHS;
+    font.glyphs = LoadFontData(data, size, HUD_SDF_BASE_SIZE, 0, HUD_SDF_GLYPHS, FONT_SDF);
+    UnloadFileData(data);
+    if (font.glyphs == NULL) {
+	fprintf(stderr, "ERROR: Could not generate the SDF glyphs of %s, using the default font\n", HUD_FONT_PATH);
+	return;
+    }
+
+    Image atlas = GenImageFontAtlas(font.glyphs, &font.recs, HUD_SDF_GLYPHS, HUD_SDF_BASE_SIZE, 0, 1);
+    font.texture = LoadTextureFromImage(atlas);
+    UnloadImage(atlas);
+    SetTextureFilter(font.texture, TEXTURE_FILTER_BILINEAR);
+
+    hf->font = font;
+    hf->sdf = true;
+    hf->shader = LoadShaderFromMemory(0, hud_sdf_fs);
+}
+
+void hud_font_free(HudFont *hf) {
+    if (!hf->sdf) return;
+    UnloadFont(hf->font);
+    UnloadShader(hf->shader);
+    hf->sdf = false;
+}
+
+void hud_text_init(HudText *t, float size) {
+    memset(t, 0, sizeof(*t));
+    t->size = size;
+    t->glyphs = array_create_init(HUD_TEXT_CAPACITY, sizeof(HudGlyph));
+}
+
+void hud_text_free(HudText *t) {
+    array_free(t->glyphs);
+    t->glyphs = NULL;
+}
+
+/**
+ * @brief Reconstruit les quads des glyphes de `t->text`, comme le ferait DrawTextEx.
+ */
+static void hud_text_layout(HudFont *hf, HudText *t) {
+    Font font = hf->font;
+    float scale = t->size / font.baseSize;
+    // espacement identique à DrawText pour la police par défaut
+    float spacing = hf->sdf ? 0.0f : (int)(t->size / 10);
+    float x = 0.0f;
+
+    array_clear(t->glyphs);
+    for (const char *c = t->text; *c; c++) {
+	int index = GetGlyphIndex(font, *c);
+	GlyphInfo glyph = font.glyphs[index];
+	Rectangle rec = font.recs[index];
+
+	if (*c != ' ' && *c != '\t') {
+	    float padding = font.glyphPadding;
+	    HudGlyph quad = {
+		.source = {rec.x - padding, rec.y - padding, rec.width + 2 * padding, rec.height + 2 * padding},
+		.dest = {
+		    x + (glyph.offsetX - padding) * scale,
+		    (glyph.offsetY - padding) * scale,
+		    (rec.width + 2 * padding) * scale,
+		    (rec.height + 2 * padding) * scale,
+		},
+	    };
+	    array_push(t->glyphs, quad);
+	}
+
+	x += (glyph.advanceX ? glyph.advanceX : rec.width) * scale + spacing;
+    }
+
+    t->extent = (Vector2){x, t->size};
+    t->font_id = font.texture.id;
+    t->layouts += 1;
+}
+
+/**
+ * @brief Écrit un entier en base 10 dans `buf` sans passer par printf.
+ *
+ * @return Le nombre de caractères écrits (au plus 11).
+ */
+static size_t hud_format_int(char *buf, int value) {
+    char digits[12];
+    size_t n = 0;
+    unsigned int u = value < 0 ? -(unsigned int)value : (unsigned int)value;
+    do {
+	digits[n++] = '0' + u % 10;
+	u /= 10;
+    } while (u);
+
+    size_t len = 0;
+    if (value < 0) buf[len++] = '-';
+    while (n) buf[len++] = digits[--n];
+    return len;
+}
+
+/**
+ * @brief Copie au plus `n` octets de `src` à la fin de `t->text` (position `*len`), en tronquant à HUD_TEXT_CAPACITY.
+ */
+static void hud_append(HudText *t, size_t *len, const char *src, size_t n) {
+    if (*len + n > HUD_TEXT_CAPACITY - 1) n = HUD_TEXT_CAPACITY - 1 - *len;
+    memcpy(t->text + *len, src, n);
+    *len += n;
+    t->text[*len] = '\0';
+}
+
+bool hud_text_set(HudFont *hf, HudText *t, const char *text) {
+    // comparé sur le contenu (tronqué comme `t->text`) : `text` peut être un tampon réécrit
+    size_t n = strnlen(text, HUD_TEXT_CAPACITY - 1);
+    if (t->key == t->text && memcmp(t->text, text, n) == 0 && t->text[n] == '\0'
+	&& t->font_id == hf->font.texture.id) return false;
+    size_t len = 0;
+    hud_append(t, &len, text, n);
+    t->key = t->text;
+    hud_text_layout(hf, t);
+    return true;
+}
+
+bool hud_text_int(HudFont *hf, HudText *t, const char *label, int value) {
+    if (t->key == label && t->values[0] == value && t->font_id == hf->font.texture.id) return false;
+    char number[12];
+    size_t len = 0;
+    hud_append(t, &len, label, strlen(label));
+    hud_append(t, &len, number, hud_format_int(number, value));
+    t->key = label;
+    t->values[0] = value;
+    hud_text_layout(hf, t);
+    return true;
+}
+
+bool hud_text_pair(HudFont *hf, HudText *t, const char *label, int a, char sep, int b) {
+    if (t->key == label && t->values[0] == a && t->values[1] == b && t->font_id == hf->font.texture.id) return false;
+    char number[12];
+    size_t len = 0;
+    hud_append(t, &len, label, strlen(label));
+    hud_append(t, &len, number, hud_format_int(number, a));
+    hud_append(t, &len, &sep, 1);
+    hud_append(t, &len, number, hud_format_int(number, b));
+    t->key = label;
+    t->values[0] = a;
+    t->values[1] = b;
+    hud_text_layout(hf, t);
+    return true;
+}
+
+void hud_text_draw(RenderBuffer *rb, HudFont *hf, HudText *t, Vector2 position, Color tint) {
+    render_set_shader(rb, hf->shader);
+    for (size_t i = 0; i < array_size(t->glyphs); i++) {
+	Rectangle dest = t->glyphs[i].dest;
+	dest.x += position.x;
+	dest.y += position.y;
+	render_push(rb, LAYER_UI, hf->font.texture, t->glyphs[i].source, dest, tint);
+    }
+    render_set_shader(rb, (Shader){0});
+}
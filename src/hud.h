@@ -0,0 +1,147 @@
+#ifndef HUD_H_
+#define HUD_H_
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "raylib.h"
+#include "render.h"
+
+/**
+ * @def HUD_FONT_PATH
+ * @brief Police utilisée pour le texte du HUD en mode SDF.
+ */
+#define HUD_FONT_PATH "./assets/ui-pack-space/Fonts/kenvector_future.ttf"
+
+/**
+ * @def HUD_SDF
+ * @brief Active (1) ou non (0) la police SDF pour le texte du HUD.
+ *
+ * Sans SDF, le HUD utilise la police par défaut de raylib, comme DrawText.
+ */
+#ifndef HUD_SDF
+#define HUD_SDF 0
+#endif // HUD_SDF
+
+/**
+ * @def HUD_TEXT_CAPACITY
+ * @brief Nombre maximal d'octets d'un texte du HUD (zéro final compris).
+ */
+#define HUD_TEXT_CAPACITY 96
+
+/**
+ * @struct HudFont
+ * @brief Police du HUD, éventuellement en champ de distance signée (SDF).
+ */
+typedef struct {
+    Font font;     /**< Police raylib (atlas et métriques des glyphes). */
+    bool sdf;      /**< La police est un atlas SDF dessiné avec `shader`. */
+    Shader shader; /**< Shader SDF (id 0 sans SDF). */
+} HudFont;
+
+/**
+ * @struct HudGlyph
+ * @brief Quad d'un glyphe déjà positionné, relatif à l'origine du texte.
+ */
+typedef struct {
+    Rectangle source; /**< Rectangle source dans l'atlas de la police. */
+    Rectangle dest;   /**< Rectangle de destination relatif à l'origine du texte. */
+} HudGlyph;
+
+/**
+ * @struct HudText
+ * @brief Texte du HUD dont la mise en page est gardée en cache entre les frames.
+ *
+ * La chaîne et ses quads ne sont reconstruits que si le texte, le libellé ou
+ * les valeurs affichées changent.
+ */
+typedef struct {
+    char text[HUD_TEXT_CAPACITY]; /**< Texte affiché. */
+    const char *key;              /**< Libellé de hud_text_int ou hud_text_pair, `text` après hud_text_set. */
+    int values[2];                /**< Valeurs entières affichées après le libellé. */
+    unsigned int font_id;         /**< Texture de la police utilisée pour la mise en page. */
+    float size;                   /**< Taille du texte en pixels. */
+    HudGlyph *glyphs;             /**< Tableau dynamique des quads des glyphes. */
+    Vector2 extent;               /**< Dimensions du texte mis en page. */
+    size_t layouts;               /**< Nombre de mises en page effectuées (statistique). */
+} HudText;
+
+/**
+ * @brief Charge la police du HUD.
+ *
+ * @param hf Pointeur vers la police à initialiser.
+ * @param sdf Si `true`, génère un atlas SDF de HUD_FONT_PATH et son shader,
+ *            sinon utilise la police par défaut de raylib.
+ */
+void hud_font_init(HudFont *hf, bool sdf);
+
+/**
+ * @brief Libère la police du HUD.
+ *
+ * @param hf Pointeur vers la police à libérer.
+ */
+void hud_font_free(HudFont *hf);
+
+/**
+ * @brief Initialise un texte du HUD vide.
+ *
+ * @param t Pointeur vers le texte à initialiser.
+ * @param size Taille du texte en pixels.
+ */
+void hud_text_init(HudText *t, float size);
+
+/**
+ * @brief Affecte une chaîne au texte.
+ *
+ * La chaîne est comparée au texte affiché et copiée : elle peut être un tampon
+ * réutilisé d'une frame à l'autre.
+ *
+ * @param hf Police du HUD.
+ * @param t Texte à mettre à jour.
+ * @param text Chaîne à afficher.
+ * @return `true` si le texte a été remis en page.
+ */
+bool hud_text_set(HudFont *hf, HudText *t, const char *text);
+
+/**
+ * @brief Affecte au texte un libellé suivi d'un entier ("brick count: 3").
+ *
+ * @param hf Police du HUD.
+ * @param t Texte à mettre à jour.
+ * @param label Libellé constant (comparé sur le pointeur).
+ * @param value Valeur à afficher.
+ * @return `true` si le texte a été remis en page.
+ */
+bool hud_text_int(HudFont *hf, HudText *t, const char *label, int value);
+
+/**
+ * @brief Affecte au texte un libellé suivi de deux entiers séparés par `sep` ("players exit: 1/3").
+ *
+ * @param hf Police du HUD.
+ * @param t Texte à mettre à jour.
+ * @param label Libellé constant (comparé sur le pointeur).
+ * @param a Première valeur.
+ * @param sep Séparateur entre les deux valeurs.
+ * @param b Seconde valeur.
+ * @return `true` si le texte a été remis en page.
+ */
+bool hud_text_pair(HudFont *hf, HudText *t, const char *label, int a, char sep, int b);
+
+/**
+ * @brief Ajoute les quads d'un texte au tampon de rendu sur la couche LAYER_UI.
+ *
+ * @param rb Tampon de commandes de rendu.
+ * @param hf Police du HUD.
+ * @param t Texte à dessiner.
+ * @param position Position du coin supérieur gauche du texte.
+ * @param tint Couleur du texte.
+ */
+void hud_text_draw(RenderBuffer *rb, HudFont *hf, HudText *t, Vector2 position, Color tint);
+
+/**
+ * @brief Libère la mise en page d'un texte du HUD.
+ *
+ * @param t Texte à libérer.
+ */
+void hud_text_free(HudText *t);
+
+#endif // HUD_H_
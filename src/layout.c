@@ -5,6 +5,7 @@
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "array.h"
 
@@ -20,13 +21,13 @@ Rectangle layout_make_rec(float x, float y, float w, float h) {
     return r;
 }
 
-void layout_item(bool selected, Texture2D texture, Rectangle rect, Rectangle source) {
+void layout_item(RenderBuffer *rb, bool selected, Texture2D texture, Rectangle rect, Rectangle source) {
     Color color = WHITE;
     if (!CheckCollisionPointRec(GetMousePosition(), rect) && !selected) {
 	color = Fade(color, 0.5f);
     }
 
-    DrawTexturePro(texture, source, rect, (Vector2){0, 0}, 0, color);
+    render_push(rb, LAYER_UI, texture, source, rect, color);
 }
 
 Layout layout_make(Layout_Orient orient, Rectangle rect, size_t count, float gap) {
@@ -89,17 +90,87 @@ static Rectangle layout_slot(Layout *l, const char *file_path, int line) {
     return r;
 }
 
-void layout_stack_push(Layout **ls, Layout_Orient orient, Rectangle rect, size_t count, float gap) {
+/**
+ * @brief Identifiant d'un noeud : endroit du code, noeud parent et élément du parent.
+ */
+static uint64_t layout_id(uint64_t parent, size_t slot, const char *file_path, int line) {
+    uint64_t parts[3] = {(uintptr_t)file_path, (uint64_t)line, slot};
+    uint64_t id = parent;
+    for (size_t i = 0; i < 3; i++) {
+	id ^= parts[i] + 0x9e3779b97f4a7c15ull + (id << 6) + (id >> 2);
+    }
+    return id;
+}
+
+void layout_stack_init(LayoutStack *ls, ArrayAllocator *allocator) {
+    ls->allocator = allocator;
+    ls->stack = array_create_with(allocator, 4, sizeof(Layout));
+    ls->nodes = map_create_with(allocator, 16, sizeof(LayoutNode), sizeof(uint64_t));
+    ls->hits = 0;
+    ls->misses = 0;
+}
+
+void layout_stack_forget(LayoutStack *ls) {
+    for (size_t i = 0; i < map_size(ls->nodes); i++) {
+	array_free(ls->nodes[i].slots);
+    }
+    map_clear(ls->nodes);
+}
+
+void layout_stack_free(LayoutStack *ls) {
+    layout_stack_forget(ls);
+    map_free(ls->nodes);
+    array_free(ls->stack);
+}
+
+void layout_stack_push_loc(LayoutStack *ls, Layout_Orient orient, Rectangle rect, size_t count, float gap, const char *file_path, int line) {
     Layout l = layout_make(orient, rect, count, gap);
-    array_push(*ls, l);
+    if (array_size(ls->stack) > 0) {
+	// l'élément du parent qui contient la mise en page vient d'être pris par layout_stack_slot
+	l.id = layout_id(array_last(ls->stack).id, array_last(ls->stack).i, file_path, line);
+    } else {
+	l.id = layout_id(0, 0, file_path, line);
+    }
+
+    LayoutNode *node = map_get(ls->nodes, &l.id);
+    if (node && node->orient == orient && memcmp(&node->rect, &rect, sizeof(rect)) == 0 && node->count == count && node->gap == gap) {
+	ls->hits += 1;
+    } else {
+	ls->misses += 1;
+	if (!node) {
+	    LayoutNode added = {.id = l.id, .slots = array_create_with(ls->allocator, count, sizeof(Rectangle))};
+	    ptrdiff_t index = map_put(ls->nodes, added);
+	    if (index < 0) {
+		fprintf(stderr, "%s:%d: ERROR: Could not retain the layout\n", file_path, line);
+		exit(1);
+	    }
+	    node = &ls->nodes[index];
+	}
+	node->orient = orient;
+	node->rect = rect;
+	node->count = count;
+	node->gap = gap;
+	array_clear(node->slots);
+	for (size_t i = 0; i < count; i++) {
+	    array_push(node->slots, layout_slot(&l, file_path, line));
+	}
+	l.i = 0;
+    }
+    l.slots = node->slots;
+    array_push(ls->stack, l);
 }
 
-void layout_stack_pop(Layout **ls) {
-    assert(array_size(*ls) > 0);
-    array_pop_last(*ls);
+void layout_stack_pop(LayoutStack *ls) {
+    assert(array_size(ls->stack) > 0);
+    array_pop_last(ls->stack);
 }
 
-Rectangle layout_stack_slot_loc(Layout **ls, const char *file_path, int line) {
-    assert(array_size(*ls) > 0);
-    return layout_slot(&array_last(*ls), file_path, line);
+Rectangle layout_stack_slot_loc(LayoutStack *ls, const char *file_path, int line) {
+    assert(array_size(ls->stack) > 0);
+    Layout *l = &array_last(ls->stack);
+    if (l->i >= l->count) {
+	fprintf(stderr, "%s:%d: ERROR: Layout overflow\n", file_path, line);
+	exit(1);
+    }
+    return l->slots[l->i++];
 }
@@ -2,7 +2,10 @@
 #define UI_H_
 
 #include <stddef.h>
+#include <stdint.h>
 #include "raylib.h"
+#include "render.h"
+#include "array.h"
 
 /**
  * @brief Macro pour faciliter le dessin d'une mise en page (layout) à l'aide d'une boucle for.
@@ -10,7 +13,7 @@
  * Cette macro simplifie l'utilisation de la mise en page en créant une boucle for avec une instruction
  * break pour effectuer le dessin avec le contexte de mise en page spécifié.
  *
- * @param layout Pointeur vers le tableau de mises en page.
+ * @param layout Pointeur vers la pile de mises en page.
  * @param orient Orientation de la mise en page (LO_HORI ou LO_VERT).
  * @param layout_rect Rectangle délimitant la mise en page.
  * @param count Nombre d'éléments dans la mise en page.
@@ -20,6 +23,7 @@
     for (int _break = (layout_stack_push((layout), (orient), (layout_rect), (count), (gap)), 1); _break; \
 	 _break = 0, layout_stack_pop(layout))
 
+#define layout_stack_push(ls, orient, rect, count, gap) layout_stack_push_loc(ls, orient, rect, count, gap, __FILE__, __LINE__)
 #define layout_stack_slot(ls) layout_stack_slot_loc(ls, __FILE__, __LINE__)
 
 /**
@@ -34,25 +38,58 @@ typedef enum {
  * @brief Structure représentant une mise en page (layout) individuelle.
  */
 typedef struct {
-    Layout_Orient orient; /**< Orientation de la mise en page (LO_HORI ou LO_VERT). */
-    Rectangle rect;       /**< Rectangle délimitant la mise en page. */
-    size_t i;             /**< Indice actuel de la mise en page. */
-    size_t count;         /**< Nombre d'éléments dans la mise en page. */
-    float gap;            /**< Espacement entre les éléments de la mise en page. */
+    Layout_Orient orient;   /**< Orientation de la mise en page (LO_HORI ou LO_VERT). */
+    Rectangle rect;         /**< Rectangle délimitant la mise en page. */
+    size_t i;               /**< Indice actuel de la mise en page. */
+    size_t count;           /**< Nombre d'éléments dans la mise en page. */
+    float gap;              /**< Espacement entre les éléments de la mise en page. */
+    uint64_t id;            /**< Identifiant du noeud retenu (voir LayoutNode). */
+    const Rectangle *slots; /**< Rectangles des éléments, gardés par le noeud retenu. */
 } Layout;
 
+/**
+ * @brief Structure représentant une mise en page retenue d'une frame à l'autre.
+ *
+ * Un noeud est identifié par l'endroit du code qui empile la mise en page, le
+ * noeud parent et l'élément du parent qui la contient : la même boucle de dessin
+ * retrouve chaque frame les mêmes noeuds. Les rectangles des éléments ne sont
+ * recalculés que si l'orientation, le rectangle, le nombre d'éléments ou
+ * l'espacement changent.
+ */
+typedef struct {
+    uint64_t id;          /**< Identifiant du noeud (clé de la table). */
+    Layout_Orient orient; /**< Orientation de la mise en page au dernier calcul. */
+    Rectangle rect;       /**< Rectangle de la mise en page au dernier calcul. */
+    size_t count;         /**< Nombre d'éléments au dernier calcul. */
+    float gap;            /**< Espacement au dernier calcul. */
+    Rectangle *slots;     /**< Rectangles des éléments. */
+} LayoutNode;
+
+/**
+ * @brief Structure représentant la pile des mises en page et les noeuds retenus.
+ */
+typedef struct {
+    Layout *stack;             /**< Mises en page en cours de dessin. */
+    LayoutNode *nodes;         /**< Noeuds retenus, table indexée par identifiant. */
+    ArrayAllocator *allocator; /**< Allocateur de la pile, des noeuds et de leurs rectangles. */
+    size_t hits;               /**< Mises en page empilées sans recalcul. */
+    size_t misses;             /**< Mises en page recalculées. */
+} LayoutStack;
+
 /**
  * @brief Fonction pour dessiner un élément de la mise en page avec une texture et un rectangle source.
  *
  * Cette fonction est utilisée pour dessiner un élément de la mise en page avec une texture spécifiée
  * et un rectangle source optionnel. Elle permet également de marquer l'élément comme sélectionné.
+ * La commande de dessin est ajoutée au tampon de rendu sur la couche LAYER_UI.
  *
+ * @param rb Tampon de commandes de rendu.
  * @param selected Booléen indiquant si l'élément est sélectionné ou non.
  * @param texture Texture2D à dessiner.
  * @param rect Rectangle de dessin pour l'élément.
  * @param source Rectangle source dans la texture (utilisé pour découper la texture).
  */
-void layout_item(bool selected, Texture2D texture, Rectangle rect, Rectangle source);
+void layout_item(RenderBuffer *rb, bool selected, Texture2D texture, Rectangle rect, Rectangle source);
 
 /**
  * @brief Fonction pour créer un élément de mise en page individuel.
@@ -76,32 +113,62 @@ Rectangle layout_make_rec(float x, float y, float w, float h);
  */
 Layout layout_make(Layout_Orient orient, Rectangle rect, size_t count, float gap);
 
+/**
+ * @brief Fonction pour initialiser une pile de mises en page vide.
+ *
+ * @param ls Pointeur vers la pile de mises en page.
+ * @param allocator Allocateur de la pile et des noeuds retenus (NULL pour malloc).
+ */
+void layout_stack_init(LayoutStack *ls, ArrayAllocator *allocator);
+
+/**
+ * @brief Fonction pour libérer une pile de mises en page et ses noeuds retenus.
+ *
+ * @param ls Pointeur vers la pile de mises en page.
+ */
+void layout_stack_free(LayoutStack *ls);
+
+/**
+ * @brief Fonction pour oublier les noeuds retenus (après un rechargement de libplug.so).
+ *
+ * Les identifiants dépendent de l'adresse de `__FILE__`, qui change avec la
+ * bibliothèque chargée.
+ *
+ * @param ls Pointeur vers la pile de mises en page.
+ */
+void layout_stack_forget(LayoutStack *ls);
+
 /**
  * @brief Fonction pour empiler une mise en page sur le dessus de la pile.
  *
- * @param ls Pointeur vers le tableau de mises en page.
+ * Les rectangles des éléments viennent du noeud retenu pour cet endroit du code,
+ * et ne sont recalculés que si la mise en page a changé depuis la frame précédente.
+ *
+ * @param ls Pointeur vers la pile de mises en page.
  * @param orient Orientation de la mise en page (LO_HORI ou LO_VERT).
  * @param rect Rectangle délimitant la mise en page.
  * @param count Nombre d'éléments dans la mise en page.
  * @param gap Espacement entre les éléments de la mise en page.
+ * @param file_path Chemin du fichier source qui empile la mise en page.
+ * @param line Numéro de ligne du fichier source qui empile la mise en page.
  */
-void layout_stack_push(Layout **ls, Layout_Orient orient, Rectangle rect, size_t count, float gap);
+void layout_stack_push_loc(LayoutStack *ls, Layout_Orient orient, Rectangle rect, size_t count, float gap, const char *file_path, int line);
 
 /**
  * @brief Fonction pour dépiler la mise en page du dessus de la pile.
  *
- * @param ls Pointeur vers le tableau de mises en page.
+ * @param ls Pointeur vers la pile de mises en page.
  */
-void layout_stack_pop(Layout **ls);
+void layout_stack_pop(LayoutStack *ls);
 
 /**
  * @brief Fonction pour obtenir le rectangle de la mise en page actuelle sur le dessus de la pile.
  *
- * @param ls Pointeur vers le tableau de mises en page.
+ * @param ls Pointeur vers la pile de mises en page.
  * @param file_path Chemin du fichier source pour le débogage.
  * @param line Numéro de ligne du fichier source pour le débogage.
  * @return Rectangle de la mise en page actuelle.
  */
-Rectangle layout_stack_slot_loc(Layout **ls, const char *file_path, int line);
+Rectangle layout_stack_slot_loc(LayoutStack *ls, const char *file_path, int line);
 
 #endif // UI_H_
@@ -0,0 +1,792 @@
+/* -*- compile-command: "make -C .. libplug" -*- */
+#include "level.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif // __SSE2__
+
+#include "xml.h"
+#include "array.h"
+#include "buffer.h"
+
+// alignement du plan de tuiles dans un niveau binaire
+#define LEVEL_TILES_ALIGN 16
+
+void level_init(Level *level, int width, int height) {
+    memset(level, 0, sizeof(*level));
+    level->width = width;
+    level->height = height;
+    level->tiles = array_create_init(width * height, sizeof(int32_t));
+    array_resize(level->tiles, (size_t)width * height);
+    memset(level->tiles, 0, sizeof(int32_t) * width * height);
+    level->entities = array_create_init(4, sizeof(LevelEntity));
+}
+
+void level_add_entity(Level *level, LevelEntity entity) {
+    assert(level->mapping == NULL);
+    array_push(level->entities, entity);
+    level->entity_count = array_size(level->entities);
+}
+
+void level_set_metadata(Level *level, const char *metadata) {
+    assert(level->mapping == NULL);
+    free(level->metadata);
+    level->metadata = metadata ? strdup(metadata) : NULL;
+    level->metadata_size = metadata ? strlen(metadata) : 0;
+}
+
+void level_free(Level *level) {
+    if (level->mapping) {
+	munmap(level->mapping, level->mapping_size);
+    } else {
+	if (level->tiles) array_free(level->tiles);
+	if (level->entities) array_free(level->entities);
+	free(level->metadata);
+    }
+    memset(level, 0, sizeof(*level));
+}
+
+LevelFormat level_format(const char *file_path) {
+    const char *dot = strrchr(file_path, '.');
+    if (!dot || dot == file_path) return LEVEL_FORMAT_UNKNOWN;
+    if (strcmp(dot + 1, "xml") == 0) return LEVEL_FORMAT_XML;
+    if (strcmp(dot + 1, "lvl") == 0) return LEVEL_FORMAT_BIN;
+    return LEVEL_FORMAT_UNKNOWN;
+}
+
+// motifs SWAR : un octet répété dans les huit octets d'un mot
+#define SWAR_ONES  0x0101010101010101ull
+#define SWAR_HIGHS 0x8080808080808080ull
+#define SWAR_LOWS  0x7F7F7F7F7F7F7F7Full
+#define SWAR_BYTE(c) ((uint64_t)(unsigned char)(c) * SWAR_ONES)
+
+// octets impairs d'un mot (virgules du motif "d,d,d,d,")
+#define SWAR_ODD_HIGHS 0x8000800080008000ull
+
+/**
+ * @brief Marque (bit de poids fort) les octets nuls d'un mot, sans faux positif.
+ */
+static inline uint64_t swar_zero_bytes(uint64_t w) {
+    return ~(((w & SWAR_LOWS) + SWAR_LOWS) | w | SWAR_LOWS);
+}
+
+/**
+ * @brief Marque les octets de `w` égaux à `c`.
+ */
+static inline uint64_t swar_eq(uint64_t w, char c) {
+    return swar_zero_bytes(w ^ SWAR_BYTE(c));
+}
+
+/**
+ * @brief Marque les octets de `w` qui ne sont pas des chiffres ASCII.
+ */
+static inline uint64_t swar_non_digits(uint64_t w) {
+    // chiffre : quartet haut à 3 et quartet bas inférieur à 10 (+6 ne déborde que pour 10..15)
+    uint64_t high = (w & SWAR_BYTE(0xF0)) ^ SWAR_BYTE(0x30);
+    uint64_t low = ((w & SWAR_BYTE(0x0F)) + SWAR_BYTE(0x06)) & SWAR_BYTE(0x10);
+    return ~swar_zero_bytes(high | low) & SWAR_HIGHS;
+}
+
+#ifdef __SSE2__
+#define LEVEL_CSV_BLOCK 16
+
+/**
+ * @brief Décode par blocs de 16 octets les tuiles d'un ou deux chiffres ("0,0,12,3,...").
+ *
+ * Les valeurs des tuiles des niveaux (masques de bord et objets) tiennent sur un ou
+ * deux chiffres. Chaque bloc est classé en une fois (chiffres, virgules) ; seule la
+ * partie qui se termine par la dernière virgule du bloc est consommée, et seulement
+ * si elle suit exactement le motif "chiffres,chiffres,", ce qui la valide au passage.
+ * Le reste (blancs, valeurs plus longues, erreurs) est laissé à la boucle octet par octet.
+ *
+ * @param written Nombre de tuiles écrites.
+ * @return Le nombre d'octets consommés, 0 si le motif ne commence pas en `data`.
+ */
+static size_t level_csv_blocks(const char *data, size_t size, int32_t *tiles, size_t room, size_t *written) {
+    const __m128i ascii_zero = _mm_set1_epi8('0');
+    const __m128i nine = _mm_set1_epi8(9);
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i low_bytes = _mm_set1_epi16(0x00FF);
+    size_t i = 0;
+    size_t n = 0;
+
+    while (i + LEVEL_CSV_BLOCK <= size) {
+	__m128i v = _mm_loadu_si128((const __m128i *)(data + i));
+	__m128i d = _mm_sub_epi8(v, ascii_zero);
+	__m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(d, nine), d);
+	unsigned int digits = _mm_movemask_epi8(is_digit);
+	unsigned int commas = _mm_movemask_epi8(_mm_cmpeq_epi8(v, comma));
+
+	// cas le plus courant : huit tuiles d'un chiffre ("d,d,d,d,d,d,d,d,")
+	if (digits == 0x5555 && commas == 0xAAAA) {
+	    if (room - n < LEVEL_CSV_BLOCK / 2) break;
+	    __m128i values = _mm_and_si128(d, low_bytes);
+	    _mm_storeu_si128((__m128i *)(tiles + n), _mm_unpacklo_epi16(values, zero));
+	    _mm_storeu_si128((__m128i *)(tiles + n + 4), _mm_unpackhi_epi16(values, zero));
+	    n += LEVEL_CSV_BLOCK / 2;
+	    i += LEVEL_CSV_BLOCK;
+	    continue;
+	}
+
+	// partie du bloc terminée par sa dernière virgule
+	if (commas == 0) break;
+	unsigned int prefix = (2u << (31 - __builtin_clz(commas))) - 1;
+	unsigned int prefix_digits = digits & prefix;
+	if ((prefix_digits | commas) != prefix) break;                        // blanc ou caractère invalide
+	if ((commas & 1) || (commas & (commas >> 1))) break;                  // champ vide
+	if (prefix_digits & (prefix_digits >> 1) & (prefix_digits >> 2)) break; // trois chiffres ou plus
+	size_t count = __builtin_popcount(commas);
+	if (room - n < count) break;
+
+	// valeur de chaque champ sur son dernier chiffre : chiffre + 10 * chiffre précédent
+	__m128i units = _mm_and_si128(d, is_digit);
+	__m128i tens = _mm_slli_si128(units, 1);
+	__m128i tens2 = _mm_add_epi8(tens, tens);
+	__m128i tens8 = _mm_add_epi8(tens2, tens2);
+	tens8 = _mm_add_epi8(tens8, tens8);
+	unsigned char values[LEVEL_CSV_BLOCK];
+	_mm_storeu_si128((__m128i *)values, _mm_add_epi8(units, _mm_add_epi8(tens8, tens2)));
+
+	while (commas) {
+	    tiles[n++] = values[__builtin_ctz(commas) - 1];
+	    commas &= commas - 1;
+	}
+	i += 32 - __builtin_clz(prefix);
+    }
+
+    *written = n;
+    return i;
+}
+#else
+#define LEVEL_CSV_BLOCK 8
+
+/**
+ * @brief Variante SWAR de level_csv_blocks sans SSE2, limitée aux tuiles d'un chiffre ("d,d,d,d,").
+ */
+static size_t level_csv_blocks(const char *data, size_t size, int32_t *tiles, size_t room, size_t *written) {
+    size_t i = 0;
+    size_t n = 0;
+
+    while (i + LEVEL_CSV_BLOCK <= size && room - n >= LEVEL_CSV_BLOCK / 2) {
+	uint64_t w;
+	memcpy(&w, data + i, sizeof(w));
+	if (swar_non_digits(w) != SWAR_ODD_HIGHS || swar_eq(w, ',') != SWAR_ODD_HIGHS) break;
+
+	// octets pairs (petit-boutiste) : quatre chiffres
+	for (size_t k = 0; k < LEVEL_CSV_BLOCK / 2; k++) {
+	    tiles[n++] = (int32_t)((w >> (16 * k)) & 0x0F);
+	}
+	i += LEVEL_CSV_BLOCK;
+    }
+
+    *written = n;
+    return i;
+}
+#endif // __SSE2__
+
+void level_csv_init(LevelCsv *csv, int32_t *tiles, size_t capacity) {
+    memset(csv, 0, sizeof(*csv));
+    csv->tiles = tiles;
+    csv->capacity = capacity;
+}
+
+bool level_csv_feed(LevelCsv *csv, const char *data, size_t size) {
+    if (csv->error) return false;
+
+    // état local pour que la boucle reste dans les registres
+    size_t count = csv->count;
+    int32_t value = csv->value;
+    int digits = csv->digits;
+    bool field = csv->field;
+    const char *error = NULL;
+    size_t i = 0;
+    size_t retry = 0;
+
+    // en début de champ, on tente d'abord les blocs "d,d,d,..."
+    if (!field && digits == 0) {
+	size_t written;
+	i += level_csv_blocks(data, size, csv->tiles + count, csv->capacity - count, &written);
+	count += written;
+    }
+
+    for (; i < size; i++) {
+	unsigned int d = (unsigned char)data[i] - '0';
+	if (d < 10) {
+	    if (digits == 0 && field) { error = "missing comma between tiles"; break; }
+	    if (++digits > LEVEL_CSV_MAX_DIGITS) { error = "tile value too large"; break; }
+	    value = value * 10 + d;
+	    continue;
+	}
+
+	if (digits) {
+	    if (count >= csv->capacity) { error = "too many tiles"; break; }
+	    csv->tiles[count++] = value;
+	    value = 0;
+	    digits = 0;
+	    field = true;
+	}
+
+	char c = data[i];
+	if (c == ',') {
+	    if (!field) { error = "empty tile"; break; }
+	    field = false;
+	} else if (c != ' ' && c != '\n' && c != '\r' && c != '\t') {
+	    error = "invalid character in tiles";
+	    break;
+	}
+
+	// après un séparateur, le champ suivant commence peut-être une suite de blocs ;
+	// après un échec, on attend un bloc avant de réessayer
+	if (!field && i >= retry) {
+	    size_t written;
+	    size_t n = level_csv_blocks(data + i + 1, size - i - 1, csv->tiles + count, csv->capacity - count, &written);
+	    count += written;
+	    i += n;
+	    if (n == 0) retry = i + LEVEL_CSV_BLOCK;
+	}
+    }
+
+    csv->count = count;
+    csv->value = value;
+    csv->digits = digits;
+    csv->field = field;
+    if (error) {
+	csv->error = error;
+	csv->offset += i;
+	return false;
+    }
+    csv->offset += size;
+    return true;
+}
+
+bool level_csv_finish(LevelCsv *csv) {
+    if (csv->error) return false;
+    if (csv->digits) {
+	if (csv->count >= csv->capacity) {
+	    csv->error = "too many tiles";
+	    return false;
+	}
+	csv->tiles[csv->count++] = csv->value;
+	csv->digits = 0;
+	csv->field = true;
+    }
+    if (csv->count > 0 && !csv->field) csv->error = "trailing comma";
+    else if (csv->count != csv->capacity) csv->error = "too few tiles";
+    return csv->error == NULL;
+}
+
+/*
+ * Code généré à partir du schéma LIST_OF_LEVEL_ELEMENTS (level.h).
+ */
+
+// type C de chaque type d'attribut du schéma
+#define LEVEL_XML_TYPE_INT int32_t
+
+/*
+ * Attributs décodés de chaque élément (LevelXml_root, LevelXml_player...).
+ * Le bit i de `seen` indique que le i-ème attribut du schéma a été lu.
+ */
+#define LEVEL_FIELD(type, name, key, min, max, fallback) LEVEL_XML_TYPE_##type name;
+#define LEVEL_ELEMENT(NAME, name, tag, FIELDS)	\
+    typedef struct {				\
+	uint32_t seen;				\
+	FIELDS(LEVEL_FIELD)			\
+    } LevelXml_##name;
+LIST_OF_LEVEL_ELEMENTS
+#undef LEVEL_ELEMENT
+#undef LEVEL_FIELD
+
+/**
+ * @enum LevelXmlElement
+ * @brief Éléments du schéma ; LEVEL_XML_COUNT désigne un élément inconnu.
+ */
+typedef enum {
+#define LEVEL_ELEMENT(NAME, name, tag, FIELDS) LEVEL_XML_##NAME,
+    LIST_OF_LEVEL_ELEMENTS
+#undef LEVEL_ELEMENT
+    LEVEL_XML_COUNT,
+} LevelXmlElement;
+
+/**
+ * @union LevelXmlAttributes
+ * @brief Attributs d'un élément du schéma, quel qu'il soit.
+ */
+typedef union {
+#define LEVEL_ELEMENT(NAME, name, tag, FIELDS) LevelXml_##name name;
+    LIST_OF_LEVEL_ELEMENTS
+#undef LEVEL_ELEMENT
+} LevelXmlAttributes;
+
+static const char *level_xml_tags[LEVEL_XML_COUNT] = {
+#define LEVEL_ELEMENT(NAME, name, tag, FIELDS) [LEVEL_XML_##NAME] = tag,
+    LIST_OF_LEVEL_ELEMENTS
+#undef LEVEL_ELEMENT
+};
+
+/**
+ * @brief Décode un entier décimal compris entre `min` et `max`.
+ *
+ * @return `false` si la valeur n'est pas un entier ou sort des bornes (message dans `error`).
+ */
+static bool level_xml_parse_INT(XMLStr value, int32_t min, int32_t max, int32_t *out, char *error, size_t error_size) {
+    size_t i = 0;
+    bool negative = value.size > 0 && value.data[0] == '-';
+    if (negative) i++;
+    int64_t n = 0;
+    bool valid = i < value.size;
+    for (; i < value.size && valid; i++) {
+	char c = value.data[i];
+	valid = c >= '0' && c <= '9';
+	n = n * 10 + (c - '0');
+	// au-delà, la valeur sort des bornes de toute façon
+	if (n > (int64_t)INT32_MAX + 1) n = (int64_t)INT32_MAX + 1;
+    }
+    if (negative) n = -n;
+    if (!valid || n < min || n > max) {
+	snprintf(error, error_size, "expected an integer in [%d, %d], got \"%.*s\"", min, max, (int)value.size, value.data);
+	return false;
+    }
+    *out = (int32_t)n;
+    return true;
+}
+
+static const char *level_xml_format_INT(Buffer *number, int32_t value) {
+    number->size = 0;
+    buffer_append_int(number, value);
+    return buffer_cstr(number);
+}
+
+/*
+ * level_xml_defaults_<nom> : valeurs par défaut du schéma.
+ * level_xml_decode_<nom> : range un attribut dans son champ, avec vérification des bornes.
+ * level_xml_encode_<nom> : ajoute les attributs à un nœud XML.
+ */
+#define LEVEL_DEFAULT_FIELD(type, name, key, min, max, fallback) out->name = (fallback);
+#define LEVEL_DECODE_FIELD(type, name, key_str, min, max, fallback)	\
+    if (xml_str_eq(key, key_str)) {					\
+	if (out->seen & bit) {						\
+	    snprintf(error, error_size, "duplicate attribute %s", key_str); \
+	    return false;						\
+	}								\
+	out->seen |= bit;						\
+	char message[128];						\
+	if (!level_xml_parse_##type(value, min, max, &out->name, message, sizeof(message))) { \
+	    snprintf(error, error_size, "attribute %s: %s", key_str, message); \
+	    return false;						\
+	}								\
+	return true;							\
+    }									\
+    bit <<= 1;
+#define LEVEL_ENCODE_FIELD(type, name, key, min, max, fallback) xml_attrib_add(node, key, level_xml_format_##type(number, in->name));
+#define LEVEL_ELEMENT(NAME, name, tag, FIELDS)				\
+    static void level_xml_defaults_##name(LevelXml_##name *out) {	\
+	out->seen = 0;							\
+	FIELDS(LEVEL_DEFAULT_FIELD)					\
+    }									\
+    static bool level_xml_decode_##name(LevelXml_##name *out, XMLStr key, XMLStr value, char *error, size_t error_size) { \
+	uint32_t bit = 1;						\
+	(void)out;							\
+	(void)bit;							\
+	(void)value;							\
+	FIELDS(LEVEL_DECODE_FIELD)					\
+	snprintf(error, error_size, "unknown attribute %.*s", (int)key.size, key.data); \
+	return false;							\
+    }									\
+    static void level_xml_encode_##name(XMLNode *node, const LevelXml_##name *in, Buffer *number) { \
+	(void)node;							\
+	(void)in;							\
+	(void)number;							\
+	FIELDS(LEVEL_ENCODE_FIELD)					\
+    }
+LIST_OF_LEVEL_ELEMENTS
+#undef LEVEL_ELEMENT
+#undef LEVEL_ENCODE_FIELD
+#undef LEVEL_DECODE_FIELD
+#undef LEVEL_DEFAULT_FIELD
+
+static LevelXmlElement level_xml_element(XMLStr tag) {
+    for (size_t i = 0; i < LEVEL_XML_COUNT; i++) {
+	if (xml_str_eq(tag, level_xml_tags[i])) return i;
+    }
+    return LEVEL_XML_COUNT;
+}
+
+static void level_xml_defaults(LevelXmlElement element, LevelXmlAttributes *out) {
+    switch (element) {
+#define LEVEL_ELEMENT(NAME, name, tag, FIELDS) case LEVEL_XML_##NAME: level_xml_defaults_##name(&out->name); break;
+	LIST_OF_LEVEL_ELEMENTS
+#undef LEVEL_ELEMENT
+    default: break;
+    }
+}
+
+static bool level_xml_decode(LevelXmlElement element, LevelXmlAttributes *out, XMLStr key, XMLStr value, char *error, size_t error_size) {
+    switch (element) {
+#define LEVEL_ELEMENT(NAME, name, tag, FIELDS) case LEVEL_XML_##NAME: return level_xml_decode_##name(&out->name, key, value, error, error_size);
+	LIST_OF_LEVEL_ELEMENTS
+#undef LEVEL_ELEMENT
+    default: return true;
+    }
+}
+
+static void level_xml_encode(XMLNode *node, LevelXmlElement element, const LevelXmlAttributes *in, Buffer *number) {
+    switch (element) {
+#define LEVEL_ELEMENT(NAME, name, tag, FIELDS) case LEVEL_XML_##NAME: level_xml_encode_##name(node, &in->name, number); break;
+	LIST_OF_LEVEL_ELEMENTS
+#undef LEVEL_ELEMENT
+    default: break;
+    }
+}
+
+/**
+ * @struct LevelReader
+ * @brief État du décodage en flux d'un niveau XML : tuiles et entités sont produites au fil de l'analyse.
+ */
+typedef struct {
+    Level *level;                 /**< Niveau à remplir. */
+    const char *file_path;        /**< Fichier lu (messages d'erreur). */
+    XMLPosition position;         /**< Position de la balise en cours, tenue à jour par l'analyseur. */
+    size_t depth;                 /**< Profondeur de l'élément en cours (1 pour la racine). */
+    LevelXmlAttributes root;      /**< Attributs de la racine. */
+    LevelXmlElement element;      /**< Enfant de la racine en cours. */
+    LevelXmlAttributes attrs;     /**< Attributs de l'enfant en cours. */
+    LevelCsv csv;                 /**< Décodeur du texte du noeud "csv". */
+    XMLPosition csv_position;     /**< Position du noeud "csv". */
+    bool has_csv;                 /**< Le noeud "csv" a déjà été rencontré. */
+    char *metadata;               /**< Tableau dynamique : texte du noeud "meta" (dans `metadata_storage` s'il est court). */
+    ArrayInline(char, 64) metadata_storage; /**< Stockage intégré de `metadata`. */
+    bool failed;                  /**< Une erreur a été signalée ; la suite du document est ignorée. */
+} LevelReader;
+
+/**
+ * @brief Signale la première erreur du document, avec sa position.
+ */
+static void level_reader_fail(LevelReader *reader, XMLPosition position, XMLStr tag, const char *message) {
+    if (reader->failed) return;
+    reader->failed = true;
+    fprintf(stderr, "ERROR: %s:%zu:%zu: <%.*s> %s\n", reader->file_path, position.line, position.column,
+	    (int)tag.size, tag.data, message);
+}
+
+/**
+ * @brief Crée le plan de tuiles une fois les attributs de la racine connus.
+ */
+static void level_reader_tiles(LevelReader *reader) {
+    if (reader->level->tiles) return;
+    int width = reader->root.root.width, height = reader->root.root.height;
+    level_init(reader->level, width, height);
+    level_csv_init(&reader->csv, reader->level->tiles, (size_t)width * height);
+}
+
+static void level_reader_start(void *user, XMLStr tag) {
+    LevelReader *reader = user;
+    reader->depth++;
+    if (reader->failed) return;
+
+    if (reader->depth == 1) {
+	if (level_xml_element(tag) != LEVEL_XML_ROOT) {
+	    level_reader_fail(reader, reader->position, tag, "expected the root element <root>");
+	    return;
+	}
+	level_xml_defaults(LEVEL_XML_ROOT, &reader->root);
+	return;
+    }
+    if (reader->depth > 2) {
+	level_reader_fail(reader, reader->position, tag, "unexpected nested element");
+	return;
+    }
+
+    level_reader_tiles(reader);
+    reader->element = level_xml_element(tag);
+    if (reader->element == LEVEL_XML_COUNT || reader->element == LEVEL_XML_ROOT) {
+	level_reader_fail(reader, reader->position, tag, "unknown element");
+	return;
+    }
+    if (reader->element == LEVEL_XML_CSV) {
+	if (reader->has_csv) {
+	    level_reader_fail(reader, reader->position, tag, "duplicate element");
+	    return;
+	}
+	reader->has_csv = true;
+	reader->csv_position = reader->position;
+    }
+    level_xml_defaults(reader->element, &reader->attrs);
+}
+
+static void level_reader_attribute(void *user, XMLStr tag, XMLStr key, XMLStr value) {
+    LevelReader *reader = user;
+    if (reader->failed) return;
+
+    char error[256];
+    bool ok = reader->depth == 1
+	? level_xml_decode(LEVEL_XML_ROOT, &reader->root, key, value, error, sizeof(error))
+	: level_xml_decode(reader->element, &reader->attrs, key, value, error, sizeof(error));
+    if (!ok) level_reader_fail(reader, reader->position, tag, error);
+}
+
+static void level_reader_text(void *user, XMLStr tag, XMLStr text) {
+    LevelReader *reader = user;
+    if (reader->failed || reader->depth != 2) return;
+    if (reader->element == LEVEL_XML_META) {
+	for (size_t i = 0; i < text.size; i++) array_push_inline(reader->metadata, reader->metadata_storage, text.data[i]);
+	return;
+    }
+    // Le texte peut arriver en plusieurs morceaux : le décodeur reprend une valeur coupée.
+    if (reader->element == LEVEL_XML_CSV) level_csv_feed(&reader->csv, text.data, text.size);
+    (void)tag;
+}
+
+static void level_reader_end(void *user, XMLStr tag) {
+    LevelReader *reader = user;
+    reader->depth--;
+    if (reader->failed || reader->depth != 1) return;
+
+    char error[256];
+    if (reader->element == LEVEL_XML_CSV) {
+	if (!level_csv_finish(&reader->csv)) {
+	    snprintf(error, sizeof(error), "%s (at byte %zu, %zu tiles read)", reader->csv.error, reader->csv.offset, reader->csv.count);
+	    level_reader_fail(reader, reader->csv_position, tag, error);
+	}
+    } else if (reader->element == LEVEL_XML_PLAYER) {
+	const LevelXml_player *player = &reader->attrs.player;
+	if (player->x >= reader->level->width || player->y >= reader->level->height) {
+	    snprintf(error, sizeof(error), "player at (%d, %d) is outside the %dx%d level",
+		     player->x, player->y, reader->level->width, reader->level->height);
+	    level_reader_fail(reader, reader->position, tag, error);
+	    return;
+	}
+	level_add_entity(reader->level, (LevelEntity){.type = LEVEL_ENTITY_PLAYER, .x = player->x, .y = player->y});
+    }
+}
+
+bool level_load_xml(Level *level, const char *file_path) {
+    memset(level, 0, sizeof(*level));
+    LevelReader reader = {
+	.level = level,
+	.file_path = file_path,
+    };
+    array_init_inline(reader.metadata, reader.metadata_storage);
+    level_xml_defaults(LEVEL_XML_ROOT, &reader.root);
+    XMLSaxHandler handler = {
+	.user = &reader,
+	.start = level_reader_start,
+	.attribute = level_reader_attribute,
+	.text = level_reader_text,
+	.end = level_reader_end,
+	.position = &reader.position,
+    };
+
+    bool result = xml_sax_parse_file(file_path, handler) && !reader.failed;
+    if (result) {
+	// un document réduit à sa racine est un niveau vide
+	level_reader_tiles(&reader);
+
+	// texte du noeud "meta" sans les blancs de début et de fin
+	size_t start = 0, end = array_size(reader.metadata);
+	while (start < end && (unsigned char)reader.metadata[start] <= ' ') start++;
+	while (end > start && (unsigned char)reader.metadata[end - 1] <= ' ') end--;
+	if (end > start) {
+	    level->metadata = strndup(reader.metadata + start, end - start);
+	    level->metadata_size = end - start;
+	}
+    } else {
+	level_free(level);
+    }
+    array_free_inline(reader.metadata, reader.metadata_storage);
+    return result;
+}
+
+bool level_load_bin(Level *level, const char *file_path) {
+    bool result = true;
+    memset(level, 0, sizeof(*level));
+
+    int fd = open(file_path, O_RDONLY);
+    if (fd == -1) {
+	fprintf(stderr, "ERROR: Could not open the file %s: %s\n", file_path, strerror(errno));
+	return_defer(false);
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+	fprintf(stderr, "ERROR: Could not stat the file %s: %s\n", file_path, strerror(errno));
+	return_defer(false);
+    }
+
+    size_t size = st.st_size;
+    if (size < sizeof(LevelHeader)) {
+	fprintf(stderr, "ERROR: The file %s is too small to be a level\n", file_path);
+	return_defer(false);
+    }
+
+    // copie privée : le jeu peut modifier les tuiles sans toucher au fichier
+    char *data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+	fprintf(stderr, "ERROR: Could not mmap the file %s: %s\n", file_path, strerror(errno));
+	return_defer(false);
+    }
+    level->mapping = data;
+    level->mapping_size = size;
+
+    const LevelHeader *header = (const LevelHeader *)data;
+    if (memcmp(header->magic, LEVEL_MAGIC, 4) != 0) {
+	fprintf(stderr, "ERROR: %s is not a binary level\n", file_path);
+	return_defer(false);
+    }
+    if (header->version != LEVEL_VERSION) {
+	fprintf(stderr, "ERROR: %s has an unsupported level version %u\n", file_path, header->version);
+	return_defer(false);
+    }
+
+    uint64_t tiles_size = (uint64_t)header->width * header->height * sizeof(int32_t);
+    uint64_t entities_size = (uint64_t)header->entity_count * sizeof(LevelEntity);
+    if (header->width == 0 || header->height == 0 || header->tiles_offset % sizeof(int32_t) != 0
+	|| header->entities_offset % sizeof(int32_t) != 0
+	|| header->tiles_offset + tiles_size > size
+	|| header->entities_offset + entities_size > size
+	|| (uint64_t)header->metadata_offset + header->metadata_size > size) {
+	fprintf(stderr, "ERROR: %s has a corrupted level header\n", file_path);
+	return_defer(false);
+    }
+
+    level->width = header->width;
+    level->height = header->height;
+    level->tiles = (int32_t *)(data + header->tiles_offset);
+    level->entities = (LevelEntity *)(data + header->entities_offset);
+    level->entity_count = header->entity_count;
+    level->metadata = header->metadata_size ? data + header->metadata_offset : NULL;
+    level->metadata_size = header->metadata_size;
+
+ defer:
+    if (fd != -1) close(fd);
+    if (!result) level_free(level);
+    return result;
+}
+
+bool level_load(Level *level, const char *file_path) {
+    switch (level_format(file_path)) {
+    case LEVEL_FORMAT_XML: return level_load_xml(level, file_path);
+    case LEVEL_FORMAT_BIN: return level_load_bin(level, file_path);
+    default:
+	fprintf(stderr, "ERROR: Unknown level format: %s\n", file_path);
+	memset(level, 0, sizeof(*level));
+	return false;
+    }
+}
+
+bool level_save_xml(const Level *level, const char *file_path) {
+    // Construit le texte CSV de la configuration des blocs, en temps linéaire.
+    Buffer csv;
+    buffer_init(&csv, (size_t)level->width * level->height * 3 + 1);
+    for (int y = 0; y < level->height; y++) {
+	for (int x = 0; x < level->width; x++) {
+	    buffer_append_int(&csv, level->tiles[y * level->width + x]);
+
+	    if (y != level->height - 1 || x != level->width - 1) buffer_append_char(&csv, ',');
+	}
+	if (y != level->height - 1) buffer_append_char(&csv, '\n');
+    }
+
+    // Initialise un document XML et ajoute le noeud CSV pour la configuration des blocs.
+    Buffer number;
+    buffer_init(&number, 16);
+    XMLDocument doc = xml_doc_init(level_xml_tags[LEVEL_XML_ROOT]);
+    LevelXmlAttributes attrs = {.root = {.width = level->width, .height = level->height}};
+    level_xml_encode(doc.root, LEVEL_XML_ROOT, &attrs, &number);
+    xml_insert_node(doc.root, level_xml_tags[LEVEL_XML_CSV], buffer_cstr(&csv));
+    buffer_free(&csv);
+
+    // Ajoute les informations des joueurs sous forme de noeuds XML.
+    for (size_t i = 0; i < level->entity_count; i++) {
+	if (level->entities[i].type != LEVEL_ENTITY_PLAYER) continue;
+	XMLNode *player = xml_insert_node(doc.root, level_xml_tags[LEVEL_XML_PLAYER], NULL);
+	attrs.player = (LevelXml_player){.x = level->entities[i].x, .y = level->entities[i].y};
+	level_xml_encode(player, LEVEL_XML_PLAYER, &attrs, &number);
+    }
+    buffer_free(&number);
+
+    if (level->metadata_size) {
+	char *metadata = strndup(level->metadata, level->metadata_size);
+	xml_insert_node(doc.root, level_xml_tags[LEVEL_XML_META], metadata);
+	free(metadata);
+    }
+
+    // Écrit le document XML avec l'indentation de 2 espaces.
+    bool result = xml_doc_write(&doc, file_path, 2);
+    xml_doc_free(&doc);
+    return result;
+}
+
+bool level_save_bin(const Level *level, const char *file_path) {
+    size_t tiles_size = (size_t)level->width * level->height * sizeof(int32_t);
+    size_t entities_size = level->entity_count * sizeof(LevelEntity);
+    LevelHeader header = {
+	.magic = LEVEL_MAGIC,
+	.version = LEVEL_VERSION,
+	.width = level->width,
+	.height = level->height,
+	.entity_count = level->entity_count,
+	.metadata_size = level->metadata_size,
+	.tiles_offset = (sizeof(LevelHeader) + LEVEL_TILES_ALIGN - 1) & ~(LEVEL_TILES_ALIGN - 1),
+    };
+    header.entities_offset = header.tiles_offset + tiles_size;
+    header.metadata_offset = header.entities_offset + entities_size;
+
+    // Le fichier est construit en mémoire puis écrit en un seul appel.
+    Buffer out;
+    buffer_init(&out, header.metadata_offset + level->metadata_size);
+    buffer_append(&out, (const char *)&header, sizeof(header));
+    buffer_append_repeat(&out, 0, header.tiles_offset - sizeof(header));
+    buffer_append(&out, (const char *)level->tiles, tiles_size);
+    buffer_append(&out, (const char *)level->entities, entities_size);
+    if (level->metadata_size) buffer_append(&out, level->metadata, level->metadata_size);
+
+    bool result = buffer_write_file(&out, file_path);
+    buffer_free(&out);
+    return result;
+}
+
+bool level_save(const Level *level, const char *file_path) {
+    switch (level_format(file_path)) {
+    case LEVEL_FORMAT_XML: return level_save_xml(level, file_path);
+    case LEVEL_FORMAT_BIN: return level_save_bin(level, file_path);
+    default:
+	fprintf(stderr, "ERROR: Unknown level format: %s\n", file_path);
+	return false;
+    }
+}
+
+char** level_get_filepaths(const char *path) {
+    char **paths = array_create_init(2, sizeof(char*));
+    DIR *dir;
+    struct dirent *entry;
+
+    if ((dir = opendir(path)) != NULL) {
+	while ((entry = readdir(dir)) != NULL) {
+	    if (entry->d_type != DT_DIR && level_format(entry->d_name) != LEVEL_FORMAT_UNKNOWN) {
+		int size_str = snprintf(NULL, 0, "%s/%s", path, entry->d_name);
+		char *full_path = malloc(size_str + 1);
+		sprintf(full_path, "%s/%s", path, entry->d_name);
+		array_push(paths, full_path);
+	    }
+	}
+	closedir(dir);
+    } else {
+	array_free(paths);
+	if (mkdir(path, 0777) == -1) {
+	    fprintf(stderr, "Error: Could not create a directory: %s\n", strerror(errno));
+	    exit(1);
+	}
+	return level_get_filepaths(path);
+    }
+
+    return paths;
+}
@@ -0,0 +1,300 @@
+#ifndef LEVEL_H_
+#define LEVEL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @def LEVEL_DEFAULT_WIDTH
+ * @brief Largeur en tuiles d'un niveau sans dimensions explicites (TILESX dans plug.h).
+ */
+#define LEVEL_DEFAULT_WIDTH 22
+
+/**
+ * @def LEVEL_DEFAULT_HEIGHT
+ * @brief Hauteur en tuiles d'un niveau sans dimensions explicites (TILESY dans plug.h).
+ */
+#define LEVEL_DEFAULT_HEIGHT 13
+
+/**
+ * @def LEVEL_MAGIC
+ * @brief Signature des quatre premiers octets d'un niveau binaire.
+ */
+#define LEVEL_MAGIC "LMLV"
+
+/**
+ * @def LEVEL_VERSION
+ * @brief Version du format binaire écrite par level_save_bin.
+ */
+#define LEVEL_VERSION 1
+
+/**
+ * @def LEVEL_TILE_COIN
+ * @brief Valeur d'une tuile pièce (BLOCK_COIN dans plug.h).
+ */
+#define LEVEL_TILE_COIN 32
+
+/**
+ * @def LEVEL_MAX_SIZE
+ * @brief Largeur et hauteur maximales d'un niveau XML, en tuiles.
+ */
+#define LEVEL_MAX_SIZE 4096
+
+/*
+ * Schéma d'un niveau XML.
+ *
+ * Chaque élément est décrit par LEVEL_ELEMENT(NOM, nom, "tag", ATTRIBUTS) et ses
+ * attributs par LEVEL_FIELD(type, nom, "clé", min, max, défaut). Le décodeur et
+ * l'encodeur de level.c, ainsi que les structures qu'ils remplissent, sont générés
+ * à partir de ces listes : un nouvel attribut ne demande qu'une ligne ici, puis son
+ * utilisation dans le chargement et l'écriture. Seul le type INT (int32_t) existe.
+ */
+#define LEVEL_ROOT_FIELDS(LEVEL_FIELD)					\
+    LEVEL_FIELD(INT, width, "width", 1, LEVEL_MAX_SIZE, LEVEL_DEFAULT_WIDTH) \
+    LEVEL_FIELD(INT, height, "height", 1, LEVEL_MAX_SIZE, LEVEL_DEFAULT_HEIGHT)
+
+#define LEVEL_PLAYER_FIELDS(LEVEL_FIELD)			\
+    LEVEL_FIELD(INT, x, "x", 0, LEVEL_MAX_SIZE - 1, 0)		\
+    LEVEL_FIELD(INT, y, "y", 0, LEVEL_MAX_SIZE - 1, 0)
+
+#define LEVEL_NO_FIELDS(LEVEL_FIELD)
+
+// la racine est le premier élément, les autres sont ses enfants directs
+#define LIST_OF_LEVEL_ELEMENTS					\
+    LEVEL_ELEMENT(ROOT, root, "root", LEVEL_ROOT_FIELDS)	\
+    LEVEL_ELEMENT(CSV, csv, "csv", LEVEL_NO_FIELDS)		\
+    LEVEL_ELEMENT(PLAYER, player, "player", LEVEL_PLAYER_FIELDS) \
+    LEVEL_ELEMENT(META, meta, "meta", LEVEL_NO_FIELDS)
+
+/**
+ * @enum LevelFormat
+ * @brief Format d'un fichier de niveau, déduit de son extension.
+ */
+typedef enum {
+    LEVEL_FORMAT_UNKNOWN, /**< Extension inconnue. */
+    LEVEL_FORMAT_XML,     /**< Niveau XML (.xml) avec un noeud csv. */
+    LEVEL_FORMAT_BIN,     /**< Niveau binaire (.lvl), projetable en mémoire. */
+} LevelFormat;
+
+/**
+ * @enum LevelEntityType
+ * @brief Type d'une entité placée dans un niveau.
+ */
+typedef enum {
+    LEVEL_ENTITY_PLAYER, /**< Joueur (noeud player en XML). */
+} LevelEntityType;
+
+/**
+ * @struct LevelEntity
+ * @brief Entité d'un niveau, telle qu'elle est stockée dans la table du format binaire.
+ */
+typedef struct {
+    int32_t type; /**< Type de l'entité (LevelEntityType). */
+    int32_t x;    /**< Colonne de la tuile de départ. */
+    int32_t y;    /**< Ligne de la tuile de départ. */
+} LevelEntity;
+
+/**
+ * @struct LevelHeader
+ * @brief En-tête d'un niveau binaire (petit-boutiste, 48 octets).
+ *
+ * Le fichier contient ensuite le plan de tuiles (int32, ligne par ligne), la
+ * table des entités puis le bloc de métadonnées, aux positions indiquées. Le
+ * plan de tuiles est aligné sur 16 octets pour être utilisé sur place une fois
+ * le fichier projeté en mémoire.
+ */
+typedef struct {
+    char magic[4];            /**< LEVEL_MAGIC. */
+    uint32_t version;         /**< LEVEL_VERSION. */
+    uint32_t width;           /**< Largeur en tuiles. */
+    uint32_t height;          /**< Hauteur en tuiles. */
+    uint32_t entity_count;    /**< Nombre d'entrées de la table des entités. */
+    uint32_t metadata_size;   /**< Taille du bloc de métadonnées (0 s'il est absent). */
+    uint32_t tiles_offset;    /**< Position du plan de tuiles. */
+    uint32_t entities_offset; /**< Position de la table des entités. */
+    uint32_t metadata_offset; /**< Position du bloc de métadonnées. */
+    uint32_t reserved[3];     /**< Réservé, à zéro. */
+} LevelHeader;
+
+/**
+ * @struct Level
+ * @brief Niveau chargé en mémoire, indépendant de raylib et du format du fichier.
+ *
+ * Un niveau binaire chargé par level_load_bin pointe directement dans le fichier
+ * projeté (copie privée : les modifications ne sont pas écrites sur le disque).
+ * Sinon, `tiles` et `entities` sont des tableaux dynamiques de array.h.
+ */
+typedef struct {
+    int width;             /**< Largeur en tuiles. */
+    int height;            /**< Hauteur en tuiles. */
+    int32_t *tiles;        /**< Plan de tuiles, ligne par ligne (width * height). */
+    LevelEntity *entities; /**< Entités du niveau. */
+    size_t entity_count;   /**< Nombre d'entités. */
+    char *metadata;        /**< Métadonnées libres (texte), ou NULL. */
+    size_t metadata_size;  /**< Taille des métadonnées en octets. */
+    void *mapping;         /**< Fichier projeté en mémoire, ou NULL si le niveau possède ses tableaux. */
+    size_t mapping_size;   /**< Taille de la projection. */
+} Level;
+
+/**
+ * @def LEVEL_CSV_MAX_DIGITS
+ * @brief Nombre maximal de chiffres d'une tuile dans le texte CSV (la valeur tient dans un int32).
+ */
+#define LEVEL_CSV_MAX_DIGITS 9
+
+/**
+ * @struct LevelCsv
+ * @brief Décodeur en flux du texte CSV des tuiles, qui lit huit octets à la fois.
+ *
+ * Le texte est une suite d'entiers positifs séparés par des virgules ; les blancs
+ * (espaces, tabulations, retours à la ligne) sont ignorés entre les valeurs. Le
+ * texte peut être fourni en plusieurs morceaux, une valeur pouvant être coupée.
+ */
+typedef struct {
+    int32_t *tiles;    /**< Tuiles à remplir. */
+    size_t capacity;   /**< Nombre de tuiles attendues. */
+    size_t count;      /**< Nombre de tuiles décodées. */
+    size_t offset;     /**< Octets lus depuis le début du texte (position des erreurs). */
+    int32_t value;     /**< Valeur en cours de lecture. */
+    int digits;        /**< Nombre de chiffres de `value` déjà lus. */
+    bool field;        /**< Une valeur a été lue depuis la dernière virgule. */
+    const char *error; /**< Description de la première erreur, ou NULL. */
+} LevelCsv;
+
+/**
+ * @brief Initialise un décodeur CSV qui écrit dans `tiles`.
+ *
+ * @param csv Décodeur à initialiser.
+ * @param tiles Tuiles à remplir.
+ * @param capacity Nombre de tuiles attendues.
+ */
+void level_csv_init(LevelCsv *csv, int32_t *tiles, size_t capacity);
+
+/**
+ * @brief Décode un morceau du texte CSV.
+ *
+ * @param csv Décodeur.
+ * @param data Octets du morceau.
+ * @param size Nombre d'octets.
+ * @return `false` dès qu'une erreur est rencontrée (voir `csv->error` et `csv->offset`).
+ */
+bool level_csv_feed(LevelCsv *csv, const char *data, size_t size);
+
+/**
+ * @brief Termine le décodage et vérifie que toutes les tuiles ont été lues.
+ *
+ * @param csv Décodeur.
+ * @return `false` si le texte est invalide ou ne contient pas exactement `capacity` tuiles.
+ */
+bool level_csv_finish(LevelCsv *csv);
+
+/**
+ * @brief Initialise un niveau vide (tuiles à 0, aucune entité).
+ *
+ * @param level Niveau à initialiser.
+ * @param width Largeur en tuiles.
+ * @param height Hauteur en tuiles.
+ */
+void level_init(Level *level, int width, int height);
+
+/**
+ * @brief Ajoute une entité à un niveau initialisé par level_init ou chargé depuis du XML.
+ *
+ * @param level Niveau.
+ * @param entity Entité à ajouter.
+ */
+void level_add_entity(Level *level, LevelEntity entity);
+
+/**
+ * @brief Remplace les métadonnées d'un niveau qui possède ses tableaux.
+ *
+ * @param level Niveau.
+ * @param metadata Texte copié dans le niveau, ou NULL pour les retirer.
+ */
+void level_set_metadata(Level *level, const char *metadata);
+
+/**
+ * @brief Déduit le format d'un fichier de niveau de son extension.
+ *
+ * @param file_path Chemin du fichier.
+ * @return Le format, ou LEVEL_FORMAT_UNKNOWN.
+ */
+LevelFormat level_format(const char *file_path);
+
+/**
+ * @brief Charge un niveau XML en une passe avec l'analyseur en flux.
+ *
+ * Le document est vérifié avec le schéma LIST_OF_LEVEL_ELEMENTS : élément ou
+ * attribut inconnu, attribut en double, valeur hors de ses bornes ou joueur hors
+ * du plan sont refusés avec la ligne et la colonne de l'erreur. Les attributs
+ * optionnels `width` et `height` de la racine donnent les dimensions, sinon
+ * LEVEL_DEFAULT_WIDTH x LEVEL_DEFAULT_HEIGHT.
+ *
+ * @param level Niveau à remplir.
+ * @param file_path Chemin du fichier XML.
+ * @return `true` si le chargement est réussi, sinon `false` (le niveau est alors libéré).
+ */
+bool level_load_xml(Level *level, const char *file_path);
+
+/**
+ * @brief Projette un niveau binaire en mémoire et vérifie son en-tête.
+ *
+ * @param level Niveau à remplir.
+ * @param file_path Chemin du fichier binaire.
+ * @return `true` si le chargement est réussi, sinon `false`.
+ */
+bool level_load_bin(Level *level, const char *file_path);
+
+/**
+ * @brief Charge un niveau avec le chargeur correspondant à son extension.
+ *
+ * @param level Niveau à remplir.
+ * @param file_path Chemin du fichier.
+ * @return `true` si le chargement est réussi, sinon `false`.
+ */
+bool level_load(Level *level, const char *file_path);
+
+/**
+ * @brief Écrit un niveau au format XML.
+ *
+ * @param level Niveau à écrire.
+ * @param file_path Chemin du fichier XML.
+ * @return `true` si l'écriture est réussie, sinon `false`.
+ */
+bool level_save_xml(const Level *level, const char *file_path);
+
+/**
+ * @brief Écrit un niveau au format binaire.
+ *
+ * @param level Niveau à écrire.
+ * @param file_path Chemin du fichier binaire.
+ * @return `true` si l'écriture est réussie, sinon `false`.
+ */
+bool level_save_bin(const Level *level, const char *file_path);
+
+/**
+ * @brief Écrit un niveau au format correspondant à l'extension du fichier.
+ *
+ * @param level Niveau à écrire.
+ * @param file_path Chemin du fichier.
+ * @return `true` si l'écriture est réussie, sinon `false`.
+ */
+bool level_save(const Level *level, const char *file_path);
+
+/**
+ * @brief Libère un niveau (tableaux ou projection du fichier).
+ *
+ * @param level Niveau à libérer.
+ */
+void level_free(Level *level);
+
+/**
+ * @brief Obtient les chemins des niveaux (.xml et .lvl) d'un répertoire, qui est créé s'il n'existe pas.
+ *
+ * @param path Chemin du répertoire.
+ * @return Tableau dynamique de chaînes allouées avec malloc.
+ */
+char** level_get_filepaths(const char *path);
+
+#endif // LEVEL_H_
@@ -0,0 +1,30 @@
+/* -*- compile-command: "make -C .. levelconv" -*- */
+#include <stdio.h>
+
+#include "level.h"
+
+/**
+ * @brief Convertit un niveau entre les formats XML (.xml) et binaire (.lvl).
+ *
+ * Les formats d'entrée et de sortie sont déduits des extensions.
+ */
+int main(int argc, char **argv) {
+    if (argc != 3) {
+	fprintf(stderr, "usage: %s <input.xml|input.lvl> <output.xml|output.lvl>\n", argv[0]);
+	return 1;
+    }
+
+    Level level;
+    if (!level_load(&level, argv[1])) {
+	fprintf(stderr, "ERROR: Could not load the level %s\n", argv[1]);
+	return 1;
+    }
+
+    bool ok = level_save(&level, argv[2]);
+    if (ok) {
+	printf("%s -> %s: %dx%d tiles, %zu entities, %zu bytes of metadata\n",
+	       argv[1], argv[2], level.width, level.height, level.entity_count, level.metadata_size);
+    }
+    level_free(&level);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,131 @@
+/* -*- compile-command: "make -C .. libplug" -*- */
+#include "library.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "array.h"
+
+size_t library_default_threads(void) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cores < 1) return 1;
+    return cores > LIBRARY_MAX_THREADS ? LIBRARY_MAX_THREADS : (size_t)cores;
+}
+
+static LibraryResult library_load(Library *library, size_t index) {
+    LibraryResult result = {
+	.index = index,
+	.path = library->paths[index],
+    };
+    result.ok = level_load(&result.level, result.path);
+    return result;
+}
+
+static void *library_thread(void *arg) {
+    Library *library = arg;
+
+    pthread_mutex_lock(&library->mutex);
+    for (;;) {
+	while (!library->stopping && library->next < library->count) {
+	    if (library->in_flight >= library->capacity) library->throttled = true;
+	    if (!library->throttled) break;
+	    pthread_cond_wait(&library->work, &library->mutex);
+	}
+	if (library->stopping || library->next >= library->count) break;
+
+	size_t index = library->next++;
+	library->in_flight += 1;
+
+	// La lecture et l'analyse se font sans tenir le verrou.
+	pthread_mutex_unlock(&library->mutex);
+	LibraryResult result = library_load(library, index);
+	pthread_mutex_lock(&library->mutex);
+
+	// library_next n'attend que si la file est vide
+	if (deque_size(library->done) == 0) pthread_cond_signal(&library->ready);
+	deque_push_back(library->done, result);
+    }
+    pthread_mutex_unlock(&library->mutex);
+
+    return NULL;
+}
+
+void library_open(Library *library, const char *const *paths, size_t count, size_t threads, size_t capacity) {
+    memset(library, 0, sizeof(*library));
+    if (threads == 0) threads = library_default_threads();
+    if (threads > count) threads = count;
+    if (capacity == 0) capacity = LIBRARY_SLOTS_PER_THREAD * (threads ? threads : 1);
+
+    library->paths = malloc(count * sizeof(char*));
+    for (size_t i = 0; i < count; i++) library->paths[i] = strdup(paths[i]);
+    library->count = count;
+    library->capacity = capacity;
+    library->done = deque_create_init(capacity, sizeof(LibraryResult));
+    pthread_mutex_init(&library->mutex, NULL);
+    pthread_cond_init(&library->work, NULL);
+    pthread_cond_init(&library->ready, NULL);
+
+    library->threads = malloc((threads ? threads : 1) * sizeof(pthread_t));
+    for (size_t i = 0; i < threads; i++) {
+	if (pthread_create(&library->threads[library->thread_count], NULL, library_thread, library) != 0) {
+	    fprintf(stderr, "ERROR: Could not create level loading thread %zu of %zu\n", i + 1, threads);
+	    break;
+	}
+	library->thread_count++;
+    }
+}
+
+bool library_next(Library *library, LibraryResult *result) {
+    pthread_mutex_lock(&library->mutex);
+    if (library->delivered >= library->count) {
+	pthread_mutex_unlock(&library->mutex);
+	return false;
+    }
+
+    if (library->thread_count == 0) {
+	// Sans thread, les niveaux sont chargés ici, dans l'ordre de la liste.
+	size_t index = library->next++;
+	library->delivered += 1;
+	pthread_mutex_unlock(&library->mutex);
+	*result = library_load(library, index);
+	return true;
+    }
+
+    while (deque_size(library->done) == 0) {
+	pthread_cond_wait(&library->ready, &library->mutex);
+    }
+    *result = deque_front(library->done);
+    deque_pop_front(library->done);
+    library->in_flight -= 1;
+    library->delivered += 1;
+    // les threads bloqués repartent quand la moitié des places est libre
+    if (library->throttled && library->in_flight <= library->capacity / 2) {
+	library->throttled = false;
+	pthread_cond_broadcast(&library->work);
+    }
+    pthread_mutex_unlock(&library->mutex);
+    return true;
+}
+
+void library_close(Library *library) {
+    pthread_mutex_lock(&library->mutex);
+    library->stopping = true;
+    pthread_cond_broadcast(&library->work);
+    pthread_mutex_unlock(&library->mutex);
+
+    for (size_t i = 0; i < library->thread_count; i++) {
+	pthread_join(library->threads[i], NULL);
+    }
+
+    for (size_t i = 0; i < deque_size(library->done); i++) {
+	if (deque_at(library->done, i).ok) level_free(&deque_at(library->done, i).level);
+    }
+    for (size_t i = 0; i < library->count; i++) free(library->paths[i]);
+    free(library->paths);
+    free(library->threads);
+    deque_free(library->done);
+    pthread_mutex_destroy(&library->mutex);
+    pthread_cond_destroy(&library->work);
+    pthread_cond_destroy(&library->ready);
+}
@@ -0,0 +1,96 @@
+#ifndef LIBRARY_H_
+#define LIBRARY_H_
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "level.h"
+
+/**
+ * @def LIBRARY_MAX_THREADS
+ * @brief Nombre maximal de threads de chargement, quel que soit le nombre de cœurs.
+ */
+#define LIBRARY_MAX_THREADS 64
+
+/**
+ * @def LIBRARY_SLOTS_PER_THREAD
+ * @brief Niveaux chargés et pas encore lus, par thread, quand library_open ne reçoit pas de limite.
+ */
+#define LIBRARY_SLOTS_PER_THREAD 8
+
+/**
+ * @struct LibraryResult
+ * @brief Niveau chargé, rendu par library_next dans l'ordre où les chargements se terminent.
+ */
+typedef struct {
+    size_t index;     /**< Position du niveau dans la liste donnée à library_open. */
+    const char *path; /**< Chemin du niveau, valide jusqu'à library_close. */
+    Level level;      /**< Niveau chargé, à libérer avec level_free si `ok`. */
+    bool ok;          /**< Le chargement a réussi. */
+} LibraryResult;
+
+/**
+ * @struct Library
+ * @brief Chargement de toute une liste de niveaux par un groupe de threads.
+ *
+ * Chaque thread prend le prochain chemin de la liste, charge le niveau avec
+ * level_load et le range dans la file `done`. Au plus `capacity` niveaux sont
+ * chargés ou en attente d'être lus : quand toutes les places sont prises, les
+ * threads attendent que library_next en ait libéré la moitié, pour ne pas être
+ * réveillés à chaque niveau lu. Les champs à partir de `next` sont protégés par
+ * `mutex`.
+ */
+typedef struct {
+    char **paths;            /**< Copie des chemins à charger. */
+    size_t count;            /**< Nombre de chemins. */
+    size_t capacity;         /**< Nombre maximal de niveaux en cours ou en attente. */
+    pthread_t *threads;      /**< Threads de chargement. */
+    size_t thread_count;     /**< Nombre de threads lancés (0 : chargement dans library_next). */
+    pthread_mutex_t mutex;   /**< Protège les champs suivants. */
+    pthread_cond_t work;     /**< Signale une place libre ou l'arrêt aux threads. */
+    pthread_cond_t ready;    /**< Signale un niveau chargé à library_next. */
+    size_t next;             /**< Prochain chemin à prendre. */
+    size_t in_flight;        /**< Niveaux pris par un thread et pas encore rendus. */
+    size_t delivered;        /**< Niveaux rendus par library_next. */
+    LibraryResult *done;     /**< Niveaux chargés, dans l'ordre de fin de chargement (Deque). */
+    bool throttled;          /**< Les threads attendent que la moitié des places soit libre. */
+    bool stopping;           /**< Les threads doivent s'arrêter. */
+} Library;
+
+/**
+ * @brief Donne le nombre de threads de chargement par défaut : un par cœur.
+ *
+ * @return Le nombre de cœurs disponibles, entre 1 et LIBRARY_MAX_THREADS.
+ */
+size_t library_default_threads(void);
+
+/**
+ * @brief Lance le chargement d'une liste de niveaux.
+ *
+ * @param library Chargement à initialiser.
+ * @param paths Chemins des niveaux (copiés), par exemple donnés par xml_get_filepaths.
+ * @param count Nombre de chemins.
+ * @param threads Nombre de threads, 0 pour library_default_threads.
+ * @param capacity Nombre maximal de niveaux chargés et pas encore lus, 0 pour LIBRARY_SLOTS_PER_THREAD par thread.
+ */
+void library_open(Library *library, const char *const *paths, size_t count, size_t threads, size_t capacity);
+
+/**
+ * @brief Attend le prochain niveau chargé.
+ *
+ * @param library Chargement.
+ * @param result Niveau chargé ; son niveau appartient ensuite à l'appelant.
+ * @return `false` une fois tous les niveaux rendus.
+ */
+bool library_next(Library *library, LibraryResult *result);
+
+/**
+ * @brief Arrête les threads, libère les niveaux pas encore lus et les chemins.
+ *
+ * Peut être appelée avant que tous les niveaux soient rendus.
+ *
+ * @param library Chargement.
+ */
+void library_close(Library *library);
+
+#endif // LIBRARY_H_
@@ -0,0 +1,224 @@
+/* -*- compile-command: "make -C .. libplug" -*- */
+#include "loader.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "array.h"
+
+#define FNV_OFFSET 14695981039346656037ull
+#define FNV_PRIME 1099511628211ull
+
+static void *loader_thread(void *arg) {
+    Loader *loader = arg;
+
+    pthread_mutex_lock(&loader->mutex);
+    for (;;) {
+	while (array_size(loader->wanted) == 0 && !loader->stopping) {
+	    pthread_cond_wait(&loader->cond, &loader->mutex);
+	}
+	if (loader->stopping) break;
+
+	LoaderRequest request = loader->wanted[0];
+	array_pop_front(loader->wanted);
+	loader->loading = request.path;
+
+	// Le fichier est lu et analysé sans tenir le verrou.
+	pthread_mutex_unlock(&loader->mutex);
+	LoaderSlot slot = {.path = request.path, .mtime = request.mtime};
+	slot.ok = level_load(&slot.level, request.path);
+	pthread_mutex_lock(&loader->mutex);
+
+	loader->loading = NULL;
+	array_push(loader->ready, slot);
+	loader->prefetched += 1;
+	// loader_get peut attendre ce niveau
+	pthread_cond_broadcast(&loader->cond);
+    }
+    pthread_mutex_unlock(&loader->mutex);
+
+    return NULL;
+}
+
+void loader_init(Loader *loader) {
+    memset(loader, 0, sizeof(*loader));
+    pthread_mutex_init(&loader->mutex, NULL);
+    pthread_cond_init(&loader->cond, NULL);
+    loader->wanted = array_create_init(16, sizeof(LoaderRequest));
+    loader->ready = array_create_init(16, sizeof(LoaderSlot));
+    loader->cache = map_create_init(LOADER_CACHE_CAPACITY, sizeof(LoaderSlot), MAP_KEY_STRING);
+}
+
+static void loader_slot_free(LoaderSlot *slot) {
+    if (slot->ok) level_free(&slot->level);
+    free(slot->path);
+}
+
+/**
+ * @brief Cherche un niveau dans le cache et le marque comme le plus récemment utilisé.
+ *
+ * @return L'entrée du cache, ou NULL si le niveau n'y est pas avec cette date de modification.
+ */
+static LoaderSlot *loader_cache_touch(Loader *loader, const char *path, int64_t mtime) {
+    LoaderSlot *slot = map_get(loader->cache, path);
+    if (!slot || slot->mtime != mtime) return NULL;
+    slot->used = ++loader->clock;
+    return slot;
+}
+
+/**
+ * @brief Retire un niveau du cache et le libère.
+ */
+static void loader_cache_remove(Loader *loader, const LoaderSlot *slot) {
+    // map_remove déplace la dernière entrée à la place de celle retirée
+    LoaderSlot removed = *slot;
+    map_remove(loader->cache, removed.path);
+    loader_slot_free(&removed);
+}
+
+/**
+ * @brief Range un niveau chargé dans le cache, en retirant le moins récemment utilisé si le cache est plein.
+ */
+static void loader_cache_insert(Loader *loader, LoaderSlot slot) {
+    LoaderSlot *cached = map_get(loader->cache, slot.path);
+    if (cached) loader_cache_remove(loader, cached);
+    // Un niveau qui ne se charge pas sera de nouveau essayé (et signalé) par loader_get.
+    if (!slot.ok) {
+	loader_slot_free(&slot);
+	return;
+    }
+    if (map_size(loader->cache) >= LOADER_CACHE_CAPACITY) {
+	size_t oldest = 0;
+	for (size_t i = 1; i < map_size(loader->cache); i++) {
+	    if (loader->cache[i].used < loader->cache[oldest].used) oldest = i;
+	}
+	loader_cache_remove(loader, &loader->cache[oldest]);
+    }
+    slot.used = ++loader->clock;
+    map_put(loader->cache, slot);
+}
+
+/**
+ * @brief Range dans le cache les niveaux chargés par le thread.
+ */
+static void loader_collect(Loader *loader) {
+    pthread_mutex_lock(&loader->mutex);
+    for (size_t i = 0; i < array_size(loader->ready); i++) {
+	loader_cache_insert(loader, loader->ready[i]);
+    }
+    array_clear(loader->ready);
+    pthread_mutex_unlock(&loader->mutex);
+}
+
+static void loader_clear_wanted(Loader *loader) {
+    for (size_t i = 0; i < array_size(loader->wanted); i++) {
+	free(loader->wanted[i].path);
+    }
+    array_clear(loader->wanted);
+}
+
+void loader_prefetch(Loader *loader, const char *const *paths, const int64_t *mtimes, size_t count) {
+    loader_collect(loader);
+
+    // La sélection de niveau redemande les mêmes pages à chaque frame.
+    uint64_t hash = FNV_OFFSET;
+    for (size_t i = 0; i < count; i++) {
+	for (const char *c = paths[i]; *c; c++) hash = (hash ^ (unsigned char)*c) * FNV_PRIME;
+	hash = (hash ^ (uint64_t)mtimes[i]) * FNV_PRIME;
+    }
+    if (hash == loader->request_hash) return;
+    loader->request_hash = hash;
+
+    pthread_mutex_lock(&loader->mutex);
+    loader_clear_wanted(loader);
+    for (size_t i = 0; i < count; i++) {
+	if (loader_cache_touch(loader, paths[i], mtimes[i])) continue;
+	if (loader->loading && strcmp(loader->loading, paths[i]) == 0) continue;
+	bool ready = false;
+	for (size_t j = 0; j < array_size(loader->ready) && !ready; j++) {
+	    ready = strcmp(loader->ready[j].path, paths[i]) == 0 && loader->ready[j].mtime == mtimes[i];
+	}
+	if (ready) continue;
+
+	LoaderRequest request = {
+	    .path = strdup(paths[i]),
+	    .mtime = mtimes[i],
+	};
+	array_push(loader->wanted, request);
+    }
+
+    if (array_size(loader->wanted) && !loader->running) {
+	loader->stopping = false;
+	if (pthread_create(&loader->thread, NULL, loader_thread, loader) == 0) {
+	    loader->running = true;
+	} else {
+	    // Sans thread, les niveaux sont chargés au clic par loader_get.
+	    fprintf(stderr, "ERROR: Could not create the level prefetch thread\n");
+	    loader_clear_wanted(loader);
+	}
+    }
+    pthread_cond_broadcast(&loader->cond);
+    pthread_mutex_unlock(&loader->mutex);
+}
+
+const Level *loader_get(Loader *loader, const char *path, int64_t mtime, bool *hit) {
+    // Un niveau en attente n'est plus à précharger ; un niveau en cours de chargement est attendu.
+    pthread_mutex_lock(&loader->mutex);
+    for (size_t i = 0; i < array_size(loader->wanted); i++) {
+	if (strcmp(loader->wanted[i].path, path) == 0) {
+	    free(loader->wanted[i].path);
+	    array_pop_at(loader->wanted, i);
+	    break;
+	}
+    }
+    while (loader->loading && strcmp(loader->loading, path) == 0) {
+	pthread_cond_wait(&loader->cond, &loader->mutex);
+    }
+    pthread_mutex_unlock(&loader->mutex);
+    loader_collect(loader);
+
+    LoaderSlot *cached = loader_cache_touch(loader, path, mtime);
+    if (cached) {
+	loader->hits += 1;
+	if (hit) *hit = true;
+	return &cached->level;
+    }
+
+    loader->misses += 1;
+    if (hit) *hit = false;
+    LoaderSlot slot = {.path = strdup(path), .mtime = mtime};
+    slot.ok = level_load(&slot.level, path);
+    if (!slot.ok) {
+	loader_slot_free(&slot);
+	return NULL;
+    }
+    loader_cache_insert(loader, slot);
+    return &((LoaderSlot *)map_get(loader->cache, path))->level;
+}
+
+void loader_stop(Loader *loader) {
+    pthread_mutex_lock(&loader->mutex);
+    bool running = loader->running;
+    loader->stopping = true;
+    loader_clear_wanted(loader);
+    loader->request_hash = 0;
+    pthread_cond_broadcast(&loader->cond);
+    pthread_mutex_unlock(&loader->mutex);
+
+    if (!running) return;
+    pthread_join(loader->thread, NULL);
+    loader->running = false;
+}
+
+void loader_free(Loader *loader) {
+    loader_stop(loader);
+    loader_collect(loader);
+    for (size_t i = 0; i < map_size(loader->cache); i++) {
+	loader_slot_free(&loader->cache[i]);
+    }
+    array_free(loader->wanted);
+    array_free(loader->ready);
+    map_free(loader->cache);
+    pthread_mutex_destroy(&loader->mutex);
+    pthread_cond_destroy(&loader->cond);
+}
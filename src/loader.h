@@ -0,0 +1,113 @@
+#ifndef LOADER_H_
+#define LOADER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "level.h"
+
+/**
+ * @def LOADER_CACHE_CAPACITY
+ * @brief Nombre maximal de niveaux chargés gardés en cache (trois pages de la sélection de niveau).
+ */
+#define LOADER_CACHE_CAPACITY 27
+
+/**
+ * @struct LoaderRequest
+ * @brief Niveau à précharger.
+ */
+typedef struct {
+    char *path;    /**< Chemin du niveau (alloué avec malloc). */
+    int64_t mtime; /**< Date de modification attendue (voir CatalogEntry). */
+} LoaderRequest;
+
+/**
+ * @struct LoaderSlot
+ * @brief Niveau chargé par le thread de préchargement.
+ */
+typedef struct {
+    char *path;    /**< Chemin du niveau (alloué avec malloc). */
+    int64_t mtime; /**< Date de modification du fichier au moment de la demande. */
+    Level level;   /**< Niveau chargé. */
+    bool ok;       /**< Le chargement a réussi. */
+    size_t used;   /**< Date du dernier usage dans le cache (voir Loader.clock). */
+} LoaderSlot;
+
+/**
+ * @struct Loader
+ * @brief Thread de préchargement des niveaux et cache LRU des niveaux chargés.
+ *
+ * Le thread charge les niveaux demandés par loader_prefetch dans `ready`. Le cache
+ * est une table indexée par chemin, manipulée seulement par le thread principal,
+ * qui y range les niveaux prêts : un niveau obtenu par loader_get reste valide
+ * jusqu'au prochain appel au Loader. Quand le cache est plein, le niveau dont le
+ * dernier usage est le plus ancien est retiré.
+ * Les champs `wanted`, `ready`, `loading`, `running` et `stopping` sont protégés
+ * par `mutex`.
+ */
+typedef struct {
+    pthread_t thread;       /**< Thread de préchargement. */
+    pthread_mutex_t mutex;  /**< Protège les files partagées avec le thread. */
+    pthread_cond_t cond;    /**< Signale une nouvelle demande ou l'arrêt. */
+    bool running;           /**< Le thread a été lancé et n'a pas été attendu. */
+    bool stopping;          /**< Le thread doit s'arrêter. */
+    LoaderRequest *wanted;  /**< Niveaux à charger, par priorité décroissante. */
+    LoaderSlot *ready;      /**< Niveaux chargés, pas encore rangés dans le cache. */
+    char *loading;          /**< Chemin du niveau en cours de chargement, ou NULL. */
+    LoaderSlot *cache;      /**< Cache, table indexée par chemin (thread principal). */
+    size_t clock;           /**< Compteur des usages du cache. */
+    uint64_t request_hash;  /**< Empreinte de la dernière demande, pour ignorer les demandes identiques. */
+    size_t hits;            /**< Niveaux obtenus depuis le cache. */
+    size_t misses;          /**< Niveaux chargés sur le thread principal. */
+    size_t prefetched;      /**< Niveaux chargés par le thread. */
+} Loader;
+
+/**
+ * @brief Initialise le préchargement (le thread n'est pas lancé).
+ *
+ * @param loader Préchargement.
+ */
+void loader_init(Loader *loader);
+
+/**
+ * @brief Remplace la liste des niveaux à précharger.
+ *
+ * Les niveaux déjà en cache avec la même date de modification ne sont pas rechargés.
+ * Le thread est lancé s'il y a des niveaux à charger.
+ *
+ * @param loader Préchargement.
+ * @param paths Chemins des niveaux, du plus au moins prioritaire.
+ * @param mtimes Date de modification de chaque niveau.
+ * @param count Nombre de niveaux.
+ */
+void loader_prefetch(Loader *loader, const char *const *paths, const int64_t *mtimes, size_t count);
+
+/**
+ * @brief Obtient un niveau chargé, depuis le cache ou en le chargeant immédiatement.
+ *
+ * @param loader Préchargement.
+ * @param path Chemin du niveau.
+ * @param mtime Date de modification attendue ; un niveau en cache plus ancien est rechargé.
+ * @param hit Mis à `true` si le niveau venait du cache (peut être NULL).
+ * @return Le niveau, valide jusqu'au prochain appel au Loader, ou NULL s'il ne se charge pas.
+ */
+const Level *loader_get(Loader *loader, const char *path, int64_t mtime, bool *hit);
+
+/**
+ * @brief Arrête le thread de préchargement (les demandes en attente sont abandonnées).
+ *
+ * Le cache est gardé ; la prochaine demande relance le thread.
+ *
+ * @param loader Préchargement.
+ */
+void loader_stop(Loader *loader);
+
+/**
+ * @brief Arrête le thread et libère le cache.
+ *
+ * @param loader Préchargement.
+ */
+void loader_free(Loader *loader);
+
+#endif // LOADER_H_
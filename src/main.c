@@ -90,7 +90,10 @@ int main(void) {
 	if (IsKeyPressed(KEY_Z)) plug.camera.zoom = 1.0f;
 
 	if (IsKeyPressed(KEY_R) && plug.dialog == DIALOG_NONE) {
+	    // Le thread de simulation exécute du code de libplug : il est arrêté pendant le rechargement.
+	    plug_pre_reload(&plug);
 	    if (!reload_libplug()) return 1;
+	    plug_post_reload(&plug);
 	}
 
 	plug_render(&plug, background, tileset, player, player_flop);
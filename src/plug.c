@@ -12,6 +12,11 @@
 
 #include "layout.h"
 #include "array.h"
+#include "level.h"
+
+// les niveaux sans dimensions explicites ont la taille de la carte du jeu
+_Static_assert(TILESX == LEVEL_DEFAULT_WIDTH && TILESY == LEVEL_DEFAULT_HEIGHT, "LEVEL_DEFAULT_* must match TILESX/TILESY");
+_Static_assert(BLOCK_COIN == LEVEL_TILE_COIN, "LEVEL_TILE_COIN must match BLOCK_COIN");
 
 // liste des coordonnés des textures dans un spritesheet
 #define TEXTURE_GRASS (Rectangle){0, 0, 36, 36}
@@ -25,11 +30,83 @@
 #define TEXTURE_PLAYER (Rectangle){0, 0, 48, 48}
 #define TEXTURE_PLAYER_FLOP (Rectangle){384, 0, 48, 48}
 
-static void reset_paths(Plug *plug) {
-    for (size_t i = 0; i < array_size(plug->paths); i++) {
-	free(plug->paths[i]);
+// durée d'affichage du message de fin de sauvegarde, en secondes
+#define SAVE_MESSAGE_DURATION 3.0
+
+/**
+ * @brief Récupère les sauvegardes terminées par le thread d'écriture.
+ *
+ * L'entrée du fichier dans l'index des niveaux est mise à jour sans relire le
+ * répertoire, et le résultat est affiché pendant SAVE_MESSAGE_DURATION secondes.
+ *
+ * @param plug Un pointeur vers l'état du jeu (structure Plug).
+ */
+static void poll_saves(Plug *plug) {
+    SaveResult result;
+    while (saver_poll(&plug->saver, &result)) {
+	if (result.ok) {
+	    catalog_refresh(&plug->catalog, result.file_path);
+	    snprintf(plug->save_message, sizeof(plug->save_message), "saved %s (%.1f ms)", result.file_path, result.seconds * 1e3);
+	} else {
+	    snprintf(plug->save_message, sizeof(plug->save_message), "could not save %s", result.file_path);
+	}
+	printf("%s\n", plug->save_message);
+	plug->save_message_time = GetTime();
+	free(result.file_path);
+    }
+}
+
+/**
+ * @struct TileRange
+ * @brief Intervalle de tuiles [x0, x1[ x [y0, y1[ visible à l'écran.
+ */
+typedef struct {
+    int x0;
+    int y0;
+    int x1;
+    int y1;
+} TileRange;
+
+/**
+ * @brief Calcule l'intervalle de tuiles couvert par la vue de la caméra.
+ *
+ * L'intervalle est borné à la carte de tuiles. Une rangée supplémentaire est
+ * gardée en bas car la porte déborde de 18 pixels au-dessus de sa tuile.
+ *
+ * @param view Rectangle visible en coordonnées du monde (voir render_view_bounds).
+ * @return L'intervalle de tuiles à dessiner.
+ */
+static TileRange visible_tiles(Rectangle view) {
+    TileRange range = {
+	.x0 = floorf(view.x / MAP_TILE_SIZE),
+	.y0 = floorf(view.y / MAP_TILE_SIZE),
+	.x1 = ceilf((view.x + view.width) / MAP_TILE_SIZE),
+	.y1 = ceilf((view.y + view.height) / MAP_TILE_SIZE) + 1,
+    };
+    range.x0 = Clamp(range.x0, 0, TILESX);
+    range.y0 = Clamp(range.y0, 0, TILESY);
+    range.x1 = Clamp(range.x1, range.x0, TILESX);
+    range.y1 = Clamp(range.y1, range.y0, TILESY);
+    return range;
+}
+
+/**
+ * @brief Comptabilise les tuiles non vides hors de l'intervalle visible comme écartées.
+ *
+ * Les cases vides ne sont pas comptées : elles n'auraient produit aucun sprite.
+ *
+ * @param rb Le tampon de commandes de rendu.
+ * @param tiles Les tuiles de la carte (TILESX * TILESY, ligne par ligne).
+ * @param range L'intervalle de tuiles visible.
+ */
+static void count_culled_tiles(RenderBuffer *rb, const int *tiles, TileRange range) {
+    for (int y = 0; y < TILESY; y++) {
+	bool row_visible = y >= range.y0 && y < range.y1;
+	for (int x = 0; x < TILESX; x++) {
+	    if (row_visible && x >= range.x0 && x < range.x1) continue;
+	    if (tiles[y * TILESX + x]) rb->stats.culled += 1;
+	}
     }
-    array_free(plug->paths);
 }
 
 static Item set_item(Key key, Value val) {
@@ -41,76 +118,86 @@ static Item set_item(Key key, Value val) {
 }
 
 /**
- * @brief Ouvre et initialise un niveau de jeu à partir d'un fichier XML.
+ * @brief Ouvre et initialise un niveau de jeu à partir d'un fichier XML ou binaire.
  *
- * Cette fonction charge les données du niveau à partir d'un fichier XML, 
- * incluant les positions des joueurs, les informations de la carte de tuiles,
- * et d'autres détails spécifiques au jeu.
+ * Le niveau est normalement déjà chargé par le thread de préchargement (voir
+ * prefetch_levels) ; sinon il est chargé immédiatement avec le chargeur choisi
+ * selon l'extension du fichier (voir level_load). Les tuiles sont copiées dans
+ * la carte de tuiles et les joueurs sont créés à partir de la table des entités
+ * du niveau.
  *
  * @param plug Un pointeur vers l'état du jeu (structure Plug).
- * @param file_path Le chemin du fichier XML contenant les données du niveau.
+ * @param file_path Le chemin du fichier contenant les données du niveau.
+ * @return `true` si le niveau est chargé, sinon `false` (la carte reste vide).
  */
-static void open_level(Plug *plug, const char *file_path) {
-    // Initialise une structure de document XML.
-    XMLDocument doc = {0};
-
-    // Tente de charger les données XML à partir du fichier spécifié.
-    if (xml_load(&doc, file_path)) {
-	// Trouve le noeud "csv" dans le document XML.
-    	XMLNode *csv = xml_node_find_tag(doc.root, "csv");
-
-	// Trouve tous les noeuds "player" dans le document XML et initialise les entités des joueurs.
-	Array_XMLNode players = xml_node_find_tags(doc.root, "player");
-	for (size_t i = 0; i < array_size(players); i++) {
-	    char *char_x = xml_attrib_get_value(players[i], "x");
-	    char *char_y = xml_attrib_get_value(players[i], "y");
-	    int x = atoi(char_x);
-	    int y = atoi(char_y);
-
-	    // Initialise les entités des joueurs et les ajoute au tableau de joueurs de plug.
-	    array_push(plug->players, entity_init(MAP_TILE_SIZE * x, MAP_TILE_SIZE * y));
+static bool open_level(Plug *plug, const char *file_path) {
+    // Les tuiles absentes du fichier restent vides.
+    for (size_t y = 0; y < TILESY; y++) {
+	for (size_t x = 0; x < TILESX; x++) {
+	    plug->tilemap[y][x] = BLOCK_EMPTY;
 	}
+    }
 
-	// Initialise la carte de tuiles à partir du noeud "csv" dans le document XML.
-    	int index = 0;
-    	for (size_t y = 0; y < TILESY; y++) {
-    	    for (size_t x = 0; x < TILESX; x++) {
-		// Extrait les valeurs numériques du noeud "csv".
-    		char number[4];
-    		int num_index = 0;
-    		while (isdigit(csv->inner_text[index])) {
-    		    number[num_index++] = csv->inner_text[index++];
-    		}
-		number[num_index] = '\0';
-    		index++;
-
-		// Convertit et attribue la valeur numérique à la carte de tuiles.
-		plug->tilemap[y][x] = atoi(number);
-
-		// Si la tuile est une pièce, incrémenter le compteur max_coins.
-		if (plug->tilemap[y][x] == BLOCK_COIN) {
-		    plug->max_coins += 1;
-		}
-    	    }
-    	}
-	// Definit le nombre de joueur qui doit aller à la sortie du niveau
-	plug->goal = array_size(plug->players);
-
-	// Libère le tableau des nœuds de joueur et le document XML.
-	array_free(players);
-    	xml_doc_free(&doc);
-    } else {
+    // La date de modification de l'index écarte un niveau en cache modifié depuis.
+    const CatalogEntry *entry = catalog_find(&plug->catalog, file_path);
+    const Level *level = loader_get(&plug->loader, file_path, entry ? entry->mtime : 0, &plug->open_prefetched);
+    if (!level) {
 	// Affiche un message d'erreur si le niveau ne peut pas être chargé.
 	fprintf(stderr, "failed to open the level: %s\n", file_path);
+	return false;
+    }
 
-	// Initialise la carte de tuiles à BLOCK_EMPTY en cas d'échec.
-    	for (size_t y = 0; y < TILESY; y++) {
-    	    for (size_t x = 0; x < TILESX; x++) {
-    		plug->tilemap[y][x] = BLOCK_EMPTY;
-    	    }
-    	}
-	plug->state = EDITOR;
+    // Copie la partie du plan de tuiles qui tient dans la carte du jeu.
+    for (int y = 0; y < level->height && y < TILESY; y++) {
+	for (int x = 0; x < level->width && x < TILESX; x++) {
+	    plug->tilemap[y][x] = level->tiles[y * level->width + x];
+
+	    // Si la tuile est une pièce, incrémenter le compteur max_coins.
+	    if (plug->tilemap[y][x] == BLOCK_COIN) {
+		plug->max_coins += 1;
+	    }
+	}
+    }
+
+    // Initialise les entités des joueurs et les ajoute au tableau de joueurs de plug.
+    for (size_t i = 0; i < level->entity_count; i++) {
+	LevelEntity entity = level->entities[i];
+	if (entity.type != LEVEL_ENTITY_PLAYER) continue;
+	entity_map_insert(&plug->players, entity_init(MAP_TILE_SIZE * entity.x, MAP_TILE_SIZE * entity.y));
     }
+
+    // Definit le nombre de joueur qui doit aller à la sortie du niveau
+    plug->goal = entity_map_size(&plug->players);
+    return true;
+}
+
+/**
+ * @brief Demande au thread de préchargement les niveaux de la page courante et de la suivante.
+ *
+ * @param plug Un pointeur vers l'état du jeu (structure Plug).
+ */
+static void prefetch_levels(Plug *plug) {
+    const char *paths[18];
+    int64_t mtimes[18];
+    size_t count = 0;
+    for (size_t i = 9 * plug->page; i < 9 * (plug->page + 2) && i < catalog_count(&plug->catalog); i++) {
+	paths[count] = plug->catalog.entries[i].path;
+	mtimes[count] = plug->catalog.entries[i].mtime;
+	count += 1;
+    }
+    loader_prefetch(&plug->loader, paths, mtimes, count);
+}
+
+/**
+ * @brief Affiche et mémorise le temps écoulé entre le clic sur un niveau et sa première frame jouable.
+ *
+ * @param plug Un pointeur vers l'état du jeu (structure Plug).
+ */
+static void report_open_time(Plug *plug) {
+    if (plug->open_start <= 0) return;
+    plug->open_time = GetTime() - plug->open_start;
+    plug->open_start = 0;
+    printf("level opened in %.2f ms (%s)\n", plug->open_time * 1e3, plug->open_prefetched ? "prefetched" : "loaded on click");
 }
 
 /**
@@ -142,12 +229,32 @@ void plug_init(Plug *plug) {
     plug->state = START_MENU;
     plug->dialog = DIALOG_NONE;
     
+    // Initialise les allocateurs comptés des sous-systèmes (voir draw_memory).
+    static const char *memory_names[MEMORY_COUNT] = {
+	[MEMORY_LAYOUTS] = "layouts",
+	[MEMORY_ENTITIES] = "entities",
+	[MEMORY_XML] = "xml",
+    };
+    for (size_t i = 0; i < MEMORY_COUNT; i++) {
+	plug->memory.allocators[i] = (ArrayAllocator){.name = memory_names[i]};
+	hud_text_init(&plug->memory.texts[i], 10);
+    }
+    plug->memory.show = false;
+    xml_set_allocator(&plug->memory.allocators[MEMORY_XML]);
+
     // Initialise le tableau de joueurs et de mises en page.
-    plug->players = array_create_init(2, sizeof(Entity));
-    plug->layouts = array_create_init(4, sizeof(Layout));
+    entity_map_init(&plug->players, &plug->memory.allocators[MEMORY_ENTITIES]);
+    layout_stack_init(&plug->layouts, &plug->memory.allocators[MEMORY_LAYOUTS]);
 
-    // Initialise les chemins des fichiers XML de niveaux.
-    plug->paths = xml_get_filepaths("levels");
+    // Ouvre l'index des niveaux, tenu à jour par inotify (voir catalog_poll).
+    catalog_open(&plug->catalog, "levels", true);
+    plug->level_path = NULL;
+
+    // Initialise le thread de préchargement des niveaux (lancé par la sélection de niveau).
+    loader_init(&plug->loader);
+    plug->open_start = 0;
+    plug->open_prefetched = false;
+    plug->open_time = 0;
 
     // Initialise la variable indiquant si la fenêtre doit être fermée.
     plug->window_should_close = false;
@@ -161,6 +268,32 @@ void plug_init(Plug *plug) {
 
     // Initialise la page à 0.
     plug->page = 0;
+
+    // Initialise le tampon de commandes de rendu.
+    render_init(&plug->render, RENDER_BACKEND_RAYLIB);
+
+    // Initialise l'accumulateur du pas fixe de la simulation.
+    plug->accumulator = 0.0f;
+    plug->alpha = 0.0f;
+
+    // Initialise le thread de simulation (lancé à l'ouverture d'un niveau).
+    sim_init(&plug->sim);
+
+    // Initialise la police et les textes du HUD.
+    hud_font_init(&plug->hud.font, HUD_SDF);
+    hud_text_init(&plug->hud.eraser, 20);
+    hud_text_init(&plug->hud.bricks, 20);
+    hud_text_init(&plug->hud.exit, 20);
+    hud_text_init(&plug->hud.sprites, 10);
+    hud_text_init(&plug->hud.page, 20);
+    hud_text_init(&plug->hud.save, 20);
+    hud_text_init(&plug->hud.level, 20);
+    hud_text_init(&plug->hud.open, 10);
+
+    // Initialise le thread d'écriture des niveaux (lancé à la première sauvegarde).
+    saver_init(&plug->saver);
+    plug->save_message[0] = '\0';
+    plug->save_message_time = -SAVE_MESSAGE_DURATION;
 }
 
 /**
@@ -173,8 +306,29 @@ void plug_init(Plug *plug) {
  * @param plug Un pointeur vers la structure Plug à mettre à jour.
  */
 void plug_update(Plug *plug) {
-    // Met à jour les entités sauf en cas de dialogue en cours.
-    if (plug->dialog == DIALOG_NONE) entity_update(plug);
+    // Récupère les sauvegardes terminées par le thread d'écriture.
+    poll_saves(plug);
+
+    // Applique les ajouts, modifications et suppressions de niveaux faits hors du jeu.
+    catalog_poll(&plug->catalog);
+
+    // Précharge les niveaux affichés par la sélection de niveau.
+    if (plug->state == START_MENU) prefetch_levels(plug);
+
+    // Affiche/masque la mémoire des sous-systèmes.
+    if (IsKeyPressed(KEY_F3)) plug->memory.show = !plug->memory.show;
+
+    // Met à jour les entités à pas fixe sauf en cas de dialogue en cours
+    // ou si le thread de simulation s'en charge (mode jeu).
+    if (plug->dialog == DIALOG_NONE && !sim_running(&plug->sim)) {
+	plug->accumulator += fminf(GetFrameTime(), SIM_MAX_FRAME_TIME);
+	while (plug->accumulator >= SIM_DT) {
+	    entity_update(plug, SIM_DT);
+	    plug->accumulator -= SIM_DT;
+	}
+	// Fraction du pas suivant déjà écoulée, utilisée pour interpoler le rendu.
+	plug->alpha = plug->accumulator / SIM_DT;
+    }
 
     // Met à jour la position de la souris et sa position en coordonnées de tuiles.
     plug->mouse_position = GetMousePosition();
@@ -197,7 +351,7 @@ void plug_update(Plug *plug) {
 		    plug->tilemap[y][x] = BLOCK_EMPTY;
 		}
 	    }
-	    array_clear(plug->players);
+	    entity_map_clear(&plug->players);
 	}
 
 	// Active/désactive l'outil gomme.
@@ -207,7 +361,7 @@ void plug_update(Plug *plug) {
 	if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON) && plug->mouse_tile_pos.x < TILESX - (plug->show ? 3 : 0) && plug->item_selected.key == ENTITY) {
 	    int posX = plug->mouse_tile_pos.x;
 	    int posY = plug->mouse_tile_pos.y;
-	    array_push(plug->players, entity_init(posX * MAP_TILE_SIZE, posY * MAP_TILE_SIZE));
+	    entity_map_insert(&plug->players, entity_init(posX * MAP_TILE_SIZE, posY * MAP_TILE_SIZE));
 	}
 
 	// Modifie la carte de tuiles en fonction du clic gauche de la souris.
@@ -227,9 +381,10 @@ void plug_update(Plug *plug) {
 		}
 	    } else {
 		plug->tilemap[posY][posX] = BLOCK_EMPTY;
-		for (size_t i = 0; i < array_size(plug->players); i++) {
-		    if (CheckCollisionPointRec(GetMousePosition(), plug->players[i].rect)) {
-			array_pop_at(plug->players, i);
+		// parcours à l'envers : une suppression ne déplace que des joueurs déjà vus
+		for (size_t i = entity_map_size(&plug->players); i > 0; i--) {
+		    if (CheckCollisionPointRec(GetMousePosition(), plug->players.entities[i - 1].rect)) {
+			entity_map_remove(&plug->players, entity_map_handle(&plug->players, i - 1));
 		    }
 		}
 	    }
@@ -281,31 +436,38 @@ void plug_update(Plug *plug) {
 	break;
     case GAME:
 	// Met le jeu en pause lors de la pression de la touche A.
-	if (IsKeyPressed(KEY_A)) plug->dialog = DIALOG_PAUSE;
+	if (IsKeyPressed(KEY_A)) {
+	    plug->dialog = DIALOG_PAUSE;
+	    sim_send(&plug->sim, (SimEvent){.type = SIM_EVENT_PAUSE});
+	}
 
 	// Active/désactive l'outil gomme.
 	if (IsKeyPressed(KEY_E)) {
 	    plug->eraser = plug->eraser ? false : true;
 	}
 
-	// Définit l'état des joueurs lors du clic gauche sur eux.
-	for (size_t i = 0; i < array_size(plug->players); i++) {
-	    if (IsMouseButtonDown(MOUSE_LEFT_BUTTON) && CheckCollisionPointRec(plug->mouse_position, plug->players[i].rect)) {
-		plug->players[i].state = MOVE_RIGHT;
+	// Les joueurs et la carte de tuiles appartiennent au thread de simulation :
+	// les clics lui sont envoyés sous forme d'événements.
+	if (IsMouseButtonDown(MOUSE_LEFT_BUTTON) && plug->dialog == DIALOG_NONE) {
+	    // Met en mouvement les joueurs sous la souris, choisis dans le dernier instantané.
+	    const Snapshot *snapshot = sim_acquire(&plug->sim);
+	    for (size_t i = 0; i < array_size(snapshot->entities); i++) {
+		if (!CheckCollisionPointRec(plug->mouse_position, snapshot->entities[i].rect)) continue;
+		SimEvent activate = {
+		    .type = SIM_EVENT_ACTIVATE,
+		    .entity = snapshot->entities[i].handle,
+		};
+		sim_send(&plug->sim, activate);
 	    }
-	}
 
-	// Modifie la carte de tuiles en fonction du clic gauche de la souris.
-	if (IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
-	    int posX = plug->mouse_tile_pos.x;
-	    int posY = plug->mouse_tile_pos.y;
-	    if (plug->tilemap[posY][posX] == BLOCK_EMPTY && plug->bricks && !plug->eraser) {
-		plug->tilemap[posY][posX] = BLOCK_BRICK;
-		plug->bricks--;
-	    } else if (plug->tilemap[posY][posX] == BLOCK_BRICK && plug->eraser) {
-		plug->tilemap[posY][posX] = BLOCK_EMPTY;
-		plug->bricks++;
-	    }
+	    // Pose ou retire une brique sur la tuile sous la souris.
+	    SimEvent brick = {
+		.type = SIM_EVENT_BRICK,
+		.x = plug->mouse_tile_pos.x,
+		.y = plug->mouse_tile_pos.y,
+		.eraser = plug->eraser,
+	    };
+	    sim_send(&plug->sim, brick);
 	}
 	break;
     default: break;
@@ -313,70 +475,185 @@ void plug_update(Plug *plug) {
 }
 
 /**
- * @brief Dessine un élément de la carte de tuiles en fonction du type de bloc.
+ * @brief Ajoute au tampon de rendu un élément de la carte de tuiles en fonction du type de bloc.
  *
- * Cette fonction dessine un élément de la carte de tuiles en fonction du type de bloc
- * à la position spécifiée (x, y), en utilisant une texture donnée.
+ * Cette fonction choisit le rectangle source du bloc dans le tileset puis ajoute
+ * la commande de dessin correspondante à la position spécifiée (x, y) sur la couche LAYER_TILES.
  *
+ * @param rb Le tampon de commandes de rendu.
  * @param tile Le type de bloc à dessiner.
  * @param x La position en coordonnée X sur la carte de tuiles.
  * @param y La position en coordonnée Y sur la carte de tuiles.
  * @param tileset La texture utilisée pour dessiner les blocs.
  */
-static void draw_tilemap(int tile, size_t x, size_t y, Texture2D tileset) {
+static void draw_tilemap(RenderBuffer *rb, int tile, size_t x, size_t y, Texture2D tileset) {
+    Rectangle source;
+    float offset_y = 0;
     switch (tile) {
-    case BLOCK_MIDDLE: return DrawTextureRec(tileset, (Rectangle){0, 0, 36, 36}, (Vector2){x * MAP_TILE_SIZE, y * MAP_TILE_SIZE}, WHITE);
-    case BLOCK_MIDDLE | BLOCK_BOTTOM: return DrawTextureRec(tileset, (Rectangle){0, 36, 36, 36}, (Vector2){x * MAP_TILE_SIZE, y * MAP_TILE_SIZE}, WHITE);
-    case BLOCK_MIDDLE | BLOCK_TOP: return DrawTextureRec(tileset, (Rectangle){0, 252, 36, 36}, (Vector2){x * MAP_TILE_SIZE, y * MAP_TILE_SIZE}, WHITE);
-    case BLOCK_MIDDLE | BLOCK_LEFT: return DrawTextureRec(tileset, (Rectangle){108, 0, 36, 36}, (Vector2){x * MAP_TILE_SIZE, y * MAP_TILE_SIZE}, WHITE); 
-    case BLOCK_MIDDLE | BLOCK_RIGHT: return DrawTextureRec(tileset, (Rectangle){36, 0, 36, 36}, (Vector2){x * MAP_TILE_SIZE, y * MAP_TILE_SIZE}, WHITE); 
-    case BLOCK_MIDDLE | BLOCK_TOP | BLOCK_BOTTOM: return DrawTextureRec(tileset, (Rectangle){0, 216, 36, 36}, (Vector2){x * MAP_TILE_SIZE, y * MAP_TILE_SIZE}, WHITE);
-    case BLOCK_MIDDLE | BLOCK_LEFT | BLOCK_RIGHT: return DrawTextureRec(tileset, (Rectangle){72, 0, 36, 36}, (Vector2){x * MAP_TILE_SIZE, y * MAP_TILE_SIZE}, WHITE); 
-    case BLOCK_MIDDLE | BLOCK_LEFT | BLOCK_BOTTOM: return DrawTextureRec(tileset, (Rectangle){108, 36, 36, 36}, (Vector2){x * MAP_TILE_SIZE, y * MAP_TILE_SIZE}, WHITE); 
-    case BLOCK_MIDDLE | BLOCK_LEFT | BLOCK_TOP: return DrawTextureRec(tileset, (Rectangle){108, 252, 36, 36}, (Vector2){x * MAP_TILE_SIZE, y * MAP_TILE_SIZE}, WHITE); 
-    case BLOCK_MIDDLE | BLOCK_RIGHT | BLOCK_BOTTOM: return DrawTextureRec(tileset, (Rectangle){36, 36, 36, 36}, (Vector2){x * MAP_TILE_SIZE, y * MAP_TILE_SIZE}, WHITE); 
-    case BLOCK_MIDDLE | BLOCK_RIGHT | BLOCK_TOP: return DrawTextureRec(tileset, (Rectangle){36, 252, 36, 36}, (Vector2){x * MAP_TILE_SIZE, y * MAP_TILE_SIZE}, WHITE); 
-    case BLOCK_MIDDLE | BLOCK_LEFT | BLOCK_RIGHT | BLOCK_TOP: return DrawTextureRec(tileset, (Rectangle){72, 252, 36, 36}, (Vector2){x * MAP_TILE_SIZE, y * MAP_TILE_SIZE}, WHITE); 
-    case BLOCK_MIDDLE | BLOCK_LEFT | BLOCK_RIGHT | BLOCK_BOTTOM: return DrawTextureRec(tileset, (Rectangle){72, 36, 36, 36}, (Vector2){x * MAP_TILE_SIZE, y * MAP_TILE_SIZE}, WHITE); 
-    case BLOCK_MIDDLE | BLOCK_LEFT | BLOCK_TOP | BLOCK_BOTTOM: return DrawTextureRec(tileset, (Rectangle){108, 216, 36, 36}, (Vector2){x * MAP_TILE_SIZE, y * MAP_TILE_SIZE}, WHITE); 
-    case BLOCK_MIDDLE | BLOCK_RIGHT | BLOCK_TOP | BLOCK_BOTTOM: return DrawTextureRec(tileset, (Rectangle){36, 216, 36, 36}, (Vector2){x * MAP_TILE_SIZE, y * MAP_TILE_SIZE}, WHITE); 
-    case BLOCK_MIDDLE | BLOCK_LEFT | BLOCK_RIGHT | BLOCK_TOP | BLOCK_BOTTOM: return DrawTextureRec(tileset, (Rectangle){72, 216, 36, 36}, (Vector2){x * MAP_TILE_SIZE, y * MAP_TILE_SIZE}, WHITE); 
+    case BLOCK_MIDDLE: source = (Rectangle){0, 0, 36, 36}; break;
+    case BLOCK_MIDDLE | BLOCK_BOTTOM: source = (Rectangle){0, 36, 36, 36}; break;
+    case BLOCK_MIDDLE | BLOCK_TOP: source = (Rectangle){0, 252, 36, 36}; break;
+    case BLOCK_MIDDLE | BLOCK_LEFT: source = (Rectangle){108, 0, 36, 36}; break;
+    case BLOCK_MIDDLE | BLOCK_RIGHT: source = (Rectangle){36, 0, 36, 36}; break;
+    case BLOCK_MIDDLE | BLOCK_TOP | BLOCK_BOTTOM: source = (Rectangle){0, 216, 36, 36}; break;
+    case BLOCK_MIDDLE | BLOCK_LEFT | BLOCK_RIGHT: source = (Rectangle){72, 0, 36, 36}; break;
+    case BLOCK_MIDDLE | BLOCK_LEFT | BLOCK_BOTTOM: source = (Rectangle){108, 36, 36, 36}; break;
+    case BLOCK_MIDDLE | BLOCK_LEFT | BLOCK_TOP: source = (Rectangle){108, 252, 36, 36}; break;
+    case BLOCK_MIDDLE | BLOCK_RIGHT | BLOCK_BOTTOM: source = (Rectangle){36, 36, 36, 36}; break;
+    case BLOCK_MIDDLE | BLOCK_RIGHT | BLOCK_TOP: source = (Rectangle){36, 252, 36, 36}; break;
+    case BLOCK_MIDDLE | BLOCK_LEFT | BLOCK_RIGHT | BLOCK_TOP: source = (Rectangle){72, 252, 36, 36}; break;
+    case BLOCK_MIDDLE | BLOCK_LEFT | BLOCK_RIGHT | BLOCK_BOTTOM: source = (Rectangle){72, 36, 36, 36}; break;
+    case BLOCK_MIDDLE | BLOCK_LEFT | BLOCK_TOP | BLOCK_BOTTOM: source = (Rectangle){108, 216, 36, 36}; break;
+    case BLOCK_MIDDLE | BLOCK_RIGHT | BLOCK_TOP | BLOCK_BOTTOM: source = (Rectangle){36, 216, 36, 36}; break;
+    case BLOCK_MIDDLE | BLOCK_LEFT | BLOCK_RIGHT | BLOCK_TOP | BLOCK_BOTTOM: source = (Rectangle){72, 216, 36, 36}; break;
 
     // dessine les block interactif avec le joueur
-    case BLOCK_COIN: return DrawTextureRec(tileset, TEXTURE_COIN, (Vector2){x * MAP_TILE_SIZE, y * MAP_TILE_SIZE}, WHITE); 
-    case BLOCK_SPIKE: return DrawTextureRec(tileset, TEXTURE_SPIKE, (Vector2){x * MAP_TILE_SIZE, y * MAP_TILE_SIZE}, WHITE); 
-    case BLOCK_S_BRICK: return DrawTextureRec(tileset, TEXTURE_SMALL_BRICK, (Vector2){x * MAP_TILE_SIZE, y * MAP_TILE_SIZE}, WHITE); 
-    case BLOCK_B_BRICK: return DrawTextureRec(tileset, TEXTURE_BIG_BRICK, (Vector2){x * MAP_TILE_SIZE, y * MAP_TILE_SIZE}, WHITE); 
-    case BLOCK_DOOR: return DrawTextureRec(tileset, TEXTURE_DOOR, (Vector2){x * MAP_TILE_SIZE, y * MAP_TILE_SIZE - 18}, WHITE); 
-    case BLOCK_BRICK: return DrawTextureRec(tileset, TEXTURE_BRICK, (Vector2){x * MAP_TILE_SIZE, y * MAP_TILE_SIZE}, WHITE); 
+    case BLOCK_COIN: source = TEXTURE_COIN; break;
+    case BLOCK_SPIKE: source = TEXTURE_SPIKE; break;
+    case BLOCK_S_BRICK: source = TEXTURE_SMALL_BRICK; break;
+    case BLOCK_B_BRICK: source = TEXTURE_BIG_BRICK; break;
+    case BLOCK_DOOR: source = TEXTURE_DOOR; offset_y = -18; break;
+    case BLOCK_BRICK: source = TEXTURE_BRICK; break;
     default: return;
     }
+    render_push_rec(rb, LAYER_TILES, tileset, source, (Vector2){x * MAP_TILE_SIZE, y * MAP_TILE_SIZE + offset_y}, WHITE);
+}
+
+/**
+ * @brief Ajoute le fond du niveau au tampon de rendu.
+ *
+ * @param rb Le tampon de commandes de rendu.
+ * @param background La texture du fond.
+ */
+static void draw_background(RenderBuffer *rb, Texture2D background) {
+    Rectangle source = {0, 0, background.width, background.height};
+    Rectangle dest = {0, 0, background.width * 6.67f, background.height * 6.67f};
+    render_push(rb, LAYER_BACKGROUND, background, source, dest, WHITE);
 }
 
 /**
  * @brief Dessine les joueurs sur l'écran en utilisant des textures spécifiques.
  *
  * Cette fonction parcourt le tableau des joueurs dans la structure Plug
- * et dessine chaque joueur sur l'écran en fonction de son état de déplacement,
+ * et ajoute au tampon de rendu chaque joueur en fonction de son état de déplacement,
  * utilisant les textures spécifiées pour le mouvement vers la gauche et le mouvement normal.
  *
- * @param plug Un pointeur vers la structure Plug contenant les joueurs à dessiner.
+ * Chaque joueur est dessiné entre sa position précédente et sa position courante,
+ * selon la fraction `alpha` du pas de simulation écoulée.
+ * Les joueurs dont le sprite est hors de la vue ne sont pas soumis.
+ *
+ * @param plug Un pointeur vers la structure Plug contenant le tampon de rendu.
+ * @param snapshot L'instantané contenant les joueurs à dessiner.
+ * @param alpha La fraction du pas de simulation écoulée.
+ * @param view Rectangle visible en coordonnées du monde.
  * @param player_texture La texture utilisée pour dessiner le joueur en mouvement normal.
  * @param player_flop La texture utilisée pour dessiner le joueur en mouvement vers la gauche.
  */
-static void draw_player(Plug *plug, Texture2D player_texture, Texture2D player_flop) {
-    for (size_t i = 0; i < array_size(plug->players); i++) {
-	Entity player = plug->players[i];
+static void draw_player(Plug *plug, const Snapshot *snapshot, float alpha, Rectangle view, Texture2D player_texture, Texture2D player_flop) {
+    for (size_t i = 0; i < array_size(snapshot->entities); i++) {
+	SnapshotEntity player = snapshot->entities[i];
+	Vector2 position = Vector2Lerp(player.previous, (Vector2){player.rect.x, player.rect.y}, alpha);
+	Rectangle sprite = {position.x - 12, position.y - 12, TEXTURE_PLAYER.width, TEXTURE_PLAYER.height};
+	if (!CheckCollisionRecs(sprite, view)) {
+	    plug->render.stats.culled += 1;
+	    continue;
+	}
+
 	if (player.state == MOVE_LEFT) {
 	    // Dessine le joueur avec la texture de mouvement vers la gauche.
-	    DrawTextureRec(player_texture, TEXTURE_PLAYER, (Vector2){player.rect.x - 12, player.rect.y - 12}, WHITE);
+	    render_push_rec(&plug->render, LAYER_ENTITIES, player_texture, TEXTURE_PLAYER, (Vector2){sprite.x, sprite.y}, WHITE);
 	} else {
 	    // Dessine le joueur avec la texture de mouvement vers la droite.
-	    DrawTextureRec(player_flop, TEXTURE_PLAYER_FLOP, (Vector2){player.rect.x - 12, player.rect.y - 12}, WHITE);
+	    render_push_rec(&plug->render, LAYER_ENTITIES, player_flop, TEXTURE_PLAYER_FLOP, (Vector2){sprite.x, sprite.y}, WHITE);
 	}
     }
 }
 
+/**
+ * @brief Affiche en bas à droite la sauvegarde en cours ou le résultat de la dernière.
+ *
+ * @param plug Un pointeur vers la structure Plug contenant le HUD.
+ * @param tint Couleur du texte.
+ */
+static void draw_save_status(Plug *plug, Color tint) {
+    Hud *hud = &plug->hud;
+    if (saver_busy(&plug->saver)) {
+	hud_text_set(&hud->font, &hud->save, "saving...");
+    } else if (GetTime() - plug->save_message_time < SAVE_MESSAGE_DURATION) {
+	hud_text_set(&hud->font, &hud->save, plug->save_message);
+    } else {
+	return;
+    }
+    Vector2 position = {GetScreenWidth() - hud->save.extent.x - 10, GetScreenHeight() - hud->save.extent.y - 10};
+    hud_text_draw(&plug->render, &hud->font, &hud->save, position, tint);
+}
+
+/**
+ * @brief Affiche en haut à droite la mémoire de chaque sous-système (touche F3).
+ *
+ * Un texte n'est remis en page que lorsque les compteurs de son allocateur changent.
+ *
+ * @param plug Un pointeur vers la structure Plug contenant le HUD.
+ * @param tint Couleur du texte.
+ */
+static void draw_memory(Plug *plug, Color tint) {
+    Memory *memory = &plug->memory;
+    if (!memory->show) return;
+    for (size_t i = 0; i < MEMORY_COUNT; i++) {
+	ArrayAllocator *allocator = &memory->allocators[i];
+	ArrayAllocatorStats stats = array_allocator_stats(allocator);
+	char line[HUD_TEXT_CAPACITY];
+	int size = snprintf(line, sizeof(line), "%s: %zu B live, %zu B peak, %zu allocs",
+			    allocator->name, stats.live_bytes, stats.peak_bytes, stats.allocations);
+	if (i == MEMORY_LAYOUTS && size >= 0 && (size_t)size < sizeof(line)) {
+	    // part des mises en page reprises des noeuds retenus
+	    LayoutStack *layouts = &plug->layouts;
+	    size_t pushes = layouts->hits + layouts->misses;
+	    snprintf(line + size, sizeof(line) - size, ", %zu%% retained, %zu misses",
+		     pushes ? layouts->hits * 100 / pushes : 0, layouts->misses);
+	}
+	HudText *text = &memory->texts[i];
+	hud_text_set(&plug->hud.font, text, line);
+	Vector2 position = {GetScreenWidth() - text->extent.x - 10, 10 + 15 * i};
+	hud_text_draw(&plug->render, &plug->hud.font, text, position, tint);
+    }
+}
+
+/**
+ * @brief Dessine le HUD de l'éditeur et du jeu.
+ *
+ * Affiche le mode gomme, le nombre de briques (en jeu) et le nombre de sprites
+ * soumis et écartés pendant la frame. Les textes ne sont remis en page que
+ * lorsque leur valeur change.
+ *
+ * @param plug Un pointeur vers la structure Plug contenant le HUD.
+ * @param snapshot L'instantané du jeu, ou NULL pour ne pas afficher les briques.
+ */
+static void draw_hud(Plug *plug, const Snapshot *snapshot) {
+    Hud *hud = &plug->hud;
+    RenderStats stats = plug->render.stats;
+
+    hud_text_set(&hud->font, &hud->eraser, plug->eraser ? "eraser mode: on" : "eraser mode: off");
+    hud_text_draw(&plug->render, &hud->font, &hud->eraser, (Vector2){10, 10}, BLACK);
+
+    if (snapshot) {
+	hud_text_int(&hud->font, &hud->bricks, "brick count: ", snapshot->bricks);
+	hud_text_draw(&plug->render, &hud->font, &hud->bricks, (Vector2){10, 35}, BLACK);
+    }
+
+    hud_text_pair(&hud->font, &hud->sprites, "sprites submitted/culled: ", stats.commands, '/', stats.culled);
+    hud_text_draw(&plug->render, &hud->font, &hud->sprites, (Vector2){10, GetScreenHeight() - 20}, BLACK);
+
+    if (snapshot && plug->open_time > 0) {
+	hud_text_int(&hud->font, &hud->open, plug->open_prefetched ? "click to play (us, prefetched): " : "click to play (us): ", plug->open_time * 1e6);
+	hud_text_draw(&plug->render, &hud->font, &hud->open, (Vector2){10, GetScreenHeight() - 35}, BLACK);
+    }
+
+    draw_save_status(plug, BLACK);
+    draw_memory(plug, BLACK);
+    render_flush(&plug->render);
+}
+
 /**
  * @brief Dessine la boîte d'items dans l'éditeur de niveau.
  *
@@ -468,19 +745,43 @@ static void draw_items_box(Plug *plug, Texture tileset, Texture player) {
 	    // Montre visuellement l'objet sélectionné dans la boîte d'items.
 	    if (i < 6) {
 		if (plug->item_selected.key == BLOCK && plug->item_selected.value.block_id == tiletype[i]) {
-		    layout_item(true, tileset, tile_position, recs[i]);
+		    layout_item(&plug->render, true, tileset, tile_position, recs[i]);
 		} else {
-		    layout_item(false, tileset, tile_position, recs[i]);
+		    layout_item(&plug->render, false, tileset, tile_position, recs[i]);
 		}
 	    } else {
 		if (plug->item_selected.key == ENTITY) {
-		    layout_item(true, player, tile_position, recs[i]);
+		    layout_item(&plug->render, true, player, tile_position, recs[i]);
 		} else {
-		    layout_item(false, player, tile_position, recs[i]);
+		    layout_item(&plug->render, false, player, tile_position, recs[i]);
 		}
 	    }
 	}
     }
+
+    // Soumet les items de la boîte par-dessus son fond.
+    render_flush(&plug->render);
+}
+
+/**
+ * @brief Affiche les dimensions, le nombre de joueurs et de pièces d'un niveau de l'index.
+ *
+ * @param plug Un pointeur vers la structure Plug contenant le HUD.
+ * @param entry L'entrée du niveau dans l'index.
+ * @param position Position du texte à l'écran.
+ */
+static void draw_level_info(Plug *plug, const CatalogEntry *entry, Vector2 position) {
+    HudText *text = &plug->hud.level;
+    // Le texte n'est remis en page que s'il change : autre niveau survolé ou
+    // entrée mise à jour sur place par catalog_refresh ou catalog_poll.
+    char info[HUD_TEXT_CAPACITY];
+    if (entry->valid) {
+	snprintf(info, sizeof(info), "%dx%d tiles, %d players, %d coins", entry->width, entry->height, entry->players, entry->coins);
+    } else {
+	snprintf(info, sizeof(info), "invalid level");
+    }
+    hud_text_set(&plug->hud.font, text, info);
+    hud_text_draw(&plug->render, &plug->hud.font, text, position, WHITE);
 }
 
 /**
@@ -506,6 +807,7 @@ static void draw_level_select(Plug *plug) {
     GuiSetStyle(LABEL, TEXT_COLOR_NORMAL, 0xffffffff);
 
     size_t index = 9 * plug->page;
+    const CatalogEntry *hovered = NULL;
 
     Drawing {
 	ClearBackground(BLACK);
@@ -526,7 +828,9 @@ static void draw_level_select(Plug *plug) {
 		.height = top_layout.height/2,
 	    };
 	    if (GuiButton(top_right, "New")) {
-		array_clear(plug->players);
+		free(plug->level_path);
+		plug->level_path = NULL;
+		entity_map_clear(&plug->players);
 		for (size_t y = 0; y < TILESY; y++) {
 		    for (size_t x = 0; x < TILESX; x++) {
 			plug->tilemap[y][x] = BLOCK_EMPTY;
@@ -553,13 +857,23 @@ static void draw_level_select(Plug *plug) {
 		for (size_t i = 0; i < 3; i++) {
 		    LayoutDrawing(&plug->layouts, LO_HORI, layout_stack_slot(&plug->layouts), 3, gap) {
 			for (size_t j = 0; j < 3; j++) {
-			    if (index < array_size(plug->paths)) {
-				if (GuiButton(layout_stack_slot(&plug->layouts), plug->paths[index])) {
-				    array_clear(plug->players);
-				    open_level(plug, plug->paths[index]);
-				    //plug->state = EDITOR;
-				    plug->state = GAME;
-				    plug->level_selected = index;
+			    if (index < catalog_count(&plug->catalog)) {
+				const CatalogEntry *entry = &plug->catalog.entries[index];
+				Rectangle slot = layout_stack_slot(&plug->layouts);
+				if (CheckCollisionPointRec(GetMousePosition(), slot)) hovered = entry;
+				if (GuiButton(slot, entry->path)) {
+				    // L'entrée peut disparaître de l'index : le chemin est copié.
+				    plug->open_start = GetTime();
+				    free(plug->level_path);
+				    plug->level_path = strdup(entry->path);
+				    entity_map_clear(&plug->players);
+				    // La partie ne démarre que si le niveau a pu être chargé.
+				    if (open_level(plug, plug->level_path)) {
+					plug->state = GAME;
+					sim_start(&plug->sim, plug);
+				    } else {
+					plug->state = EDITOR;
+				    }
 				}
 			    }
 			    index += 1;
@@ -588,76 +902,62 @@ static void draw_level_select(Plug *plug) {
 	    };
 
 	    // Affiche le numéro de page actuel.
-	    GuiLabel(page_recs, TextFormat("%ld/%d", plug->page + 1, (int)ceil((float)array_size(plug->paths)/9)));
+	    hud_text_pair(&plug->hud.font, &plug->hud.page, "", plug->page + 1, '/', (int)ceil((float)catalog_count(&plug->catalog)/9));
+	    GuiLabel(page_recs, plug->hud.page.text);
 
 	    // Boutons pour changer de page.
 	    if (GuiButton(previous, "<")) {
 		if (plug->page > 0) plug->page -= 1;
 	    }
 	    if (GuiButton(next, ">")) {
-		if (9 * (plug->page + 1) < array_size(plug->paths)) plug->page += 1;
+		if (9 * (plug->page + 1) < catalog_count(&plug->catalog)) plug->page += 1;
 	    }
 	}
+
+	// Affiche les métadonnées du niveau survolé, lues dans l'index sans ouvrir le fichier.
+	if (hovered) draw_level_info(plug, hovered, (Vector2){rec.x, rec.y + rec.height + gap});
+
+	// Affiche l'état de la dernière sauvegarde.
+	draw_save_status(plug, WHITE);
+	render_flush(&plug->render);
     }
 }
 
 /**
- * @brief Sauvegarde l'état actuel du niveau et des joueurs dans un fichier XML.
+ * @brief Sauvegarde l'état actuel du niveau et des joueurs dans un fichier.
  *
- * Cette fonction sauvegarde l'état actuel du niveau (configuration des blocs)
- * ainsi que les positions des joueurs dans un fichier XML spécifié par le chemin
- * du fichier.
+ * Cette fonction copie l'état actuel du niveau (configuration des blocs) ainsi
+ * que les positions des joueurs, puis confie l'écriture au thread d'écriture :
+ * le rendu n'attend pas la fin de la sauvegarde. Le fichier est écrit au format
+ * XML ou binaire selon son extension (voir level_save), et son chemin est ajouté
+ * à la liste des niveaux une fois l'écriture réussie (voir poll_saves).
  *
  * @param plug Un pointeur vers la structure Plug contenant les informations de l'éditeur.
- * @param file_path Le chemin du fichier XML dans lequel sauvegarder les données.
+ * @param file_path Le chemin du fichier dans lequel sauvegarder les données.
  */
 void plug_save(Plug *plug, char *file_path) {
-    int string_size = TILESY * (TILESX * 5) + 1;
-    char *S = malloc(sizeof(char) * string_size);
-    S[0] = '\0';
+    Level level;
+    level_init(&level, TILESX, TILESY);
 
-    // Construit la chaîne de caractères représentant la configuration des blocs.
+    // Copie la configuration des blocs dans le plan de tuiles du niveau.
     for (size_t y = 0; y < TILESY; y++) {
 	for (size_t x = 0; x < TILESX; x++) {
-	    char itoa[4];
-	    itoa[0] = '\0';
-	    sprintf(itoa, "%d", plug->tilemap[y][x]);
-	    strncat(S, itoa, 4);
-
-	    if (y != TILESY - 1 || x != TILESX - 1) strcat(S, ",");
+	    level.tiles[y * TILESX + x] = plug->tilemap[y][x];
 	}
-	if (y != TILESY - 1) strcat(S, "\n");
     }
 
-    // Initialise un document XML et ajoute le noeud CSV pour la configuration des blocs.
-    XMLDocument doc = xml_doc_init("root");
-    XMLNode *csv = xml_node_new(doc.root);
-    csv->tag = strdup("csv");
-    csv->inner_text = S;
-
-    // Ajoute les informations des joueurs sous forme de noeuds XML.
-    for (size_t i = 0; i < array_size(plug->players); i++) {
-	XMLNode *player = xml_node_new(doc.root);
-	player->tag = strdup("player");
-	char char_x[4];
-	char_x[0] = '\0';
-	char char_y[4];
-	char_y[0] = '\0';
-	
-	// Convertit les positions des joueurs en chaînes de caractères.
-	sprintf(char_x, "%d", (int)(plug->players[i].rect.x / MAP_TILE_SIZE));
-	sprintf(char_y, "%d", (int)(plug->players[i].rect.y / MAP_TILE_SIZE));
-
-	// Ajoute les attributs x et y au nœud du joueur.
-	xml_attrib_add(player, "x", char_x);
-	xml_attrib_add(player, "y", char_y);
+    // Ajoute les positions des joueurs, en tuiles, à la table des entités.
+    for (size_t i = 0; i < entity_map_size(&plug->players); i++) {
+	LevelEntity entity = {
+	    .type = LEVEL_ENTITY_PLAYER,
+	    .x = (int)(plug->players.entities[i].rect.x / MAP_TILE_SIZE),
+	    .y = (int)(plug->players.entities[i].rect.y / MAP_TILE_SIZE),
+	};
+	level_add_entity(&level, entity);
     }
-    
-    // Écrit le document XML dans le fichier spécifié par le chemin avec l'indentation de 2 espace.
-    xml_doc_write(&doc, file_path, 2);
-    
-    // Libère la mémoire allouée pour le document XML.
-    xml_doc_free(&doc);
+
+    // Le thread d'écriture possède maintenant la copie du niveau.
+    saver_submit(&plug->saver, level, file_path);
 }
 
 /**
@@ -667,41 +967,55 @@ void plug_save(Plug *plug, char *file_path) {
  * les joueurs, la boîte d'outils et la boîte de dialogue éventuelle.
  *
  * @param plug Un pointeur vers la structure Plug contenant les informations de l'éditeur.
+ * @param snapshot Instantané de la carte de tuiles et des joueurs à dessiner.
+ * @param alpha Fraction du pas de simulation écoulée, pour l'interpolation des joueurs.
  * @param background Texture du fond.
  * @param tileset Texture de l'ensemble de tuiles.
  * @param player Texture du joueur.
  * @param player_flop Texture du joueur (état flop).
  */
-static void draw_level_editor(Plug *plug, Texture2D background, Texture2D tileset, Texture2D player, Texture2D player_flop) {
+static void draw_level_editor(Plug *plug, const Snapshot *snapshot, float alpha, Texture2D background, Texture2D tileset, Texture2D player, Texture2D player_flop) {
     static char text_box[10];
     Drawing {
 	ClearBackground(BLACK);
 
 	// Active le mode 2D avec la caméra spécifiée.
 	Mode2D(plug->camera) {
+	    Rectangle view = render_view_bounds(plug->camera);
+	    TileRange range = visible_tiles(view);
 
 	    // Dessine le fond.
-	    DrawTextureEx(background, (Vector2){0, 0}, 0, 6.67, WHITE);
-
-	    // Dessine la configuration des blocs.
-	    for (int y = 0; y < TILESY; y++) {
-		for (int x = 0; x < TILESX; x++) {
-		    if (plug->tilemap[y][x]) {
-			draw_tilemap(plug->tilemap[y][x], x, y, tileset);
+	    draw_background(&plug->render, background);
+
+	    // Dessine la configuration des blocs visibles.
+	    for (int y = range.y0; y < range.y1; y++) {
+		for (int x = range.x0; x < range.x1; x++) {
+		    int tile = snapshot->tiles[y * TILESX + x];
+		    if (tile) {
+			draw_tilemap(&plug->render, tile, x, y, tileset);
 		    }
+		}
+	    }
+	    count_culled_tiles(&plug->render, snapshot->tiles, range);
+	    render_flush(&plug->render);
+
+	    // Dessine la grille par-dessus les blocs.
+	    for (int y = range.y0; y < range.y1; y++) {
+		for (int x = range.x0; x < range.x1; x++) {
 		    DrawRectangleLines(x * MAP_TILE_SIZE, y * MAP_TILE_SIZE, MAP_TILE_SIZE, MAP_TILE_SIZE, x == plug->mouse_tile_pos.x && y == plug->mouse_tile_pos.y ? RED : Fade(BLACK, 0.3f));
 		}
 	    }
 
 	    // Dessine les joueurs.
-	    draw_player(plug, player, player_flop);
+	    draw_player(plug, snapshot, alpha, view, player, player_flop);
+	    render_flush(&plug->render);
 	}
 
 	// Dessine la boîte d'outils.
 	draw_items_box(plug, tileset, player);
 	
 	// Affiche le mode gomme.
-	DrawText(TextFormat("eraser mode: %s", plug->eraser ? "on" : "off"), 10, 10, 20, BLACK);
+	draw_hud(plug, NULL);
 	
 	// Affiche la boîte de dialogue de l'éditeur si elle est active.
 	if (plug->dialog == DIALOG_EDITOR) {
@@ -735,10 +1049,12 @@ static void draw_level_editor(Plug *plug, Texture2D background, Texture2D tilese
 		    plug->dialog = DIALOG_NONE;
 		}
 		if (GuiButton(layout_stack_slot(&plug->layouts), "save")) {
-		    printf("saving %s\n", plug->paths[plug->level_selected]);
-		    plug_save(plug, plug->paths[plug->level_selected]);
-		    reset_paths(plug);
-		    plug->paths = xml_get_filepaths("levels");
+		    if (plug->level_path) {
+			printf("saving %s\n", plug->level_path);
+			plug_save(plug, plug->level_path);
+		    } else {
+			fprintf(stderr, "ERROR: This level has no file yet, use \"new save\"\n");
+		    }
 		    plug->state = START_MENU;
 		    plug->dialog = DIALOG_NONE;
 		}
@@ -769,8 +1085,6 @@ static void draw_level_editor(Plug *plug, Texture2D background, Texture2D tilese
 			    printf("%s\n", file_path);
 			    text_box[0] = '\0';
 			    plug_save(plug, file_path);
-			    reset_paths(plug);
-			    plug->paths = xml_get_filepaths("levels");
 			    plug->state = START_MENU;
 			    plug->dialog = DIALOG_NONE;
 			}
@@ -788,30 +1102,38 @@ static void draw_level_editor(Plug *plug, Texture2D background, Texture2D tilese
  * les joueurs, les informations de jeu et la boîte de dialogue éventuelle.
  *
  * @param plug Un pointeur vers la structure Plug contenant les informations du jeu.
+ * @param snapshot Instantané publié par le thread de simulation.
+ * @param alpha Fraction du pas de simulation écoulée, pour l'interpolation des joueurs.
  * @param background Texture du fond.
  * @param tileset Texture de l'ensemble de tuiles.
  * @param player Texture du joueur.
  * @param player_flop Texture du joueur (état flop).
  */
-static void draw_level_game(Plug *plug, Texture2D background, Texture2D tileset, Texture2D player, Texture2D player_flop) {
+static void draw_level_game(Plug *plug, const Snapshot *snapshot, float alpha, Texture2D background, Texture2D tileset, Texture2D player, Texture2D player_flop) {
     Drawing {
 	ClearBackground(BLACK);
 	Mode2D(plug->camera) {
-	    DrawTextureEx(background, (Vector2){0, 0}, 0, 6.67, WHITE);
-	    for (int y = 0; y < TILESY; y++) {
-		for (int x = 0; x < TILESX; x++) {
-		    if (plug->tilemap[y][x]) {
-			draw_tilemap(plug->tilemap[y][x], x, y, tileset);
+	    Rectangle view = render_view_bounds(plug->camera);
+	    TileRange range = visible_tiles(view);
+
+	    draw_background(&plug->render, background);
+	    for (int y = range.y0; y < range.y1; y++) {
+		for (int x = range.x0; x < range.x1; x++) {
+		    int tile = snapshot->tiles[y * TILESX + x];
+		    if (tile) {
+			draw_tilemap(&plug->render, tile, x, y, tileset);
 		    }
 		}
 	    }
-	    draw_player(plug, player, player_flop);
+	    count_culled_tiles(&plug->render, snapshot->tiles, range);
+	    draw_player(plug, snapshot, alpha, view, player, player_flop);
+	    render_flush(&plug->render);
 	}
 
-	DrawText(TextFormat("eraser mode: %s", plug->eraser ? "on" : "off"), 10, 10, 20, BLACK);
-	DrawText(TextFormat("brick count: %d", plug->bricks), 10, 35, 20, BLACK);
+	// Affiche le mode gomme, le nombre de briques et les compteurs de sprites.
+	draw_hud(plug, snapshot);
 
-	if (array_size(plug->players) == 0) {
+	if (array_size(snapshot->entities) == 0) {
 	    plug->dialog = DIALOG_GAME;
 	}
 
@@ -830,17 +1152,19 @@ static void draw_level_game(Plug *plug, Texture2D background, Texture2D tileset,
 	    GuiSetStyle(LABEL, TEXT_ALIGNMENT, TEXT_ALIGN_CENTER);
 	    
 	    LayoutDrawing(&plug->layouts, LO_VERT, layout_make_rec(rec.x + gap, rec.y + gap, rec.width - (gap * 2), rec.height - (gap * 2)), 3, gap) {
-		GuiLabel(layout_stack_slot(&plug->layouts), TextFormat("players exit: %d/%d", plug->score_players, plug->goal));
+		hud_text_pair(&plug->hud.font, &plug->hud.exit, "players exit: ", snapshot->score_players, '/', plug->goal);
+		GuiLabel(layout_stack_slot(&plug->layouts), plug->hud.exit.text);
 
-		if (plug->score_players == 0) {
+		if (snapshot->score_players == 0) {
 		    GuiLabel(layout_stack_slot(&plug->layouts), "bad !");
-		} else if (plug->score_players == plug->goal && plug->max_coins == plug->coins) {
+		} else if (snapshot->score_players == plug->goal && plug->max_coins == snapshot->coins) {
 		    GuiLabel(layout_stack_slot(&plug->layouts), "perfect !");
 		} else {
 		    GuiLabel(layout_stack_slot(&plug->layouts), "good !");
 		}
 
 		if (GuiButton(layout_stack_slot(&plug->layouts), "quit")) {
+		    sim_stop(&plug->sim);
 		    plug->score_players = 0;
 		    plug->coins = 0;
 		    plug->max_coins = 0;
@@ -868,14 +1192,17 @@ static void draw_level_game(Plug *plug, Texture2D background, Texture2D tileset,
 	    LayoutDrawing(&plug->layouts, LO_VERT, layout_make_rec(rec.x + gap, rec.y + gap, rec.width - (gap * 2), rec.height - (gap * 2)), 3, gap) {
 		GuiLabel(layout_stack_slot(&plug->layouts), "pause");
 		if (GuiButton(layout_stack_slot(&plug->layouts), "edit")) {
+		    sim_stop(&plug->sim);
 		    plug->state = EDITOR;
 		    plug->dialog = DIALOG_NONE;
 		}
 		LayoutDrawing(&plug->layouts, LO_HORI, layout_stack_slot(&plug->layouts), 2, gap) {
 		    if (GuiButton(layout_stack_slot(&plug->layouts), "continue")) {
+			sim_send(&plug->sim, (SimEvent){.type = SIM_EVENT_RESUME});
 			plug->dialog = DIALOG_NONE;
 		    }
 		    if (GuiButton(layout_stack_slot(&plug->layouts), "quit")) {
+			sim_stop(&plug->sim);
 			plug->eraser = false;
 			plug->score_players = 0;
 			plug->coins = 0;
@@ -903,10 +1230,28 @@ static void draw_level_game(Plug *plug, Texture2D background, Texture2D tileset,
  * @param player_flop Texture du joueur (état flop).
  */
 void plug_render(Plug *plug, Texture2D background, Texture2D tileset, Texture2D player, Texture player_flop) {
+    render_begin(&plug->render);
+
+    // Le rendu lit l'état du jeu à travers un instantané : celui publié par le thread
+    // de simulation s'il tourne, sinon une copie faite sur le thread principal.
+    const Snapshot *snapshot = NULL;
+    float alpha = plug->alpha;
+    if (sim_running(&plug->sim)) {
+	snapshot = sim_acquire(&plug->sim);
+	alpha = sim_alpha(snapshot);
+    } else if (plug->state != START_MENU) {
+	sim_capture(&plug->sim.local, plug);
+	snapshot = &plug->sim.local;
+    }
+
     switch (plug->state) {
     case START_MENU: return draw_level_select(plug);
-    case EDITOR: return draw_level_editor(plug, background, tileset, player, player_flop);
-    case GAME: return draw_level_game(plug, background, tileset, player, player_flop);
+    case EDITOR: return draw_level_editor(plug, snapshot, alpha, background, tileset, player, player_flop);
+    case GAME:
+	draw_level_game(plug, snapshot, alpha, background, tileset, player, player_flop);
+	// La frame est présentée : le niveau ouvert est jouable.
+	report_open_time(plug);
+	return;
     default: break;
     }
 }
@@ -920,11 +1265,58 @@ void plug_render(Plug *plug, Texture2D background, Texture2D tileset, Texture2D
  * @param plug Un pointeur vers la structure Plug à libérer.
  */
 void plug_free(Plug *plug) {
-    for (size_t i = 0; i < array_size(plug->paths); i++) {
-	free(plug->paths[i]);
-    }
-    array_free(plug->paths);
-    array_free(plug->players);
-    array_free(plug->layouts);
+    sim_free(&plug->sim);
+    saver_free(&plug->saver);
+    loader_free(&plug->loader);
+    catalog_close(&plug->catalog);
+    free(plug->level_path);
+    entity_map_free(&plug->players);
+    layout_stack_free(&plug->layouts);
+    render_free(&plug->render);
+    hud_text_free(&plug->hud.eraser);
+    hud_text_free(&plug->hud.bricks);
+    hud_text_free(&plug->hud.exit);
+    hud_text_free(&plug->hud.sprites);
+    hud_text_free(&plug->hud.page);
+    hud_text_free(&plug->hud.save);
+    hud_text_free(&plug->hud.level);
+    hud_text_free(&plug->hud.open);
+    for (size_t i = 0; i < MEMORY_COUNT; i++) hud_text_free(&plug->memory.texts[i]);
+    hud_font_free(&plug->hud.font);
+    xml_set_allocator(NULL);
+}
+
+/**
+ * @brief Prépare la structure Plug au rechargement de libplug.so.
+ *
+ * Le thread de simulation, le thread d'écriture et le thread de préchargement
+ * exécutent du code de la bibliothèque : ils sont arrêtés avant que l'ancienne
+ * bibliothèque soit fermée. Les sauvegardes en attente sont terminées avant
+ * l'arrêt du thread d'écriture ; les préchargements en attente sont abandonnés.
+ * Ces deux threads sont relancés par la prochaine demande.
+ *
+ * @param plug Un pointeur vers la structure Plug.
+ */
+void plug_pre_reload(Plug *plug) {
+    plug->sim.resume_after_reload = sim_running(&plug->sim);
+    sim_stop(&plug->sim);
+    saver_stop(&plug->saver);
+    loader_stop(&plug->loader);
 }
 
+/**
+ * @brief Restaure la structure Plug après le rechargement de libplug.so.
+ *
+ * Relance le thread de simulation s'il tournait avant le rechargement,
+ * redonne à xml.c l'allocateur des documents XML (son choix est propre à la
+ * bibliothèque chargée) et oublie les mises en page retenues, dont les
+ * identifiants dépendent de la bibliothèque.
+ *
+ * @param plug Un pointeur vers la structure Plug.
+ */
+void plug_post_reload(Plug *plug) {
+    xml_set_allocator(&plug->memory.allocators[MEMORY_XML]);
+    layout_stack_forget(&plug->layouts);
+    if (plug->sim.resume_after_reload) sim_start(&plug->sim, plug);
+    plug->sim.resume_after_reload = false;
+}
@@ -6,6 +6,12 @@
 #include "raymath.h"
 #include "entity.h"
 #include "layout.h"
+#include "render.h"
+#include "sim.h"
+#include "hud.h"
+#include "saver.h"
+#include "catalog.h"
+#include "loader.h"
 #include "xml.h"
 
 /**
@@ -116,6 +122,46 @@ typedef struct {
     Key key;
 } Item;
 
+/**
+ * @struct Hud
+ * @brief Textes du HUD dont la mise en page est gardée en cache.
+ */
+typedef struct {
+    HudFont font;    /**< Police du HUD. */
+    HudText eraser;  /**< "eraser mode: on/off". */
+    HudText bricks;  /**< "brick count: N". */
+    HudText exit;    /**< "players exit: N/M". */
+    HudText sprites; /**< Sprites soumis et écartés. */
+    HudText page;    /**< Page courante de la sélection de niveau. */
+    HudText save;    /**< État de la dernière sauvegarde. */
+    HudText level;   /**< Métadonnées du niveau survolé dans la sélection de niveau. */
+    HudText open;    /**< Temps entre le clic sur un niveau et sa première frame jouable. */
+} Hud;
+
+/**
+ * @enum MemoryDomain
+ * @brief Sous-systèmes dont la mémoire est comptée et affichée par le HUD.
+ */
+typedef enum {
+    MEMORY_LAYOUTS,  /**< Pile des mises en page et noeuds retenus. */
+    MEMORY_ENTITIES, /**< Liste des joueurs. */
+    MEMORY_XML,      /**< Documents XML (arènes, tables d'internement, index des tags). */
+    MEMORY_COUNT,
+} MemoryDomain;
+
+/**
+ * @struct Memory
+ * @brief Allocateurs des sous-systèmes et leur affichage (touche F3).
+ *
+ * Les allocateurs vivent dans l'état du jeu, si bien que les tableaux qui les
+ * désignent restent valides après un rechargement de libplug.so.
+ */
+typedef struct {
+    ArrayAllocator allocators[MEMORY_COUNT]; /**< Allocateur de chaque sous-système. */
+    HudText texts[MEMORY_COUNT];             /**< Mise en page des textes. */
+    bool show;                               /**< L'affichage est activé. */
+} Memory;
+
 /**
  * @struct Plug
  * @brief Structure représentant l'état global du jeu Plug.
@@ -128,12 +174,16 @@ typedef struct Plug {
     bool eraser;
     Item item_selected;
     bool show;
-    Entity *players;
+    EntityMap players;
     GameState state;
     DialogState dialog;
-    Layout *layouts;
-    char **paths;
-    size_t level_selected;
+    LayoutStack layouts;
+    Catalog catalog;
+    Loader loader;
+    char *level_path;
+    double open_start;
+    bool open_prefetched;
+    double open_time;
     int goal;
     int score_players;
     int max_coins;
@@ -141,6 +191,15 @@ typedef struct Plug {
     int bricks;
     size_t page;
     bool window_should_close;
+    RenderBuffer render;
+    float accumulator;
+    float alpha;
+    Sim sim;
+    Hud hud;
+    Saver saver;
+    char save_message[128];
+    double save_message_time;
+    Memory memory;
 } Plug;
 
 // Définition de la liste des fonctions plug avec leurs signatures (X macro: https://en.wikipedia.org/wiki/X_macro).
@@ -149,7 +208,9 @@ typedef struct Plug {
     BASE_PLUG(void, plug_update, Plug *plug)				\
     BASE_PLUG(void, plug_render, Plug *plug, Texture2D background, Texture2D tileset, Texture2D player, Texture2D player_flop) \
     BASE_PLUG(void, plug_save, Plug *plug, char *file_path)	\
-    BASE_PLUG(void, plug_free, Plug *plug)
+    BASE_PLUG(void, plug_free, Plug *plug)				\
+    BASE_PLUG(void, plug_pre_reload, Plug *plug)			\
+    BASE_PLUG(void, plug_post_reload, Plug *plug)
 
 // définition de chaque fonction de plug comme un type de fonction avec le préfixe '_t'
 #define BASE_PLUG(return_type, name, ...) typedef return_type (name##_t)(__VA_ARGS__);
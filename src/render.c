@@ -0,0 +1,171 @@
+/* -*- compile-command: "make -C .. libplug" -*- */
+#include "render.h"
+#include <math.h>
+#include <stdlib.h>
+
+#include "array.h"
+
+void render_init(RenderBuffer *rb, RenderBackend backend) {
+    rb->backend = backend;
+    rb->commands = array_create_init(256, sizeof(RenderCommand));
+    rb->batches = array_create_init(16, sizeof(RenderBatch));
+    rb->recorded = array_create_init(256, sizeof(RenderCommand));
+    rb->stats = (RenderStats){0};
+    rb->shader = (Shader){0};
+}
+
+void render_begin(RenderBuffer *rb) {
+    array_clear(rb->commands);
+    array_clear(rb->recorded);
+    rb->stats = (RenderStats){0};
+    rb->shader = (Shader){0};
+}
+
+void render_set_shader(RenderBuffer *rb, Shader shader) {
+    rb->shader = shader;
+}
+
+void render_push(RenderBuffer *rb, RenderLayer layer, Texture2D texture, Rectangle source, Rectangle dest, Color tint) {
+    RenderCommand cmd = {
+	.texture = texture,
+	.shader = rb->shader,
+	.source = source,
+	.dest = dest,
+	.tint = tint,
+	.layer = layer,
+	.order = array_size(rb->commands),
+    };
+    array_push(rb->commands, cmd);
+}
+
+void render_push_rec(RenderBuffer *rb, RenderLayer layer, Texture2D texture, Rectangle source, Vector2 position, Color tint) {
+    Rectangle dest = {
+	.x = position.x,
+	.y = position.y,
+	.width = fabsf(source.width),
+	.height = fabsf(source.height),
+    };
+    render_push(rb, layer, texture, source, dest, tint);
+}
+
+static bool render_overlaps(Rectangle a, Rectangle b) {
+    return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+}
+
+static Rectangle render_union(Rectangle a, Rectangle b) {
+    float x0 = fminf(a.x, b.x);
+    float y0 = fminf(a.y, b.y);
+    float x1 = fmaxf(a.x + a.width, b.x + b.width);
+    float y1 = fmaxf(a.y + a.height, b.y + b.height);
+    return (Rectangle){x0, y0, x1 - x0, y1 - y0};
+}
+
+/**
+ * @brief Range une commande dans le lot le plus récent de sa couche qui a son shader et
+ * sa texture, si aucun lot créé depuis ne la recouvre ; sinon ouvre un nouveau lot.
+ */
+static void render_batch_command(RenderBuffer *rb, RenderCommand *cmd) {
+    for (size_t i = array_size(rb->batches); i-- > 0;) {
+	RenderBatch *batch = &rb->batches[i];
+	if (batch->layer != cmd->layer) continue;
+	if (batch->shader == cmd->shader.id && batch->texture == cmd->texture.id) {
+	    batch->bounds = render_union(batch->bounds, cmd->dest);
+	    cmd->batch = i;
+	    return;
+	}
+	// le sprite doit passer au-dessus de ce lot : il ne peut pas rejoindre un lot plus ancien
+	if (render_overlaps(batch->bounds, cmd->dest)) break;
+    }
+
+    RenderBatch batch = {
+	.layer = cmd->layer,
+	.shader = cmd->shader.id,
+	.texture = cmd->texture.id,
+	.bounds = cmd->dest,
+    };
+    cmd->batch = array_size(rb->batches);
+    array_push(rb->batches, batch);
+}
+
+static int render_command_cmp(const void *a, const void *b) {
+    const RenderCommand *ca = a;
+    const RenderCommand *cb = b;
+    if (ca->layer != cb->layer) return ca->layer < cb->layer ? -1 : 1;
+    if (ca->batch != cb->batch) return ca->batch < cb->batch ? -1 : 1;
+    if (ca->order != cb->order) return ca->order < cb->order ? -1 : 1;
+    return 0;
+}
+
+void render_flush(RenderBuffer *rb) {
+    size_t count = array_size(rb->commands);
+    rb->stats.flushes += 1;
+    if (count == 0) return;
+
+    array_clear(rb->batches);
+    for (size_t i = 0; i < count; i++) render_batch_command(rb, &rb->commands[i]);
+    qsort(rb->commands, count, sizeof(RenderCommand), render_command_cmp);
+
+    for (size_t i = 0; i < count; i++) {
+	RenderCommand *cmd = &rb->commands[i];
+
+	// Un nouveau lot commence à chaque changement de texture ou de shader.
+	bool shader_changed = i == 0 || cmd->shader.id != rb->commands[i - 1].shader.id;
+	if (shader_changed || cmd->texture.id != rb->commands[i - 1].texture.id) {
+	    rb->stats.batches += 1;
+	}
+
+	switch (rb->backend) {
+	case RENDER_BACKEND_RAYLIB:
+#ifndef RENDER_HEADLESS
+	    if (shader_changed) {
+		if (i > 0 && rb->commands[i - 1].shader.id != 0) EndShaderMode();
+		if (cmd->shader.id != 0) BeginShaderMode(cmd->shader);
+	    }
+	    DrawTexturePro(cmd->texture, cmd->source, cmd->dest, (Vector2){0, 0}, 0, cmd->tint);
+#endif // RENDER_HEADLESS
+	    break;
+	case RENDER_BACKEND_NULL:
+	    array_push(rb->recorded, *cmd);
+	    break;
+	default: break;
+	}
+    }
+
+#ifndef RENDER_HEADLESS
+    if (rb->backend == RENDER_BACKEND_RAYLIB && rb->commands[count - 1].shader.id != 0) EndShaderMode();
+#endif // RENDER_HEADLESS
+
+    rb->stats.commands += count;
+    array_clear(rb->commands);
+}
+
+#ifndef RENDER_HEADLESS
+Rectangle render_view_bounds(Camera2D camera) {
+    Vector2 corners[4] = {
+	GetScreenToWorld2D((Vector2){0, 0}, camera),
+	GetScreenToWorld2D((Vector2){GetScreenWidth(), 0}, camera),
+	GetScreenToWorld2D((Vector2){0, GetScreenHeight()}, camera),
+	GetScreenToWorld2D((Vector2){GetScreenWidth(), GetScreenHeight()}, camera),
+    };
+
+    Vector2 min = corners[0];
+    Vector2 max = corners[0];
+    for (size_t i = 1; i < 4; i++) {
+	min.x = fminf(min.x, corners[i].x);
+	min.y = fminf(min.y, corners[i].y);
+	max.x = fmaxf(max.x, corners[i].x);
+	max.y = fmaxf(max.y, corners[i].y);
+    }
+
+    return (Rectangle){min.x, min.y, max.x - min.x, max.y - min.y};
+}
+#endif // RENDER_HEADLESS
+
+void render_free(RenderBuffer *rb) {
+    array_free(rb->commands);
+    array_free(rb->batches);
+    array_free(rb->recorded);
+    rb->commands = NULL;
+    rb->batches = NULL;
+    rb->recorded = NULL;
+}
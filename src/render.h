@@ -0,0 +1,161 @@
+#ifndef RENDER_H_
+#define RENDER_H_
+
+#include <stddef.h>
+#include "raylib.h"
+
+/**
+ * @enum RenderLayer
+ * @brief Couches de rendu, dessinées dans l'ordre croissant.
+ */
+typedef enum {
+    LAYER_BACKGROUND, /**< Fond du niveau. */
+    LAYER_TILES,      /**< Blocs de la carte de tuiles. */
+    LAYER_ENTITIES,   /**< Joueurs et ennemis. */
+    LAYER_UI,         /**< Interface (boîte d'items, texte). */
+} RenderLayer;
+
+/**
+ * @enum RenderBackend
+ * @brief Destination des commandes de dessin lors de la soumission.
+ *
+ * Compilé avec RENDER_HEADLESS (outils comme bench, liés sans raylib), seul le
+ * backend NULL produit quelque chose et render_view_bounds n'est pas défini.
+ */
+typedef enum {
+    RENDER_BACKEND_RAYLIB, /**< Les commandes sont dessinées avec raylib. */
+    RENDER_BACKEND_NULL,   /**< Les commandes sont seulement enregistrées (sans GPU). */
+} RenderBackend;
+
+/**
+ * @struct RenderCommand
+ * @brief Une commande de dessin d'une portion de texture.
+ */
+typedef struct {
+    Texture2D texture; /**< Texture source (son id sert de clé de tri). */
+    Shader shader;     /**< Shader actif pour la commande (id 0 : shader par défaut). */
+    Rectangle source;  /**< Rectangle source dans la texture. */
+    Rectangle dest;    /**< Rectangle de destination à l'écran (ou dans le monde). */
+    Color tint;        /**< Teinte appliquée à la texture. */
+    RenderLayer layer; /**< Couche de la commande. */
+    size_t order;      /**< Ordre de soumission, pour garder un tri stable. */
+    size_t batch;      /**< Lot attribué par render_flush (indice dans `batches`). */
+} RenderCommand;
+
+/**
+ * @struct RenderBatch
+ * @brief Lot formé par render_flush : commandes d'une même couche, d'un même shader et d'une même texture.
+ */
+typedef struct {
+    RenderLayer layer;    /**< Couche des commandes du lot. */
+    unsigned int shader;  /**< Id du shader des commandes du lot. */
+    unsigned int texture; /**< Id de la texture des commandes du lot. */
+    Rectangle bounds;     /**< Rectangle englobant les destinations des commandes du lot. */
+} RenderBatch;
+
+/**
+ * @struct RenderStats
+ * @brief Statistiques de soumission de la frame courante.
+ */
+typedef struct {
+    size_t commands; /**< Nombre de commandes soumises. */
+    size_t batches;  /**< Nombre de lots (changements de texture ou de shader) soumis. */
+    size_t flushes;  /**< Nombre d'appels à render_flush. */
+    size_t culled;   /**< Nombre de sprites écartés car hors de la vue. */
+} RenderStats;
+
+/**
+ * @struct RenderBuffer
+ * @brief Tampon de commandes de dessin, regroupé par couche et par texture avant soumission.
+ */
+typedef struct {
+    RenderBackend backend;   /**< Backend utilisé lors de la soumission. */
+    RenderCommand *commands; /**< Tableau dynamique des commandes en attente. */
+    RenderBatch *batches;    /**< Tableau dynamique des lots de la dernière soumission. */
+    RenderCommand *recorded; /**< Commandes soumises pendant la frame, dans l'ordre trié (backend NULL seulement). */
+    Shader shader;           /**< Shader appliqué aux prochaines commandes (voir render_set_shader). */
+    RenderStats stats;       /**< Statistiques de la frame courante. */
+} RenderBuffer;
+
+/**
+ * @brief Initialise un tampon de commandes avec le backend spécifié.
+ *
+ * @param rb Pointeur vers le tampon à initialiser.
+ * @param backend Backend utilisé lors de la soumission.
+ */
+void render_init(RenderBuffer *rb, RenderBackend backend);
+
+/**
+ * @brief Commence une nouvelle frame en remettant les statistiques à zéro.
+ *
+ * @param rb Pointeur vers le tampon de commandes.
+ */
+void render_begin(RenderBuffer *rb);
+
+/**
+ * @brief Définit le shader appliqué aux commandes ajoutées ensuite.
+ *
+ * Un shader dont l'id vaut 0 rétablit le shader par défaut.
+ *
+ * @param rb Pointeur vers le tampon de commandes.
+ * @param shader Shader à appliquer.
+ */
+void render_set_shader(RenderBuffer *rb, Shader shader);
+
+/**
+ * @brief Ajoute une commande de dessin (équivalent de DrawTexturePro sans rotation).
+ *
+ * @param rb Pointeur vers le tampon de commandes.
+ * @param layer Couche de la commande.
+ * @param texture Texture source.
+ * @param source Rectangle source dans la texture.
+ * @param dest Rectangle de destination.
+ * @param tint Teinte appliquée.
+ */
+void render_push(RenderBuffer *rb, RenderLayer layer, Texture2D texture, Rectangle source, Rectangle dest, Color tint);
+
+/**
+ * @brief Ajoute une commande de dessin à une position (équivalent de DrawTextureRec).
+ *
+ * @param rb Pointeur vers le tampon de commandes.
+ * @param layer Couche de la commande.
+ * @param texture Texture source.
+ * @param source Rectangle source dans la texture.
+ * @param position Position du coin supérieur gauche.
+ * @param tint Teinte appliquée.
+ */
+void render_push_rec(RenderBuffer *rb, RenderLayer layer, Texture2D texture, Rectangle source, Vector2 position, Color tint);
+
+/**
+ * @brief Regroupe les commandes en attente par couche, puis en lots de même shader et
+ * de même texture, et les soumet au backend.
+ *
+ * Une commande rejoint un lot plus ancien de sa couche seulement si aucun lot plus
+ * récent ne la recouvre : deux sprites qui se chevauchent sont toujours dessinés dans
+ * leur ordre de soumission. Les commandes d'un même lot gardent cet ordre.
+ * Le tampon est vidé après la soumission. Avec le backend NULL, les commandes sont
+ * copiées dans `recorded` au lieu d'être dessinées.
+ *
+ * @param rb Pointeur vers le tampon de commandes.
+ */
+void render_flush(RenderBuffer *rb);
+
+/**
+ * @brief Calcule le rectangle du monde visible à travers une caméra 2D.
+ *
+ * Les quatre coins de l'écran sont projetés dans le monde avec GetScreenToWorld2D,
+ * ce qui prend en compte le zoom, le décalage et la rotation de la caméra.
+ *
+ * @param camera Caméra utilisée pour le rendu du monde.
+ * @return Rectangle englobant la zone visible, en coordonnées du monde.
+ */
+Rectangle render_view_bounds(Camera2D camera);
+
+/**
+ * @brief Libère la mémoire associée au tampon de commandes.
+ *
+ * @param rb Pointeur vers le tampon de commandes.
+ */
+void render_free(RenderBuffer *rb);
+
+#endif // RENDER_H_
@@ -0,0 +1,146 @@
+/* -*- compile-command: "make -C .. libplug" -*- */
+#include "saver.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "array.h"
+
+static double saver_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void *saver_thread(void *arg) {
+    Saver *saver = arg;
+
+    pthread_mutex_lock(&saver->mutex);
+    for (;;) {
+	while (deque_size(saver->pending) == 0 && !saver->stopping) {
+	    pthread_cond_wait(&saver->cond, &saver->mutex);
+	}
+	if (deque_size(saver->pending) == 0) break;
+
+	SaveJob job = deque_front(saver->pending);
+	deque_pop_front(saver->pending);
+
+	// La sérialisation et l'écriture se font sans tenir le verrou.
+	pthread_mutex_unlock(&saver->mutex);
+	double start = saver_time();
+	job.ok = level_save(&job.level, job.file_path);
+	job.seconds = saver_time() - start;
+	level_free(&job.level);
+	pthread_mutex_lock(&saver->mutex);
+
+	deque_push_back(saver->done, job);
+	saver->busy -= 1;
+    }
+    pthread_mutex_unlock(&saver->mutex);
+
+    return NULL;
+}
+
+void saver_init(Saver *saver) {
+    memset(saver, 0, sizeof(*saver));
+    pthread_mutex_init(&saver->mutex, NULL);
+    pthread_cond_init(&saver->cond, NULL);
+    saver->pending = deque_create_init(2, sizeof(SaveJob));
+    saver->done = deque_create_init(2, sizeof(SaveJob));
+}
+
+void saver_submit(Saver *saver, Level level, const char *file_path) {
+    SaveJob job = {
+	.level = level,
+	.file_path = strdup(file_path),
+    };
+
+    pthread_mutex_lock(&saver->mutex);
+
+    // Une sauvegarde pas encore commencée vers le même fichier est périmée.
+    bool replaced = false;
+    for (size_t i = 0; i < deque_size(saver->pending); i++) {
+	SaveJob *pending = &deque_at(saver->pending, i);
+	if (strcmp(pending->file_path, file_path) == 0) {
+	    level_free(&pending->level);
+	    free(pending->file_path);
+	    *pending = job;
+	    replaced = true;
+	    break;
+	}
+    }
+    if (!replaced) {
+	deque_push_back(saver->pending, job);
+	saver->busy += 1;
+    }
+
+    if (!saver->running) {
+	saver->stopping = false;
+	if (pthread_create(&saver->thread, NULL, saver_thread, saver) == 0) {
+	    saver->running = true;
+	} else {
+	    fprintf(stderr, "ERROR: Could not create the save thread, saving %s on this thread\n", file_path);
+	    deque_pop_back(saver->pending);
+	    saver->busy -= 1;
+	    pthread_mutex_unlock(&saver->mutex);
+
+	    double start = saver_time();
+	    job.ok = level_save(&job.level, job.file_path);
+	    job.seconds = saver_time() - start;
+	    level_free(&job.level);
+
+	    pthread_mutex_lock(&saver->mutex);
+	    deque_push_back(saver->done, job);
+	}
+    }
+
+    pthread_cond_signal(&saver->cond);
+    pthread_mutex_unlock(&saver->mutex);
+}
+
+bool saver_poll(Saver *saver, SaveResult *result) {
+    pthread_mutex_lock(&saver->mutex);
+    bool found = deque_size(saver->done) > 0;
+    if (found) {
+	SaveJob job = deque_front(saver->done);
+	deque_pop_front(saver->done);
+	*result = (SaveResult){
+	    .file_path = job.file_path,
+	    .ok = job.ok,
+	    .seconds = job.seconds,
+	};
+    }
+    pthread_mutex_unlock(&saver->mutex);
+    return found;
+}
+
+size_t saver_busy(Saver *saver) {
+    pthread_mutex_lock(&saver->mutex);
+    size_t busy = saver->busy;
+    pthread_mutex_unlock(&saver->mutex);
+    return busy;
+}
+
+void saver_stop(Saver *saver) {
+    pthread_mutex_lock(&saver->mutex);
+    bool running = saver->running;
+    saver->stopping = true;
+    pthread_cond_signal(&saver->cond);
+    pthread_mutex_unlock(&saver->mutex);
+
+    if (!running) return;
+    pthread_join(saver->thread, NULL);
+    saver->running = false;
+}
+
+void saver_free(Saver *saver) {
+    saver_stop(saver);
+    for (size_t i = 0; i < deque_size(saver->done); i++) {
+	free(deque_at(saver->done, i).file_path);
+    }
+    deque_free(saver->pending);
+    deque_free(saver->done);
+    pthread_mutex_destroy(&saver->mutex);
+    pthread_cond_destroy(&saver->cond);
+}
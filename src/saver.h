@@ -0,0 +1,101 @@
+#ifndef SAVER_H_
+#define SAVER_H_
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "level.h"
+
+/**
+ * @struct SaveJob
+ * @brief Sauvegarde demandée au thread d'écriture, puis son résultat.
+ */
+typedef struct {
+    Level level;     /**< Copie du niveau possédée par la sauvegarde. */
+    char *file_path; /**< Chemin du fichier (alloué avec malloc). */
+    bool ok;         /**< La sauvegarde a réussi (une fois terminée). */
+    double seconds;  /**< Durée de la sérialisation et de l'écriture (une fois terminée). */
+} SaveJob;
+
+/**
+ * @struct SaveResult
+ * @brief Sauvegarde terminée, rendue au thread principal par saver_poll.
+ */
+typedef struct {
+    char *file_path; /**< Chemin du fichier, à libérer avec free. */
+    bool ok;         /**< La sauvegarde a réussi. */
+    double seconds;  /**< Durée de la sérialisation et de l'écriture. */
+} SaveResult;
+
+/**
+ * @struct Saver
+ * @brief Thread d'écriture des niveaux, pour ne pas bloquer le rendu pendant une sauvegarde.
+ *
+ * Le thread est lancé à la première sauvegarde et s'arrête avec saver_stop, par
+ * exemple avant un hot-reload : il exécute du code de libplug.so. Les files
+ * `pending` et `done` sont protégées par `mutex`.
+ */
+typedef struct {
+    pthread_t thread;      /**< Thread d'écriture. */
+    pthread_mutex_t mutex; /**< Protège les champs suivants. */
+    pthread_cond_t cond;   /**< Signale une nouvelle sauvegarde ou l'arrêt. */
+    bool running;          /**< Le thread a été lancé et n'a pas été attendu. */
+    bool stopping;         /**< Le thread doit s'arrêter une fois `pending` vidé. */
+    size_t busy;           /**< Nombre de sauvegardes en attente ou en cours. */
+    SaveJob *pending;      /**< Sauvegardes en attente, dans l'ordre des demandes (Deque). */
+    SaveJob *done;         /**< Sauvegardes terminées, pas encore lues par saver_poll (Deque). */
+} Saver;
+
+/**
+ * @brief Initialise le thread d'écriture (il n'est pas lancé).
+ *
+ * @param saver Thread d'écriture.
+ */
+void saver_init(Saver *saver);
+
+/**
+ * @brief Confie une sauvegarde au thread d'écriture.
+ *
+ * Le niveau appartient ensuite au thread d'écriture. Une sauvegarde encore en
+ * attente vers le même fichier est remplacée par la nouvelle.
+ *
+ * @param saver Thread d'écriture.
+ * @param level Niveau à écrire (le format dépend de l'extension, voir level_save).
+ * @param file_path Chemin du fichier (copié).
+ */
+void saver_submit(Saver *saver, Level level, const char *file_path);
+
+/**
+ * @brief Récupère une sauvegarde terminée.
+ *
+ * @param saver Thread d'écriture.
+ * @param result Résultat à remplir.
+ * @return `false` si aucune sauvegarde n'est terminée, sinon `true`.
+ */
+bool saver_poll(Saver *saver, SaveResult *result);
+
+/**
+ * @brief Indique si des sauvegardes sont en attente ou en cours.
+ *
+ * @param saver Thread d'écriture.
+ * @return Le nombre de sauvegardes pas encore terminées.
+ */
+size_t saver_busy(Saver *saver);
+
+/**
+ * @brief Termine les sauvegardes en attente puis arrête le thread d'écriture.
+ *
+ * Les résultats restent disponibles pour saver_poll ; la prochaine sauvegarde relance le thread.
+ *
+ * @param saver Thread d'écriture.
+ */
+void saver_stop(Saver *saver);
+
+/**
+ * @brief Arrête le thread d'écriture et libère ses ressources.
+ *
+ * @param saver Thread d'écriture.
+ */
+void saver_free(Saver *saver);
+
+#endif // SAVER_H_
@@ -0,0 +1,210 @@
+/* -*- compile-command: "make -C .. libplug" -*- */
+#include "sim.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "plug.h"
+#include "array.h"
+
+#define SNAPSHOT_NEW 4u
+#define SNAPSHOT_INDEX 3u
+#define SIM_EVENT_MASK (SIM_EVENT_CAPACITY - 1)
+
+double sim_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void snapshot_init(Snapshot *snapshot) {
+    snapshot->tiles = array_create_init(TILESX * TILESY, sizeof(int));
+    array_resize(snapshot->tiles, TILESX * TILESY);
+    snapshot->entities = array_create_init(2, sizeof(SnapshotEntity));
+    snapshot->score_players = 0;
+    snapshot->coins = 0;
+    snapshot->bricks = 0;
+    snapshot->time = 0;
+}
+
+static void snapshot_free(Snapshot *snapshot) {
+    array_free(snapshot->tiles);
+    array_free(snapshot->entities);
+}
+
+void sim_capture(Snapshot *snapshot, Plug *plug) {
+    memcpy(snapshot->tiles, plug->tilemap, sizeof(plug->tilemap));
+
+    array_clear(snapshot->entities);
+    for (size_t i = 0; i < entity_map_size(&plug->players); i++) {
+	Entity *entity = &plug->players.entities[i];
+	SnapshotEntity e = {
+	    .handle = entity_map_handle(&plug->players, i),
+	    .previous = entity->previous,
+	    .rect = entity->rect,
+	    .state = entity->state,
+	};
+	array_push(snapshot->entities, e);
+    }
+
+    snapshot->score_players = plug->score_players;
+    snapshot->coins = plug->coins;
+    snapshot->bricks = plug->bricks;
+    snapshot->time = sim_time();
+}
+
+/**
+ * @brief Publie l'instantané `back` et récupère l'ancien instantané intermédiaire pour l'écriture suivante.
+ */
+static void sim_publish(Sim *sim) {
+    TripleBuffer *tb = &sim->snapshots;
+    sim_capture(&tb->slots[tb->back], sim->plug);
+    tb->back = __atomic_exchange_n(&tb->middle, tb->back | SNAPSHOT_NEW, __ATOMIC_ACQ_REL) & SNAPSHOT_INDEX;
+}
+
+const Snapshot *sim_acquire(Sim *sim) {
+    TripleBuffer *tb = &sim->snapshots;
+    if (__atomic_load_n(&tb->middle, __ATOMIC_ACQUIRE) & SNAPSHOT_NEW) {
+	tb->front = __atomic_exchange_n(&tb->middle, tb->front, __ATOMIC_ACQ_REL) & SNAPSHOT_INDEX;
+    }
+    return &tb->slots[tb->front];
+}
+
+float sim_alpha(const Snapshot *snapshot) {
+    float alpha = (sim_time() - snapshot->time) / SIM_DT;
+    if (alpha < 0.0f) return 0.0f;
+    if (alpha > 1.0f) return 1.0f;
+    return alpha;
+}
+
+bool sim_send(Sim *sim, SimEvent event) {
+    SimEventQueue *q = &sim->events;
+    size_t tail = __atomic_load_n(&q->tail, __ATOMIC_RELAXED);
+    size_t head = __atomic_load_n(&q->head, __ATOMIC_ACQUIRE);
+    if (tail - head >= SIM_EVENT_CAPACITY) return false;
+    q->events[tail & SIM_EVENT_MASK] = event;
+    __atomic_store_n(&q->tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+static bool sim_receive(Sim *sim, SimEvent *event) {
+    SimEventQueue *q = &sim->events;
+    size_t head = __atomic_load_n(&q->head, __ATOMIC_RELAXED);
+    size_t tail = __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE);
+    if (head == tail) return false;
+    *event = q->events[head & SIM_EVENT_MASK];
+    __atomic_store_n(&q->head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+/**
+ * @brief Applique un événement d'entrée à l'état du jeu (sur le thread de simulation).
+ */
+static void sim_apply(Sim *sim, SimEvent event) {
+    Plug *plug = sim->plug;
+    switch (event.type) {
+    case SIM_EVENT_ACTIVATE: {
+	// le joueur a pu sortir ou mourir depuis l'instantané
+	Entity *player = entity_map_get(&plug->players, event.entity);
+	if (player) player->state = MOVE_RIGHT;
+	break;
+    }
+    case SIM_EVENT_BRICK:
+	if (event.x < 0 || event.x >= TILESX || event.y < 0 || event.y >= TILESY) break;
+	if (plug->tilemap[event.y][event.x] == BLOCK_EMPTY && plug->bricks && !event.eraser) {
+	    plug->tilemap[event.y][event.x] = BLOCK_BRICK;
+	    plug->bricks--;
+	} else if (plug->tilemap[event.y][event.x] == BLOCK_BRICK && event.eraser) {
+	    plug->tilemap[event.y][event.x] = BLOCK_EMPTY;
+	    plug->bricks++;
+	}
+	break;
+    case SIM_EVENT_PAUSE:
+	sim->paused = true;
+	break;
+    case SIM_EVENT_RESUME:
+	sim->paused = false;
+	break;
+    default: break;
+    }
+}
+
+static void sim_sleep_until(double deadline) {
+    double remaining = deadline - sim_time();
+    if (remaining <= 0) return;
+    struct timespec ts = {
+	.tv_sec = (time_t)remaining,
+	.tv_nsec = (long)((remaining - (time_t)remaining) * 1e9),
+    };
+    nanosleep(&ts, NULL);
+}
+
+static void *sim_thread(void *arg) {
+    Sim *sim = arg;
+    double next = sim_time();
+
+    while (__atomic_load_n(&sim->running, __ATOMIC_ACQUIRE)) {
+	SimEvent event;
+	while (sim_receive(sim, &event)) sim_apply(sim, event);
+
+	// En pause, rien n'est publié : le dernier instantané reste affiché sans interpolation.
+	if (!sim->paused) {
+	    entity_update(sim->plug, SIM_DT);
+	    sim_publish(sim);
+	}
+
+	// Après un gros retard, repart de maintenant plutôt que d'enchaîner les pas.
+	next += SIM_DT;
+	if (sim_time() - next > SIM_MAX_FRAME_TIME) next = sim_time();
+	sim_sleep_until(next);
+    }
+
+    return NULL;
+}
+
+void sim_init(Sim *sim) {
+    memset(sim, 0, sizeof(*sim));
+    for (size_t i = 0; i < 3; i++) {
+	snapshot_init(&sim->snapshots.slots[i]);
+    }
+    snapshot_init(&sim->local);
+    sim->snapshots.front = 0;
+    sim->snapshots.middle = 1;
+    sim->snapshots.back = 2;
+}
+
+void sim_start(Sim *sim, Plug *plug) {
+    if (sim_running(sim)) return;
+
+    sim->plug = plug;
+    sim->paused = false;
+    sim->events.head = 0;
+    sim->events.tail = 0;
+
+    // Publie l'état initial pour que le rendu ne voie jamais un instantané périmé.
+    sim_publish(sim);
+
+    __atomic_store_n(&sim->running, true, __ATOMIC_RELEASE);
+    if (pthread_create(&sim->thread, NULL, sim_thread, sim) != 0) {
+	fprintf(stderr, "ERROR: Could not create the simulation thread\n");
+	__atomic_store_n(&sim->running, false, __ATOMIC_RELEASE);
+    }
+}
+
+void sim_stop(Sim *sim) {
+    if (!sim_running(sim)) return;
+    __atomic_store_n(&sim->running, false, __ATOMIC_RELEASE);
+    pthread_join(sim->thread, NULL);
+}
+
+bool sim_running(Sim *sim) {
+    return __atomic_load_n(&sim->running, __ATOMIC_ACQUIRE);
+}
+
+void sim_free(Sim *sim) {
+    sim_stop(sim);
+    for (size_t i = 0; i < 3; i++) {
+	snapshot_free(&sim->snapshots.slots[i]);
+    }
+    snapshot_free(&sim->local);
+}
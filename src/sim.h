@@ -0,0 +1,194 @@
+#ifndef SIM_H_
+#define SIM_H_
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "raylib.h"
+#include "entity.h"
+
+/**
+ * @def SIM_EVENT_CAPACITY
+ * @brief Nombre maximal d'événements en attente dans la file (puissance de deux).
+ */
+#define SIM_EVENT_CAPACITY 256
+
+/**
+ * @struct Plug
+ * @brief Représente la structure principale contenant des informations sur l'état du jeu.
+ */
+typedef struct Plug Plug;
+
+/**
+ * @enum SimEventType
+ * @brief Type d'un événement d'entrée envoyé du rendu vers la simulation.
+ */
+typedef enum {
+    SIM_EVENT_ACTIVATE, /**< Clic sur un joueur pour le mettre en mouvement (ignoré si le joueur n'existe plus). */
+    SIM_EVENT_BRICK,    /**< Pose ou retrait d'une brique sur une tuile. */
+    SIM_EVENT_PAUSE,    /**< Suspend les pas de simulation. */
+    SIM_EVENT_RESUME,   /**< Reprend les pas de simulation. */
+} SimEventType;
+
+/**
+ * @struct SimEvent
+ * @brief Événement d'entrée transmis au thread de simulation.
+ */
+typedef struct {
+    SimEventType type; /**< Type de l'événement. */
+    EntityHandle entity; /**< Joueur cliqué, pris dans un instantané (SIM_EVENT_ACTIVATE). */
+    int x;             /**< Colonne de la tuile (SIM_EVENT_BRICK). */
+    int y;             /**< Ligne de la tuile (SIM_EVENT_BRICK). */
+    bool eraser;       /**< Retire la brique au lieu de la poser (SIM_EVENT_BRICK). */
+} SimEvent;
+
+/**
+ * @struct SimEventQueue
+ * @brief File circulaire sans verrou à un producteur (rendu) et un consommateur (simulation).
+ */
+typedef struct {
+    SimEvent events[SIM_EVENT_CAPACITY]; /**< Stockage circulaire des événements. */
+    size_t head;                         /**< Prochain événement à lire (écrit par la simulation). */
+    size_t tail;                         /**< Prochain emplacement libre (écrit par le rendu). */
+} SimEventQueue;
+
+/**
+ * @struct SnapshotEntity
+ * @brief État d'une entité nécessaire au rendu.
+ */
+typedef struct {
+    EntityHandle handle; /**< Poignée de l'entité dans `plug->players`. */
+    Vector2 previous;    /**< Position au pas précédent. */
+    Rectangle rect;      /**< Rectangle de collision au pas courant. */
+    State state;         /**< État de déplacement de l'entité. */
+} SnapshotEntity;
+
+/**
+ * @struct Snapshot
+ * @brief Instantané immuable de la simulation publié pour le rendu.
+ */
+typedef struct {
+    int *tiles;               /**< Carte de tuiles, ligne par ligne (TILESX * TILESY). */
+    SnapshotEntity *entities; /**< Tableau dynamique des entités. */
+    int score_players;        /**< Nombre de joueurs arrivés à la sortie. */
+    int coins;                /**< Nombre de pièces ramassées. */
+    int bricks;               /**< Nombre de briques disponibles. */
+    double time;              /**< Instant de publication (voir sim_time). */
+} Snapshot;
+
+/**
+ * @struct TripleBuffer
+ * @brief Triple tampon sans verrou d'instantanés entre la simulation et le rendu.
+ *
+ * La simulation écrit dans `back`, le rendu lit `front`, et `middle` est échangé
+ * atomiquement entre les deux. Le bit SNAPSHOT_NEW de `middle` indique qu'un
+ * instantané plus récent que `front` est disponible.
+ */
+typedef struct {
+    Snapshot slots[3];   /**< Les trois instantanés. */
+    unsigned int middle; /**< Indice de l'instantané intermédiaire (accès atomique). */
+    unsigned int back;   /**< Indice possédé par la simulation. */
+    unsigned int front;  /**< Indice possédé par le rendu. */
+} TripleBuffer;
+
+/**
+ * @struct Sim
+ * @brief Thread de simulation des entités et ses canaux de communication avec le rendu.
+ */
+typedef struct {
+    pthread_t thread;         /**< Thread de simulation. */
+    bool running;             /**< Vrai tant que le thread tourne (accès atomique). */
+    bool paused;              /**< Pas de simulation suspendus (possédé par le thread). */
+    bool resume_after_reload; /**< Le thread doit être relancé après un hot-reload. */
+    Plug *plug;               /**< État du jeu possédé par le thread pendant qu'il tourne. */
+    TripleBuffer snapshots;   /**< Instantanés publiés pour le rendu. */
+    SimEventQueue events;     /**< File des événements d'entrée. */
+    Snapshot local;           /**< Instantané construit sur le thread principal quand le thread est arrêté. */
+} Sim;
+
+/**
+ * @brief Initialise la simulation (le thread n'est pas lancé).
+ *
+ * @param sim Pointeur vers la simulation.
+ */
+void sim_init(Sim *sim);
+
+/**
+ * @brief Lance le thread de simulation sur l'état du jeu.
+ *
+ * Un premier instantané est publié avant le lancement du thread. Tant que le thread
+ * tourne, le thread principal ne doit plus modifier la carte de tuiles, les joueurs
+ * ni les compteurs de `plug` : il passe par sim_send et lit les instantanés.
+ *
+ * @param sim Pointeur vers la simulation.
+ * @param plug État du jeu simulé.
+ */
+void sim_start(Sim *sim, Plug *plug);
+
+/**
+ * @brief Arrête le thread de simulation et attend sa fin.
+ *
+ * Après l'appel, le thread principal possède de nouveau l'état du jeu.
+ *
+ * @param sim Pointeur vers la simulation.
+ */
+void sim_stop(Sim *sim);
+
+/**
+ * @brief Indique si le thread de simulation tourne.
+ *
+ * @param sim Pointeur vers la simulation.
+ * @return `true` si le thread tourne, sinon `false`.
+ */
+bool sim_running(Sim *sim);
+
+/**
+ * @brief Envoie un événement d'entrée au thread de simulation.
+ *
+ * @param sim Pointeur vers la simulation.
+ * @param event Événement à envoyer.
+ * @return `false` si la file est pleine (l'événement est perdu), sinon `true`.
+ */
+bool sim_send(Sim *sim, SimEvent event);
+
+/**
+ * @brief Obtient le dernier instantané publié par le thread de simulation.
+ *
+ * L'instantané reste valide jusqu'au prochain appel de sim_acquire.
+ *
+ * @param sim Pointeur vers la simulation.
+ * @return Pointeur vers l'instantané le plus récent.
+ */
+const Snapshot *sim_acquire(Sim *sim);
+
+/**
+ * @brief Copie l'état du jeu dans un instantané.
+ *
+ * @param snapshot Instantané à remplir.
+ * @param plug État du jeu à copier.
+ */
+void sim_capture(Snapshot *snapshot, Plug *plug);
+
+/**
+ * @brief Calcule la fraction du pas de simulation écoulée depuis la publication d'un instantané.
+ *
+ * @param snapshot Instantané publié par le thread de simulation.
+ * @return Valeur entre 0 et 1 utilisée pour interpoler le rendu.
+ */
+float sim_alpha(const Snapshot *snapshot);
+
+/**
+ * @brief Donne le temps de l'horloge monotone utilisée par la simulation.
+ *
+ * @return Temps en secondes.
+ */
+double sim_time(void);
+
+/**
+ * @brief Libère les ressources de la simulation (arrête le thread s'il tourne).
+ *
+ * @param sim Pointeur vers la simulation.
+ */
+void sim_free(Sim *sim);
+
+#endif // SIM_H_
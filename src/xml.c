@@ -3,104 +3,421 @@
 #include <ctype.h>
 #include <dirent.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 #include "array.h"
 
-XMLNode* xml_node_new(XMLNode *parent) {
-    XMLNode *node = malloc(sizeof(XMLNode));
+// alignement des allocations de l'arène (celui des pointeurs et des size_t)
+#define XML_ARENA_ALIGN 8
+
+// taille initiale de la table d'internement (puissance de deux)
+#define XML_INTERN_CAPACITY 64
+
+#define FNV_OFFSET ((size_t)14695981039346656037ull)
+#define FNV_PRIME ((size_t)1099511628211ull)
+
+// allocateur des arènes créées ensuite (voir xml_set_allocator)
+static ArrayAllocator *xml_allocator = NULL;
+
+void xml_set_allocator(ArrayAllocator *allocator) {
+    xml_allocator = allocator;
+}
+
+XMLArena* xml_arena_new(void) {
+    XMLArena *arena = array_allocator_alloc(xml_allocator, sizeof(XMLArena));
+    if (!arena) {
+	fprintf(stderr, "ERROR: Could not allocate an arena: %s\n", strerror(errno));
+	exit(1);
+    }
+    memset(arena, 0, sizeof(*arena));
+    arena->allocator = xml_allocator;
+    return arena;
+}
+
+void* xml_arena_alloc(XMLArena *arena, size_t size) {
+    size = (size + XML_ARENA_ALIGN - 1) & ~(size_t)(XML_ARENA_ALIGN - 1);
+    XMLArenaBlock *block = arena->blocks;
+    if (!block || block->used + size > block->size) {
+	// une grosse allocation obtient son propre bloc
+	size_t block_size = size > XML_ARENA_BLOCK_SIZE ? size : XML_ARENA_BLOCK_SIZE;
+	block = array_allocator_alloc(arena->allocator, sizeof(XMLArenaBlock) + block_size);
+	if (!block) {
+	    fprintf(stderr, "ERROR: Could not allocate an arena block of %zu bytes: %s\n", block_size, strerror(errno));
+	    exit(1);
+	}
+	block->size = block_size;
+	block->used = 0;
+	block->next = arena->blocks;
+	arena->blocks = block;
+	arena->block_count++;
+    }
+
+    void *ptr = block->data + block->used;
+    block->used += size;
+    arena->allocations++;
+    arena->bytes += size;
+    return ptr;
+}
+
+static char* xml_arena_strndup(XMLArena *arena, const char *str, size_t len) {
+    char *copy = xml_arena_alloc(arena, len + 1);
+    memcpy(copy, str, len);
+    copy[len] = '\0';
+    return copy;
+}
+
+char* xml_arena_strdup(XMLArena *arena, const char *str) {
+    return xml_arena_strndup(arena, str, strlen(str));
+}
+
+static size_t xml_hash(const char *str, size_t len) {
+    size_t hash = FNV_OFFSET;
+    for (size_t i = 0; i < len; i++) hash = (hash ^ (unsigned char)str[i]) * FNV_PRIME;
+    return hash;
+}
+
+/**
+ * @brief Cherche la case d'une chaîne dans la table d'internement (sondage linéaire).
+ *
+ * @return La case de la chaîne, ou la case vide où l'insérer.
+ */
+static XMLInternEntry* xml_intern_slot(XMLArena *arena, const char *str, size_t len, size_t hash) {
+    size_t mask = arena->string_capacity - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+	XMLInternEntry *entry = &arena->strings[i];
+	if (!entry->str) return entry;
+	if (entry->hash == hash && strncmp(entry->str, str, len) == 0 && entry->str[len] == '\0') return entry;
+    }
+}
+
+/**
+ * @brief Cherche une chaîne déjà internée, sans l'ajouter.
+ */
+static XMLInternEntry* xml_intern_find(XMLArena *arena, const char *str) {
+    if (arena->string_count == 0) return NULL;
+    size_t len = strlen(str);
+    XMLInternEntry *entry = xml_intern_slot(arena, str, len, xml_hash(str, len));
+    return entry->str ? entry : NULL;
+}
+
+/**
+ * @brief Cherche ou ajoute les `len` premiers caractères de `str` dans la table d'internement.
+ */
+static XMLInternEntry* xml_intern_entry(XMLArena *arena, const char *str, size_t len) {
+    // la table est agrandie au-delà de 70 % de remplissage
+    if (10 * (arena->string_count + 1) > 7 * arena->string_capacity) {
+	XMLInternEntry *old = arena->strings;
+	size_t old_capacity = arena->string_capacity;
+	arena->string_capacity = old_capacity ? 2 * old_capacity : XML_INTERN_CAPACITY;
+	arena->strings = array_allocator_alloc(arena->allocator, arena->string_capacity * sizeof(XMLInternEntry));
+	if (!arena->strings) {
+	    fprintf(stderr, "ERROR: Could not allocate the string table: %s\n", strerror(errno));
+	    exit(1);
+	}
+	memset(arena->strings, 0, arena->string_capacity * sizeof(XMLInternEntry));
+	for (size_t i = 0; i < old_capacity; i++) {
+	    if (old[i].str) *xml_intern_slot(arena, old[i].str, strlen(old[i].str), old[i].hash) = old[i];
+	}
+	array_allocator_free(arena->allocator, old, old_capacity * sizeof(XMLInternEntry));
+    }
+
+    size_t hash = xml_hash(str, len);
+    XMLInternEntry *entry = xml_intern_slot(arena, str, len, hash);
+    if (!entry->str) {
+	entry->str = xml_arena_strndup(arena, str, len);
+	entry->hash = hash;
+	entry->nodes = NULL;
+	arena->string_count++;
+    }
+    return entry;
+}
+
+char* xml_intern(XMLArena *arena, const char *str) {
+    return xml_intern_entry(arena, str, strlen(str))->str;
+}
+
+void xml_arena_free(XMLArena *arena) {
+    if (!arena) return;
+    for (size_t i = 0; i < arena->string_capacity; i++) {
+	if (arena->strings[i].nodes) array_free(arena->strings[i].nodes);
+    }
+    array_allocator_free(arena->allocator, arena->strings, arena->string_capacity * sizeof(XMLInternEntry));
+    XMLArenaBlock *block = arena->blocks;
+    while (block) {
+	XMLArenaBlock *next = block->next;
+	array_allocator_free(arena->allocator, block, sizeof(XMLArenaBlock) + block->size);
+	block = next;
+    }
+    array_allocator_free(arena->allocator, arena, sizeof(XMLArena));
+}
+
+/**
+ * @brief Ajoute un élément à un tableau de array.h alloué dans l'arène.
+ *
+ * Quand le tableau est plein, un tableau deux fois plus grand est pris dans
+ * l'arène et l'ancien est simplement abandonné (il sera libéré avec l'arène,
+ * ou avec le nœud s'il s'agit de son stockage intégré).
+ */
+static void xml_arena_array_push(XMLArena *arena, void **array, const void *value, size_t type_size) {
+    Array *meta = *array ? array_meta(*array) : NULL;
+    if (!meta || meta->size == meta->capacity) {
+	size_t capacity = meta ? 2 * meta->capacity : 1;
+	// la place perdue à l'alignement de l'arène sert de capacité
+	size_t bytes = (sizeof(Array) + capacity * type_size + XML_ARENA_ALIGN - 1) & ~(size_t)(XML_ARENA_ALIGN - 1);
+	capacity = (bytes - sizeof(Array)) / type_size;
+	Array *grown = xml_arena_alloc(arena, bytes);
+	grown->size = meta ? meta->size : 0;
+	grown->capacity = capacity;
+	grown->allocator = NULL;
+	if (meta) memcpy(grown + 1, *array, meta->size * type_size);
+	meta = grown;
+	*array = grown + 1;
+    }
+    memcpy((char *)*array + meta->size * type_size, value, type_size);
+    meta->size++;
+}
+
+static XMLNode* xml_node_alloc(XMLArena *arena, XMLNode *parent) {
+    XMLNode *node = xml_arena_alloc(arena, sizeof(XMLNode));
     node->tag = NULL;
     node->inner_text = NULL;
     node->parent = parent;
-    node->attributes = array_create_init(2, sizeof(XMLAttribute));
-    node->children = array_create_init(2, sizeof(XMLNode*));
-    if (parent) array_push(parent->children, node);
+    node->arena = arena;
+    array_init_inline(node->attributes, node->attribute_storage);
+    node->children = NULL;
+    if (parent) xml_arena_array_push(arena, (void **)&parent->children, &node, sizeof(XMLNode*));
+    else if (!arena->root) arena->root = node;
+    arena->indexed = false;
     return node;
 }
 
-static void xml_node_free(XMLNode *node) {
-    if (node) {
-	for (size_t i = 0; i < array_size(node->children); i++) {
-	    xml_node_free(node->children[i]);
-	}
+XMLNode* xml_node_new(XMLNode *parent) {
+    assert(parent);
+    return xml_node_alloc(parent->arena, parent);
+}
 
-	for (size_t i = 0; i < array_size(node->attributes); i++) {
-	    if (node->attributes[i].key) free(node->attributes[i].key);
-	    if (node->attributes[i].value) free(node->attributes[i].value);
-	}
+/**
+ * @struct XMLViewParser
+ * @brief État de l'analyse : position courante et pile des nœuds ouverts.
+ *
+ * Les jetons sont repérés par leur position dans le tampon, sans copie. Les trois
+ * analyseurs (xml_load, xml_view_parse et xml_sax_feed, balise par balise) lisent
+ * la grammaire avec les mêmes fonctions xml_lex_*. Seul xml_view_parse utilise la
+ * pile (`open` et `last`) : xml_load remonte par les parents des nœuds.
+ */
+typedef struct {
+    const char *buf;  /**< Tampon analysé. */
+    size_t size;      /**< Taille du tampon. */
+    size_t i;         /**< Position courante. */
+    size_t *open;     /**< Pile des indices des nœuds ouverts. */
+    size_t *last;     /**< Dernier enfant de chaque nœud ouvert (même hauteur que `open`). */
+} XMLViewParser;
+
+static bool xml_view_is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static void xml_view_skip_space(XMLViewParser *p) {
+    while (p->i < p->size && xml_view_is_space(p->buf[p->i])) p->i++;
+}
+
+/**
+ * @brief Avance jusqu'à `c` (exclu), ou jusqu'à la fin du tampon.
+ */
+static void xml_view_skip_to(XMLViewParser *p, char c) {
+    const char *found = memchr(p->buf + p->i, c, p->size - p->i);
+    p->i = found ? (size_t)(found - p->buf) : p->size;
+}
 
-	if (node->tag) free(node->tag);
-	if (node->inner_text) free(node->inner_text);
-	array_free(node->children);
-	array_free(node->attributes);
-	free(node);
+/**
+ * @brief Saute une déclaration (<?xml ... ?>), un commentaire (<!-- ... -->) ou un <!...>.
+ *
+ * `p->i` pointe sur le '?' ou le '!' ; en sortie, il pointe après la fin de la balise.
+ * Un '>' à l'intérieur d'un commentaire ou d'une déclaration ne la termine pas.
+ * @return `false` si le document se termine avant la fin de la balise.
+ */
+static bool xml_view_skip_special(XMLViewParser *p) {
+    const char *end = ">";
+    if (p->buf[p->i] == '?') {
+	end = "?>";
+	p->i++;
+    } else if (p->size - p->i >= 3 && memcmp(p->buf + p->i, "!--", 3) == 0) {
+	end = "-->";
+	p->i += 3;
+    } else {
+	p->i++;
+    }
+
+    size_t start = p->i, n = strlen(end);
+    while (true) {
+	xml_view_skip_to(p, '>');
+	if (p->i >= p->size) return false;
+	p->i++;
+	if (p->i >= start + n && memcmp(p->buf + p->i - n, end, n) == 0) return true;
     }
 }
 
-static TagType parse_attrs(XMLNode *curr_node, char *buf, size_t *i, char *lex, size_t *lexi) {
-    XMLAttribute curr_attr = {0};
-    while (buf[*i] != '>') {
-	lex[(*lexi)++] = buf[(*i)++];
+/**
+ * @brief Lit un nom (tag ou clé d'attribut) jusqu'à un blanc, '=', '/' ou '>'.
+ */
+static XMLStr xml_view_name(XMLViewParser *p) {
+    size_t start = p->i;
+    while (p->i < p->size) {
+	char c = p->buf[p->i];
+	if (xml_view_is_space(c) || c == '=' || c == '/' || c == '>') break;
+	p->i++;
+    }
+    return (XMLStr){p->buf + start, p->i - start};
+}
 
-	// Tag name
-	if (buf[*i] == ' ' && !curr_node->tag) {
-	    lex[*lexi] = '\0';
-	    curr_node->tag = strdup(lex);
-	    *lexi = 0;
-	    (*i)++;
-	    continue;
-	}
+/**
+ * @enum XMLMarkup
+ * @brief Nature d'une balise lue par xml_lex_markup.
+ */
+typedef enum {
+    XML_MARKUP_ERROR, /**< Balise invalide ou tronquée (l'erreur est affichée). */
+    XML_MARKUP_SKIP,  /**< Déclaration ou commentaire, déjà sauté. */
+    XML_MARKUP_OPEN,  /**< Balise ouvrante : ses attributs sont lus ensuite avec xml_lex_attr. */
+    XML_MARKUP_CLOSE, /**< Balise fermante, lue jusqu'au '>' compris. */
+} XMLMarkup;
+
+/**
+ * @enum XMLLexAttr
+ * @brief Jeton lu par xml_lex_attr dans une balise ouvrante.
+ */
+typedef enum {
+    XML_ATTR_ERROR,  /**< Attribut invalide ou balise tronquée (l'erreur est affichée). */
+    XML_ATTR_VALUE,  /**< Un attribut (clé et valeur). */
+    XML_ATTR_START,  /**< Fin d'une balise de début ('>'). */
+    XML_ATTR_INLINE, /**< Fin d'une balise en ligne ('/>'). */
+} XMLLexAttr;
+
+/**
+ * @brief Lit le texte jusqu'à la prochaine balise (ou la fin), sans les blancs de début et de fin.
+ */
+static XMLStr xml_lex_text(XMLViewParser *p) {
+    size_t start = p->i;
+    xml_view_skip_to(p, '<');
+    size_t end = p->i;
+    while (start < end && xml_view_is_space(p->buf[start])) start++;
+    while (end > start && xml_view_is_space(p->buf[end - 1])) end--;
+    return (XMLStr){p->buf + start, end - start};
+}
+
+/**
+ * @brief Lit le début d'une balise, `p->i` pointant juste après son '<'.
+ *
+ * Les déclarations et les commentaires sont sautés en entier. Pour une balise
+ * ouvrante, seul le nom est lu : les attributs suivent avec xml_lex_attr.
+ *
+ * @param name Reçoit le nom d'une balise ouvrante ou fermante.
+ */
+static XMLMarkup xml_lex_markup(XMLViewParser *p, XMLStr *name) {
+    if (p->i >= p->size) {
+	fprintf(stderr, "ERROR: Unexpected end of document\n");
+	return XML_MARKUP_ERROR;
+    }
 
-	// ignore space
-	if (lex[*lexi-1] == ' ') {
-	    (*lexi)--;
+    // déclaration (<?xml ... ?>) et commentaires (<!-- ... -->) ignorés
+    char c = p->buf[p->i];
+    if (c == '?' || c == '!') {
+	if (!xml_view_skip_special(p)) {
+	    fprintf(stderr, "ERROR: Unexpected end of document inside a comment\n");
+	    return XML_MARKUP_ERROR;
 	}
+	return XML_MARKUP_SKIP;
+    }
 
-	// Attribute key
-	if (buf[*i] == '=') {
-	    lex[*lexi] = '\0';
-	    curr_attr.key = strdup(lex);
-	    *lexi = 0;
-	    continue;
+    // fin de nœud (</root>)
+    if (c == '/') {
+	p->i++;
+	*name = xml_view_name(p);
+	xml_view_skip_to(p, '>');
+	if (p->i >= p->size) {
+	    fprintf(stderr, "ERROR: Unterminated tag </%.*s>\n", (int)name->size, name->data);
+	    return XML_MARKUP_ERROR;
 	}
+	p->i++;
+	return XML_MARKUP_CLOSE;
+    }
 
-	// Attribute value
-	if (buf[*i] == '"') {
-	    if (!curr_attr.key) {
-		fprintf(stderr, "Value has no key\n");
-		return TAG_START;
-	    }
+    *name = xml_view_name(p);
+    if (name->size == 0) {
+	fprintf(stderr, "ERROR: Tag without a name\n");
+	return XML_MARKUP_ERROR;
+    }
+    return XML_MARKUP_OPEN;
+}
 
-	    *lexi = 0;
-	    (*i)++;
+/**
+ * @brief Lit l'attribut suivant d'une balise ouvrante, ou la fin de la balise ('>' ou '/>').
+ *
+ * @param tag Nom de la balise (messages d'erreur).
+ * @param key Reçoit la clé de l'attribut.
+ * @param value Reçoit la valeur de l'attribut, sans ses guillemets.
+ */
+static XMLLexAttr xml_lex_attr(XMLViewParser *p, XMLStr tag, XMLStr *key, XMLStr *value) {
+    xml_view_skip_space(p);
+    if (p->i >= p->size) {
+	fprintf(stderr, "ERROR: Unterminated tag <%.*s>\n", (int)tag.size, tag.data);
+	return XML_ATTR_ERROR;
+    }
 
-	    while (buf[*i] != '"') {
-		lex[(*lexi)++] = buf[(*i)++];
-	    }
-	    lex[*lexi] = '\0';
-	    curr_attr.value = strdup(lex);
-	    //curr_node->attributes
-	    array_push(curr_node->attributes, curr_attr);
-	    curr_attr.key = NULL;
-	    curr_attr.value = NULL;
-	    *lexi = 0;
-	    (*i)++;
-	    continue;
-	}
+    char c = p->buf[p->i];
+    if (c == '>') {
+	p->i++;
+	return XML_ATTR_START;
+    }
+    if (c == '/' && p->i + 1 < p->size && p->buf[p->i + 1] == '>') {
+	p->i += 2;
+	return XML_ATTR_INLINE;
+    }
 
-	// Inline node
-	if (buf[*i - 1] == '/' && buf[*i] == '>') {
-	    lex[*lexi - 1] = '\0';
-	    if (!curr_node->tag) curr_node->tag = strdup(lex);
-	    (*i)++;
-	    return TAG_INLINE;
-	}
+    *key = xml_view_name(p);
+    xml_view_skip_space(p);
+    if (key->size == 0 || p->i >= p->size || p->buf[p->i] != '=') {
+	fprintf(stderr, "ERROR: Value has no key in <%.*s>\n", (int)tag.size, tag.data);
+	return XML_ATTR_ERROR;
+    }
+    p->i++;
+    xml_view_skip_space(p);
+    if (p->i >= p->size || (p->buf[p->i] != '"' && p->buf[p->i] != '\'')) {
+	fprintf(stderr, "ERROR: Attribute %.*s has no quoted value\n", (int)key->size, key->data);
+	return XML_ATTR_ERROR;
     }
-    return TAG_START;
+
+    char quote = p->buf[p->i++];
+    size_t start = p->i;
+    xml_view_skip_to(p, quote);
+    if (p->i >= p->size) {
+	fprintf(stderr, "ERROR: Unterminated tag <%.*s>\n", (int)tag.size, tag.data);
+	return XML_ATTR_ERROR;
+    }
+    *value = (XMLStr){p->buf + start, p->i - start};
+    p->i++;
+    return XML_ATTR_VALUE;
+}
+
+/**
+ * @brief Reconnaît le `<root/>` que les anciennes versions écrivaient à la place de `</root>`.
+ *
+ * Un élément vide du nom de la racine, directement dans la racine, ferme la racine.
+ *
+ * @param in_root La balise est directement dans la racine.
+ * @param root Nom de la racine.
+ * @param name Nom de la balise en ligne.
+ */
+static bool xml_lex_legacy_end(bool in_root, XMLStr root, XMLStr name) {
+    return in_root && root.size == name.size && memcmp(root.data, name.data, name.size) == 0;
 }
 
 bool xml_load(XMLDocument* doc, const char *file_path) {
     bool result = true;
     char *buf = NULL;
+    doc->root = NULL;
+    doc->arena = NULL;
     FILE *file = fopen(file_path, "r");
     if (!file) {
 	fprintf(stderr, "ERROR: Could not fopen the file %s: %s\n", file_path, strerror(errno));
@@ -112,7 +429,7 @@ bool xml_load(XMLDocument* doc, const char *file_path) {
 	return_defer(false);
     }
 
-    int size = ftell(file);
+    long size = ftell(file);
     if (size == -1) {
 	fprintf(stderr, "ERROR: Could not ftell the file %s: %s", file_path, strerror(errno));
 	return_defer(false);
@@ -135,86 +452,84 @@ bool xml_load(XMLDocument* doc, const char *file_path) {
     }
     buf[size] = '\0';
 
-    // implementation de lecture
-    //doc->root = xml_node_new(NULL); // old version
-    doc->root = NULL;
-    char lex[1024];
-    size_t lexi = 0;
-    size_t i = 0;
-
-    //XMLNode *curr_node = doc->root; // old version
+    doc->arena = xml_arena_new();
+    XMLViewParser p = {.buf = buf, .size = size, .i = 0};
     XMLNode *curr_node = NULL;
-    while (buf[i] != '\0') {
-	if (buf[i] == '<') {
-	    lex[lexi] = '\0';
-
-	    // inner text
-	    if (lexi > 0) {
-		if (!curr_node) {
-		    fprintf(stderr, "Text outside of document\n");
-		    return_defer(false);
-		}
-
-		curr_node->inner_text = strdup(lex);
-		lexi = 0;
-	    }
-
-	    // end of node (</root>)
-	    if (buf[i + 1] == '/') {
-		i += 2;
-		while (buf[i] != '>') {
-		    lex[lexi++] = buf[i++];
-		}
-		lex[lexi] = '\0';
-		if (!curr_node) {
-		    fprintf(stderr, "Already at the root\n");
-		    return_defer(false);
-		}
-
-		if (strcmp(curr_node->tag, lex)) {
-		    fprintf(stderr, "Mismatched tags (%s != %s)\n", curr_node->tag, lex);
-		    return_defer(false);
-		}
-
-		curr_node = curr_node->parent;
-		lexi = 0;
-		i++;
-		continue;
+    while (p.i < p.size) {
+	XMLStr text = xml_lex_text(&p);
+	if (text.size) {
+	    if (!curr_node) {
+		fprintf(stderr, "ERROR: Text outside of document\n");
+		return_defer(false);
 	    }
+	    curr_node->inner_text = xml_arena_strndup(doc->arena, text.data, text.size);
+	}
+	if (p.i >= p.size) break;
+	p.i++;
 
-	    // set current_node
-	    //curr_node = xml_node_new(curr_node); // old version
-	    if (doc->root == NULL) {
-		curr_node = xml_node_new(NULL);
-		doc->root = curr_node;
-	    } else {
-		curr_node = xml_node_new(curr_node);
+	XMLStr tag;
+	XMLMarkup markup = xml_lex_markup(&p, &tag);
+	if (markup == XML_MARKUP_ERROR) return_defer(false);
+	if (markup == XML_MARKUP_SKIP) continue;
+	if (markup == XML_MARKUP_CLOSE) {
+	    if (!curr_node) {
+		fprintf(stderr, "ERROR: Already at the root\n");
+		return_defer(false);
 	    }
 
-	    // set tag name
-	    i++;
-	    if (parse_attrs(curr_node, buf, &i, lex, &lexi) == TAG_INLINE) {
-		curr_node = curr_node->parent;
-		lexi = 0;
-		i++;
-		continue;
+	    if (strncmp(curr_node->tag, tag.data, tag.size) != 0 || curr_node->tag[tag.size] != '\0') {
+		fprintf(stderr, "ERROR: Mismatched tags (%s != %.*s)\n", curr_node->tag, (int)tag.size, tag.data);
+		return_defer(false);
 	    }
+	    curr_node = curr_node->parent;
+	    continue;
+	}
 
-	    lex[lexi] = '\0';
-	    if (!curr_node->tag) curr_node->tag = strdup(lex);
+	if (!curr_node && doc->root) {
+	    // le document se termine une fois la racine fermée
+	    break;
+	}
 
-	    // Reset lexer
-	    lexi = 0;
-	    i++;
+	if (doc->root == NULL) {
+	    curr_node = xml_node_alloc(doc->arena, NULL);
+	    doc->root = curr_node;
 	} else {
-	    if (isspace(buf[i])) {
-		i++;
-	    } else {
-		lex[lexi++] = buf[i++];
+	    curr_node = xml_node_new(curr_node);
+	}
+	curr_node->tag = xml_intern_entry(doc->arena, tag.data, tag.size)->str;
+
+	// les clés sont internées et chaque valeur est copiée d'un bloc dans l'arène
+	XMLStr key, value;
+	XMLLexAttr token;
+	while ((token = xml_lex_attr(&p, tag, &key, &value)) == XML_ATTR_VALUE) {
+	    XMLAttribute attr = {
+		.key = xml_intern_entry(doc->arena, key.data, key.size)->str,
+		.value = xml_arena_strndup(doc->arena, value.data, value.size),
+	    };
+	    xml_arena_array_push(doc->arena, (void **)&curr_node->attributes, &attr, sizeof(XMLAttribute));
+	}
+	if (token == XML_ATTR_ERROR) return_defer(false);
+	if (token == XML_ATTR_INLINE) {
+	    XMLStr root = {doc->root->tag, strlen(doc->root->tag)};
+	    if (xml_lex_legacy_end(curr_node->parent == doc->root, root, tag)) {
+		array_pop_last(doc->root->children);
+		curr_node = NULL;
+		break;
 	    }
+	    curr_node = curr_node->parent;
 	}
     }
 
+    if (doc->root == NULL) {
+	fprintf(stderr, "ERROR: Empty document\n");
+	return_defer(false);
+    }
+
+    if (curr_node) {
+	fprintf(stderr, "ERROR: Unexpected end of document: <%s> is not closed\n", curr_node->tag);
+	return_defer(false);
+    }
+
  defer:
     if (file) fclose(file);
     if (buf != NULL) free(buf);
@@ -244,63 +559,77 @@ void xml_node_print(XMLNode *node, int height) {
     }
 }
 
-static void xml_node_out(FILE *file, XMLNode *node, int indent, int times) {
+/**
+ * @brief Ajoute `width` espaces, comme printf("%*s", width, " ") (au moins une espace).
+ */
+static void xml_out_indent(Buffer *out, int width) {
+    buffer_append_repeat(out, ' ', width > 1 ? width : 1);
+}
+
+static void xml_attrs_out(Buffer *out, XMLNode *node) {
+    for (size_t j = 0; j < array_size(node->attributes); j++) {
+	XMLAttribute attr = node->attributes[j];
+	if (!attr.value || !strcmp(attr.value, "")) {
+	    continue;
+	}
+	buffer_append_char(out, ' ');
+	buffer_append_cstr(out, attr.key);
+	buffer_append(out, "=\"", 2);
+	buffer_append_cstr(out, attr.value);
+	buffer_append_char(out, '"');
+    }
+}
+
+static void xml_node_out(Buffer *out, XMLNode *node, int indent, int times) {
     for (size_t i = 0; i < array_size(node->children); i++) {
 	XMLNode *child = node->children[i];
 
-	if (times > 0) fprintf(file, "%*s", indent * times, " ");
+	if (times > 0) xml_out_indent(out, indent * times);
 
-	fprintf(file, "<%s", child->tag);
-
-	for (size_t j = 0; j < array_size(child->attributes); j++) {
-	    XMLAttribute attr = child->attributes[j];
-	    if (!attr.value || !strcmp(attr.value, "")) {
-		continue;
-	    }
-	    fprintf(file, " %s=\"%s\"", attr.key, attr.value);
-	}
+	buffer_append_char(out, '<');
+	buffer_append_cstr(out, child->tag);
+	xml_attrs_out(out, child);
 
 	if (array_size(child->children) == 0 && !child->inner_text) {
-	    fprintf(file, "/>\n");
+	    buffer_append(out, "/>\n", 3);
 	} else {
-	    fprintf(file, ">");
+	    buffer_append_char(out, '>');
 	    if (array_size(child->children) == 0) {
-		fprintf(file, "\n%*s", indent * (times + 1), " ");
-		fprintf(file, "%s", child->inner_text);
-		fprintf(file, "\n%*s", indent * times, " ");
-		fprintf(file, "</%s>\n", child->tag);
+		buffer_append_char(out, '\n');
+		xml_out_indent(out, indent * (times + 1));
+		buffer_append_cstr(out, child->inner_text);
+		buffer_append_char(out, '\n');
+		xml_out_indent(out, indent * times);
 	    } else {
-		fprintf(file, "\n");
-		xml_node_out(file, child, indent, times + 1);
-		if (times > 0) fprintf(file, "%*s", indent * times, " ");
-		fprintf(file, "</%s>\n", child->tag);
+		buffer_append_char(out, '\n');
+		xml_node_out(out, child, indent, times + 1);
+		if (times > 0) xml_out_indent(out, indent * times);
 	    }
+	    buffer_append(out, "</", 2);
+	    buffer_append_cstr(out, child->tag);
+	    buffer_append(out, ">\n", 2);
 	}
     }
 }
 
-bool xml_doc_write(XMLDocument *doc, const char *file_path, int indent) {
-    bool result = true;
-    FILE *file = fopen(file_path, "w");
-    if (!file) {
-	fprintf(stderr, "ERROR: Could not fopen the file %s: %s\n", file_path, strerror(errno));
-	return_defer(false);
-    }
-
-    fprintf(file, "<%s", doc->root->tag);
-    for (size_t i = 0; i < array_size(doc->root->attributes); i++) {
-	XMLAttribute attr = doc->root->attributes[i];
-	if (!attr.value || !strcmp (attr.value, "")) {
-	    continue;
-	}
-	fprintf(file, " %s=\"%s\"", attr.key, attr.value);
-    }
-    fprintf(file, ">\n");
-    xml_node_out(file, doc->root, indent, 1);
-    fprintf(file, "<%s/>\n", doc->root->tag);
+void xml_doc_write_buffer(XMLDocument *doc, Buffer *out, int indent) {
+    buffer_append_char(out, '<');
+    buffer_append_cstr(out, doc->root->tag);
+    xml_attrs_out(out, doc->root);
+    buffer_append(out, ">\n", 2);
+    xml_node_out(out, doc->root, indent, 1);
+    buffer_append(out, "</", 2);
+    buffer_append_cstr(out, doc->root->tag);
+    buffer_append(out, ">\n", 2);
+}
 
- defer:
-    if (file) fclose(file);
+bool xml_doc_write(XMLDocument *doc, const char *file_path, int indent) {
+    // Le document est construit en mémoire puis écrit en un seul appel.
+    Buffer out;
+    buffer_init(&out, 4096);
+    xml_doc_write_buffer(doc, &out, indent);
+    bool result = buffer_write_file(&out, file_path);
+    buffer_free(&out);
     return result;
 }
 
@@ -308,63 +637,126 @@ bool xml_doc_write(XMLDocument *doc, const char *file_path, int indent) {
 //    //xml_node_print(doc->root->children[0], 0);
 //    xml_node_print(doc->root, 0);
 //}
-XMLNode* xml_node_find_tag(XMLNode *root, const char *tagname) {
-    if (strcmp(root->tag, tagname)) {
-	for (size_t i = 0; i < array_size(root->children); i++) {
-	    return xml_node_find_tag(root->children[i], tagname);
-	}
+/**
+ * @brief Reconstruit l'index des tags : les nœuds de chaque tag, dans l'ordre du document.
+ */
+static void xml_index_build(XMLArena *arena) {
+    for (size_t i = 0; i < arena->string_capacity; i++) {
+	array_clear(arena->strings[i].nodes);
     }
-    return root;
-}
-
-Array_XMLNode xml_node_find_tags(XMLNode *root, const char *tagname) {
-    Array_XMLNode stack = array_create_init(2, sizeof(XMLNode*));
-    Array_XMLNode nodes = array_create_init(2, sizeof(XMLNode*));
-
-    array_push(stack, root);
 
+    // parcours en profondeur préfixe : les enfants sont empilés à l'envers
+    Array_XMLNode stack = array_create_init(16, sizeof(XMLNode*));
+    Array_XMLNode preorder = array_create_init(16, sizeof(XMLNode*));
+    if (arena->root) array_push(stack, arena->root);
     while (array_size(stack)) {
 	XMLNode *node = array_last(stack);
 	array_pop_last(stack);
-	if (strcmp(node->tag, tagname) == 0) {
-	    array_push(nodes, node);
+	node->order = array_size(preorder);
+	array_push(preorder, node);
+	// un tag affecté à la main n'est pas forcément interné
+	if (node->tag) {
+	    XMLInternEntry *entry = xml_intern_entry(arena, node->tag, strlen(node->tag));
+	    node->tag = entry->str;
+	    if (!entry->nodes) entry->nodes = array_create_with(arena->allocator, 4, sizeof(XMLNode*));
+	    array_push(entry->nodes, node);
 	}
-	for (size_t i = 0; i < array_size(node->children); i++) {
-	    array_push(stack, node->children[i]);
+	for (size_t i = array_size(node->children); i > 0; i--) {
+	    array_push(stack, node->children[i - 1]);
 	}
     }
 
+    // Les descendants d'un nœud occupent les rangs [order, last] : en remontant
+    // l'ordre du document, le dernier enfant de chaque nœud est déjà traité.
+    for (size_t i = array_size(preorder); i > 0; i--) {
+	XMLNode *node = preorder[i - 1];
+	node->last = array_size(node->children) ? array_last(node->children)->last : node->order;
+    }
+
     array_free(stack);
-    return nodes;
+    array_free(preorder);
+    arena->indexed = true;
+}
+
+/**
+ * @brief Donne les nœuds d'un tag dans tout le document, ou NULL si aucun nœud ne le porte.
+ */
+static Array_XMLNode xml_index_lookup(XMLArena *arena, const char *tagname) {
+    if (!arena->indexed) xml_index_build(arena);
+    XMLInternEntry *entry = xml_intern_find(arena, tagname);
+    return entry ? entry->nodes : NULL;
+}
+
+/**
+ * @brief Position du premier nœud de rang au moins `order` dans une liste de l'index (recherche dichotomique).
+ */
+static size_t xml_index_lower_bound(Array_XMLNode nodes, size_t order) {
+    size_t lo = 0, hi = array_size(nodes);
+    while (lo < hi) {
+	size_t mid = lo + (hi - lo) / 2;
+	if (nodes[mid]->order < order) lo = mid + 1;
+	else hi = mid;
+    }
+    return lo;
+}
+
+XMLNode* xml_node_find_tag(XMLNode *root, const char *tagname) {
+    Array_XMLNode nodes = xml_index_lookup(root->arena, tagname);
+    size_t i = xml_index_lower_bound(nodes, root->order);
+    return i < array_size(nodes) && nodes[i]->order <= root->last ? nodes[i] : NULL;
+}
+
+Array_XMLNode xml_node_find_tags(XMLNode *root, const char *tagname) {
+    Array_XMLNode matches = array_create_init(2, sizeof(XMLNode*));
+    Array_XMLNode nodes = xml_index_lookup(root->arena, tagname);
+    // les nœuds du sous-arbre de root sont contigus dans la liste de l'index
+    for (size_t i = xml_index_lower_bound(nodes, root->order); i < array_size(nodes) && nodes[i]->order <= root->last; i++) {
+	array_push(matches, nodes[i]);
+    }
+    return matches;
 }
 
 void xml_doc_free(XMLDocument *doc) {
-    xml_node_free(doc->root);
+    xml_arena_free(doc->arena);
+    doc->arena = NULL;
+    doc->root = NULL;
 }
 
 XMLDocument xml_doc_init(const char *tagname) {
     XMLDocument result = {0};
-    result.root = xml_node_new(NULL);
-    result.root->tag = strdup(tagname);
+    result.arena = xml_arena_new();
+    result.root = xml_node_alloc(result.arena, NULL);
+    result.root->tag = xml_intern(result.arena, tagname);
     return result;
 }
 
-void xml_insert_node(XMLNode *parent, const char *tag, const char *inner_text) {
+XMLNode* xml_insert_node(XMLNode *parent, const char *tag, const char *inner_text) {
     XMLNode *node = xml_node_new(parent);
-    node->tag = strdup(tag);
-    if (inner_text != NULL) node->inner_text = strdup(inner_text);
+    node->tag = xml_intern(node->arena, tag);
+    if (inner_text != NULL) node->inner_text = xml_arena_strdup(node->arena, inner_text);
+    return node;
 }
 
 void xml_attrib_add(XMLNode *node, const char *key, const char *value) {
     XMLAttribute attr = {0};
-    attr.key = strdup(key);
-    attr.value = strdup(value);
-    array_push(node->attributes, attr);
+    attr.key = xml_intern(node->arena, key);
+    attr.value = xml_arena_strdup(node->arena, value);
+    xml_arena_array_push(node->arena, (void **)&node->attributes, &attr, sizeof(XMLAttribute));
 }
 
 char* xml_attrib_get_value(XMLNode *root, const char *key) {
     for (size_t i = 0; i < array_size(root->attributes); i++) {
-	if (strcmp(root->attributes[i].key, key) == 0) {
+	const char *attr = root->attributes[i].key;
+	if (attr == key || strcmp(attr, key) == 0) {
+	    return root->attributes[i].value;
+	}
+    }
+    return NULL;
+}
+
+char* xml_attrib_get_interned(XMLNode *root, const char *key) {
+    for (size_t i = 0; i < array_size(root->attributes); i++) {
+	if (root->attributes[i].key == key) {
 	    return root->attributes[i].value;
 	}
     }
@@ -403,3 +795,499 @@ char** xml_get_filepaths(const char *path) {
     if (dir != NULL) closedir(dir);
     return paths;
 }
+
+/**
+ * @brief Ajoute un nœud sous le nœud ouvert au sommet de la pile et le chaîne à ses frères.
+ *
+ * Ses attributs sont les derniers de `view->attributes`, à partir de `first_attr`.
+ */
+static size_t xml_view_add_node(XMLView *view, XMLViewParser *p, XMLStr tag, size_t first_attr) {
+    size_t index = array_size(view->nodes);
+    size_t depth = array_size(p->open);
+    XMLViewNode node = {
+	.tag = tag,
+	.inner_text = {p->buf, 0},
+	.parent = depth ? p->open[depth - 1] : XML_VIEW_NONE,
+	.first_child = XML_VIEW_NONE,
+	.next_sibling = XML_VIEW_NONE,
+	.first_attr = first_attr,
+	.attr_count = array_size(view->attributes) - first_attr,
+    };
+    array_push(view->nodes, node);
+
+    if (depth) {
+	size_t last = p->last[depth - 1];
+	if (last == XML_VIEW_NONE) view->nodes[node.parent].first_child = index;
+	else view->nodes[last].next_sibling = index;
+	p->last[depth - 1] = index;
+    }
+    return index;
+}
+
+bool xml_view_parse(XMLView *view, const char *data, size_t size) {
+    bool result = true;
+    XMLViewParser p = {.buf = data, .size = size, .i = 0};
+    // les piles ne quittent la pile d'appel que pour un document profond
+    ArrayInline(size_t, 16) open_storage, last_storage;
+    array_init_inline(p.open, open_storage);
+    array_init_inline(p.last, last_storage);
+    if (!view->nodes) view->nodes = array_create_init(64, sizeof(XMLViewNode));
+    if (!view->attributes) view->attributes = array_create_init(64, sizeof(XMLViewAttribute));
+    array_clear(view->nodes);
+    array_clear(view->attributes);
+
+    while (p.i < p.size) {
+	XMLStr text = xml_lex_text(&p);
+	if (text.size) {
+	    if (array_size(p.open) == 0) {
+		fprintf(stderr, "ERROR: Text outside of document\n");
+		return_defer(false);
+	    }
+	    view->nodes[array_last(p.open)].inner_text = text;
+	}
+	if (p.i >= p.size) break;
+	p.i++;
+
+	XMLStr tag;
+	XMLMarkup markup = xml_lex_markup(&p, &tag);
+	if (markup == XML_MARKUP_ERROR) return_defer(false);
+	if (markup == XML_MARKUP_SKIP) continue;
+	if (markup == XML_MARKUP_CLOSE) {
+	    if (array_size(p.open) == 0) {
+		fprintf(stderr, "ERROR: Already at the root\n");
+		return_defer(false);
+	    }
+
+	    XMLStr open = view->nodes[array_last(p.open)].tag;
+	    if (open.size != tag.size || memcmp(open.data, tag.data, tag.size)) {
+		fprintf(stderr, "ERROR: Mismatched tags (%.*s != %.*s)\n", (int)open.size, open.data, (int)tag.size, tag.data);
+		return_defer(false);
+	    }
+	    array_pop_last(p.open);
+	    array_pop_last(p.last);
+	    continue;
+	}
+
+	if (array_size(p.open) == 0 && array_size(view->nodes) > 0) {
+	    // le document se termine une fois la racine fermée
+	    break;
+	}
+
+	// les attributs sont lus avant d'ajouter le nœud, qui n'existe pas pour un <root/> final
+	size_t first_attr = array_size(view->attributes);
+	XMLViewAttribute attr;
+	XMLLexAttr token;
+	while ((token = xml_lex_attr(&p, tag, &attr.key, &attr.value)) == XML_ATTR_VALUE) {
+	    array_push(view->attributes, attr);
+	}
+	if (token == XML_ATTR_ERROR) return_defer(false);
+	if (token == XML_ATTR_INLINE && array_size(p.open) > 0
+	    && xml_lex_legacy_end(array_size(p.open) == 1, view->nodes[p.open[0]].tag, tag)) {
+	    array_resize(view->attributes, first_attr);
+	    array_pop_last(p.open);
+	    array_pop_last(p.last);
+	    break;
+	}
+
+	size_t node = xml_view_add_node(view, &p, tag, first_attr);
+	if (token == XML_ATTR_START) {
+	    array_push_inline(p.open, open_storage, node);
+	    array_push_inline(p.last, last_storage, XML_VIEW_NONE);
+	}
+    }
+
+    if (array_size(view->nodes) == 0) {
+	fprintf(stderr, "ERROR: Empty document\n");
+	return_defer(false);
+    }
+
+    if (array_size(p.open) > 0) {
+	XMLStr open = view->nodes[array_last(p.open)].tag;
+	fprintf(stderr, "ERROR: Unexpected end of document: <%.*s> is not closed\n", (int)open.size, open.data);
+	return_defer(false);
+    }
+
+ defer:
+    array_free_inline(p.open, open_storage);
+    array_free_inline(p.last, last_storage);
+    return result;
+}
+
+bool xml_view_load(XMLView *view, const char *file_path) {
+    bool result = true;
+    memset(view, 0, sizeof(*view));
+
+    int fd = open(file_path, O_RDONLY);
+    if (fd == -1) {
+	fprintf(stderr, "ERROR: Could not open the file %s: %s\n", file_path, strerror(errno));
+	return_defer(false);
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+	fprintf(stderr, "ERROR: Could not stat the file %s: %s\n", file_path, strerror(errno));
+	return_defer(false);
+    }
+
+    if (st.st_size == 0) {
+	fprintf(stderr, "ERROR: The file %s is empty\n", file_path);
+	return_defer(false);
+    }
+
+    void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+	fprintf(stderr, "ERROR: Could not mmap the file %s: %s\n", file_path, strerror(errno));
+	return_defer(false);
+    }
+    view->data = data;
+    view->size = st.st_size;
+
+    // le fichier est lu une seule fois, du début à la fin
+    madvise(view->data, view->size, MADV_SEQUENTIAL);
+
+    if (!xml_view_parse(view, view->data, view->size)) {
+	fprintf(stderr, "ERROR: Could not parse the file %s\n", file_path);
+	return_defer(false);
+    }
+
+ defer:
+    if (fd != -1) close(fd);
+    if (!result) xml_view_free(view);
+    return result;
+}
+
+void xml_view_free(XMLView *view) {
+    if (view->data) munmap(view->data, view->size);
+    if (view->nodes) array_free(view->nodes);
+    if (view->attributes) array_free(view->attributes);
+    memset(view, 0, sizeof(*view));
+}
+
+size_t xml_view_find_tag(const XMLView *view, size_t node, const char *tagname) {
+    if (node >= array_size(view->nodes)) return XML_VIEW_NONE;
+    if (xml_str_eq(view->nodes[node].tag, tagname)) return node;
+
+    for (size_t child = view->nodes[node].first_child; child != XML_VIEW_NONE; child = view->nodes[child].next_sibling) {
+	size_t found = xml_view_find_tag(view, child, tagname);
+	if (found != XML_VIEW_NONE) return found;
+    }
+    return XML_VIEW_NONE;
+}
+
+XMLStr xml_view_attrib(const XMLView *view, size_t node, const char *key) {
+    const XMLViewNode *n = &view->nodes[node];
+    for (size_t i = n->first_attr; i < n->first_attr + n->attr_count; i++) {
+	if (xml_str_eq(view->attributes[i].key, key)) return view->attributes[i].value;
+    }
+    return (XMLStr){NULL, 0};
+}
+
+bool xml_str_eq(XMLStr str, const char *cstr) {
+    size_t len = strlen(cstr);
+    return str.data && str.size == len && memcmp(str.data, cstr, len) == 0;
+}
+
+int xml_str_to_int(XMLStr str) {
+    size_t i = 0;
+    bool negative = false;
+    while (i < str.size && xml_view_is_space(str.data[i])) i++;
+    if (i < str.size && (str.data[i] == '-' || str.data[i] == '+')) negative = str.data[i++] == '-';
+
+    int value = 0;
+    while (i < str.size && isdigit((unsigned char)str.data[i])) {
+	value = value * 10 + (str.data[i++] - '0');
+    }
+    return negative ? -value : value;
+}
+
+void xml_sax_init(XMLSax *sax, XMLSaxHandler handler) {
+    sax->handler = handler;
+    array_init_inline(sax->markup, sax->markup_storage);
+    sax->in_markup = false;
+    sax->quote = 0;
+    array_init_inline(sax->names, sax->names_storage);
+    array_init_inline(sax->open, sax->open_storage);
+    array_init_inline(sax->opened, sax->opened_storage);
+    sax->failed = false;
+    sax->closed = false;
+    sax->cursor = (XMLPosition){1, 1};
+    sax->scanned = 0;
+}
+
+void xml_sax_free(XMLSax *sax) {
+    array_free_inline(sax->markup, sax->markup_storage);
+    array_free_inline(sax->names, sax->names_storage);
+    array_free_inline(sax->open, sax->open_storage);
+    array_free_inline(sax->opened, sax->opened_storage);
+}
+
+/**
+ * @brief Donne le nom de l'élément ouvert le plus profond (vide à la racine).
+ */
+static XMLStr xml_sax_current(XMLSax *sax) {
+    if (array_size(sax->open) == 0) return (XMLStr){"", 0};
+    const char *name = sax->names + array_last(sax->open);
+    return (XMLStr){name, strlen(name)};
+}
+
+static void xml_sax_close(XMLSax *sax) {
+    XMLStr tag = xml_sax_current(sax);
+    if (sax->handler.end) sax->handler.end(sax->handler.user, tag);
+    array_resize(sax->names, array_last(sax->open));
+    array_pop_last(sax->open);
+    array_pop_last(sax->opened);
+    if (array_size(sax->open) == 0) sax->closed = true;
+}
+
+static void xml_sax_text(XMLSax *sax, const char *data, size_t size) {
+    if (size == 0) return;
+    if (array_size(sax->open) == 0) {
+	for (size_t i = 0; i < size; i++) {
+	    if (!xml_view_is_space(data[i])) {
+		fprintf(stderr, "ERROR: Text outside of document\n");
+		sax->failed = true;
+		return;
+	    }
+	}
+	return;
+    }
+    if (sax->handler.text) sax->handler.text(sax->handler.user, xml_sax_current(sax), (XMLStr){data, size});
+}
+
+/**
+ * @brief Analyse une balise complète, du caractère qui suit son '<' jusqu'à son '>' compris.
+ *
+ * @param position Position du '<' de la balise dans le document.
+ */
+static void xml_sax_markup(XMLSax *sax, const char *data, size_t size, XMLPosition position) {
+    XMLViewParser p = {.buf = data, .size = size, .i = 0};
+    XMLStr name;
+    XMLMarkup markup = xml_lex_markup(&p, &name);
+    if (markup == XML_MARKUP_ERROR) {
+	sax->failed = true;
+	return;
+    }
+    if (markup == XML_MARKUP_SKIP) return;
+    if (markup == XML_MARKUP_CLOSE) {
+	XMLStr open = xml_sax_current(sax);
+	if (array_size(sax->open) == 0) {
+	    fprintf(stderr, "ERROR: Already at the root\n");
+	    sax->failed = true;
+	    return;
+	}
+	if (open.size != name.size || memcmp(open.data, name.data, name.size)) {
+	    fprintf(stderr, "ERROR: Mismatched tags (%.*s != %.*s)\n", (int)open.size, open.data, (int)name.size, name.data);
+	    sax->failed = true;
+	    return;
+	}
+	xml_sax_close(sax);
+	return;
+    }
+
+    // le '>' final est celui trouvé par xml_sax_markup_end : "/>" termine une balise en ligne
+    bool inline_tag = size >= 2 && data[size - 2] == '/';
+    if (inline_tag && xml_lex_legacy_end(array_size(sax->open) == 1, xml_sax_current(sax), name)) {
+	xml_sax_close(sax);
+	return;
+    }
+
+    array_push_inline(sax->open, sax->open_storage, array_size(sax->names));
+    array_push_inline(sax->opened, sax->opened_storage, position);
+    for (size_t i = 0; i < name.size; i++) array_push_inline(sax->names, sax->names_storage, name.data[i]);
+    array_push_inline(sax->names, sax->names_storage, '\0');
+    XMLStr tag = xml_sax_current(sax);
+    if (sax->handler.start) sax->handler.start(sax->handler.user, tag);
+
+    XMLStr key, value;
+    XMLLexAttr token;
+    while ((token = xml_lex_attr(&p, tag, &key, &value)) == XML_ATTR_VALUE) {
+	if (sax->handler.attribute) sax->handler.attribute(sax->handler.user, tag, key, value);
+    }
+    if (token == XML_ATTR_ERROR) {
+	sax->failed = true;
+	return;
+    }
+    if (token == XML_ATTR_INLINE) xml_sax_close(sax);
+}
+
+/**
+ * @brief Avance `cursor` jusqu'à l'octet `to` du morceau en cours, si les positions sont demandées.
+ *
+ * @return La position de l'octet `to`.
+ */
+static XMLPosition xml_sax_locate(XMLSax *sax, const char *data, size_t to) {
+    if (!sax->handler.position) return sax->cursor;
+    size_t i = sax->scanned;
+    while (i < to) {
+	const char *nl = memchr(data + i, '\n', to - i);
+	if (!nl) {
+	    sax->cursor.column += to - i;
+	    break;
+	}
+	sax->cursor.line++;
+	sax->cursor.column = 1;
+	i = nl - data + 1;
+    }
+    sax->scanned = to;
+    return sax->cursor;
+}
+
+static void xml_sax_report(XMLSax *sax, XMLPosition position) {
+    if (sax->handler.position) *sax->handler.position = position;
+}
+
+/**
+ * @brief Octet `k` de la balise en cours : d'abord les `seen` octets gardés dans `markup`,
+ * puis ceux du morceau `data`.
+ */
+static char xml_sax_markup_at(const XMLSax *sax, size_t seen, const char *data, size_t k) {
+    return k < seen ? sax->markup[k] : data[k - seen];
+}
+
+/**
+ * @brief Cherche le '>' qui termine la balise commencée avant `data[i]`.
+ *
+ * Si la balise a été coupée par le morceau précédent, son début est dans `markup`.
+ * Un '>' dans une valeur d'attribut entre guillemets, un commentaire (<!-- ... -->)
+ * ou une déclaration (<? ... ?>) ne la termine pas. Le guillemet ouvert est gardé
+ * dans `quote` pour le morceau suivant.
+ * @return L'indice du '>' dans `data`, ou `size` si la balise continue dans le morceau suivant.
+ */
+static size_t xml_sax_markup_end(XMLSax *sax, const char *data, size_t i, size_t size) {
+    size_t seen = sax->in_markup ? array_size(sax->markup) : 0;
+    if (seen == 0 && i == size) return size;
+    const char *rest = data + i;
+    char first = xml_sax_markup_at(sax, seen, rest, 0);
+    if (first != '?' && first != '!') {
+	for (size_t j = i; j < size; j++) {
+	    char c = data[j];
+	    if (sax->quote) {
+		if (c == sax->quote) sax->quote = 0;
+	    } else if (c == '"' || c == '\'') {
+		sax->quote = c;
+	    } else if (c == '>') {
+		return j;
+	    }
+	}
+	return size;
+    }
+
+    size_t j = i;
+    while (j < size) {
+	const char *gt = memchr(data + j, '>', size - j);
+	if (!gt) break;
+	j = gt - data;
+	size_t k = seen + (j - i); // position du '>' dans la balise
+	if (first == '?') {
+	    if (k >= 2 && xml_sax_markup_at(sax, seen, rest, k - 1) == '?') return j;
+	} else if (first == '!' && k >= 3 && xml_sax_markup_at(sax, seen, rest, 1) == '-'
+		   && xml_sax_markup_at(sax, seen, rest, 2) == '-') {
+	    if (k >= 5 && xml_sax_markup_at(sax, seen, rest, k - 1) == '-'
+		&& xml_sax_markup_at(sax, seen, rest, k - 2) == '-') return j;
+	} else {
+	    return j;
+	}
+	j++;
+    }
+    return size;
+}
+
+bool xml_sax_feed(XMLSax *sax, const char *data, size_t size) {
+    size_t i = 0;
+    sax->scanned = 0;
+    while (i < size && !sax->failed && !sax->closed) {
+	if (sax->in_markup) {
+	    // complète la balise coupée par le morceau précédent
+	    size_t end = xml_sax_markup_end(sax, data, i, size);
+	    size_t stop = end < size ? end + 1 : size; // '>' compris
+	    for (size_t j = i; j < stop; j++) array_push_inline(sax->markup, sax->markup_storage, data[j]);
+	    if (end == size) break;
+
+	    xml_sax_report(sax, sax->markup_position);
+	    xml_sax_markup(sax, sax->markup, array_size(sax->markup), sax->markup_position);
+	    array_clear(sax->markup);
+	    sax->in_markup = false;
+	    i = end + 1;
+	    continue;
+	}
+
+	// texte jusqu'à la prochaine balise, transmis sans copie
+	const char *lt = memchr(data + i, '<', size - i);
+	size_t end = lt ? (size_t)(lt - data) : size;
+	if (end > i) xml_sax_report(sax, xml_sax_locate(sax, data, i));
+	xml_sax_text(sax, data + i, end - i);
+	if (!lt) break;
+	XMLPosition position = xml_sax_locate(sax, data, end);
+	i = end + 1;
+
+	size_t gt = xml_sax_markup_end(sax, data, i, size);
+	if (gt == size) {
+	    // balise coupée : on garde son début pour le prochain morceau, sans le relire
+	    // (le guillemet ouvert est déjà dans `quote`)
+	    for (size_t j = i; j < size; j++) array_push_inline(sax->markup, sax->markup_storage, data[j]);
+	    sax->in_markup = true;
+	    sax->markup_position = position;
+	    break;
+	}
+	xml_sax_report(sax, position);
+	xml_sax_markup(sax, data + i, gt + 1 - i, position);
+	i = gt + 1;
+    }
+    // le morceau suivant reprend là où celui-ci s'arrête
+    xml_sax_locate(sax, data, size);
+    return !sax->failed;
+}
+
+bool xml_sax_finish(XMLSax *sax) {
+    if (sax->failed) return false;
+    if (sax->in_markup) {
+	xml_sax_report(sax, sax->markup_position);
+	fprintf(stderr, "ERROR: Unexpected end of document inside a tag\n");
+	sax->failed = true;
+	return false;
+    }
+    if (array_size(sax->open)) {
+	XMLStr tag = xml_sax_current(sax);
+	XMLPosition position = array_last(sax->opened);
+	xml_sax_report(sax, position);
+	if (sax->handler.position) {
+	    fprintf(stderr, "ERROR: Unexpected end of document: <%.*s> opened at %zu:%zu is not closed\n",
+		    (int)tag.size, tag.data, position.line, position.column);
+	} else {
+	    fprintf(stderr, "ERROR: Unexpected end of document: <%.*s> is not closed\n", (int)tag.size, tag.data);
+	}
+	sax->failed = true;
+	return false;
+    }
+    return true;
+}
+
+bool xml_sax_parse_file(const char *file_path, XMLSaxHandler handler) {
+    bool result = true;
+    XMLSax sax;
+    xml_sax_init(&sax, handler);
+
+    FILE *file = fopen(file_path, "r");
+    if (!file) {
+	fprintf(stderr, "ERROR: Could not fopen the file %s: %s\n", file_path, strerror(errno));
+	return_defer(false);
+    }
+
+    char chunk[XML_SAX_CHUNK_SIZE];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+	if (!xml_sax_feed(&sax, chunk, n)) return_defer(false);
+    }
+
+    if (ferror(file)) {
+	fprintf(stderr, "ERROR: Could not fread the file %s: %s\n", file_path, strerror(errno));
+	return_defer(false);
+    }
+
+    if (!xml_sax_finish(&sax)) return_defer(false);
+
+ defer:
+    if (file) fclose(file);
+    xml_sax_free(&sax);
+    return result;
+}
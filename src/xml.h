@@ -6,6 +6,8 @@
 #include <string.h>
 #include <stdbool.h>
 #include <errno.h>
+#include "buffer.h"
+#include "array.h"
 
 /**
  * @def return_defer(value)
@@ -26,34 +28,111 @@ typedef enum {
     TAG_INLINE, /**< Balise en ligne. */
 } TagType;
 
+/**
+ * @def XML_ARENA_BLOCK_SIZE
+ * @brief Taille par défaut d'un bloc de l'arène d'un document XML.
+ */
+#define XML_ARENA_BLOCK_SIZE (64 * 1024)
+
+/**
+ * @struct XMLArenaBlock
+ * @brief Bloc mémoire d'une arène, chaîné au bloc précédent.
+ */
+typedef struct XMLArenaBlock XMLArenaBlock;
+struct XMLArenaBlock {
+    XMLArenaBlock *next; /**< Bloc alloué avant celui-ci. */
+    size_t size;         /**< Capacité de `data` en octets. */
+    size_t used;         /**< Octets déjà distribués. */
+    char data[];         /**< Mémoire distribuée par l'arène. */
+};
+
+/**
+ * @struct XMLInternEntry
+ * @brief Chaîne internée d'un document, avec les nœuds qui la portent comme tag.
+ */
+typedef struct {
+    char *str;              /**< Chaîne internée (dans l'arène), ou NULL pour une case vide. */
+    size_t hash;            /**< Empreinte FNV-1a de la chaîne. */
+    struct XMLNode **nodes; /**< Index des tags : nœuds de ce tag dans l'ordre du document (tableau dynamique). */
+} XMLInternEntry;
+
+/**
+ * @struct XMLArena
+ * @brief Allocateur par incrément d'un document XML : tout est libéré en une fois.
+ *
+ * L'arène porte aussi ce que les nœuds d'un document partagent : la table des
+ * tags et des clés d'attributs internés, qui rend leurs comparaisons égales à
+ * une comparaison de pointeurs, et l'index des tags construit à la première
+ * recherche (voir xml_node_find_tags).
+ */
+typedef struct {
+    XMLArenaBlock *blocks;   /**< Bloc courant (tête de la liste). */
+    size_t allocations;      /**< Nombre d'allocations servies par l'arène. */
+    size_t block_count;      /**< Nombre de blocs obtenus de l'allocateur. */
+    size_t bytes;            /**< Octets distribués (alignement compris). */
+    XMLInternEntry *strings; /**< Table d'internement à adressage ouvert (allocateur de l'arène). */
+    size_t string_capacity;  /**< Nombre de cases de `strings` (puissance de deux). */
+    size_t string_count;     /**< Nombre de chaînes internées. */
+    struct XMLNode *root;    /**< Racine du document, point de départ de l'index des tags. */
+    bool indexed;            /**< L'index des tags est à jour (remis à faux à chaque nouveau nœud). */
+    ArrayAllocator *allocator; /**< Allocateur des blocs, de la table et de l'index (NULL pour malloc). */
+} XMLArena;
+
+/**
+ * @def XML_SAX_CHUNK_SIZE
+ * @brief Taille des morceaux lus par xml_sax_parse_file.
+ */
+#define XML_SAX_CHUNK_SIZE (16 * 1024)
+
 /**
  * @struct XMLAttribute
  * @brief Représente un attribut XML avec une clé et une valeur.
  */
 typedef struct {
-    char *key;   /**< Clé de l'attribut. */
+    char *key;   /**< Clé de l'attribut (internée, voir xml_intern). */
     char *value; /**< Valeur de l'attribut. */
 } XMLAttribute;
 
+/**
+ * @def XML_NODE_INLINE_ATTRIBUTES
+ * @brief Nombre d'attributs rangés dans le nœud lui-même, avant de passer dans l'arène.
+ */
+#define XML_NODE_INLINE_ATTRIBUTES 2
+
 /**
  * @struct XMLNode
  * @brief Représente un nœud XML avec un tag, du texte interne, des attributs, et des enfants.
+ *
+ * Les premiers attributs sont rangés dans le nœud (voir ArrayInline) : un nœud
+ * avec un ou deux attributs ne demande qu'une allocation. Les enfants restent
+ * dans l'arène, la plupart des nœuds étant des feuilles.
  */
 typedef struct XMLNode XMLNode;
 struct XMLNode {
-    char *tag;                /**< Tag du nœud. */
-    char *inner_text;         /**< Texte interne du nœud. */
+    char *tag;                /**< Tag du nœud (interné, voir xml_intern). */
+    char *inner_text;         /**< Texte interne du nœud, sans les blancs de début et de fin. */
     XMLNode *parent;          /**< Parent du nœud. */
-    XMLAttribute *attributes; /**< Tableau d'attributs du nœud. */
-    XMLNode **children;       /**< Tableau des enfants du nœud. */
+    XMLArena *arena;          /**< Arène du document, qui possède le nœud et ses chaînes. */
+    size_t order;             /**< Rang du nœud dans l'ordre du document (valide quand l'index des tags est à jour). */
+    size_t last;              /**< Rang du dernier descendant du nœud (lui-même s'il n'a pas d'enfant). */
+    XMLAttribute *attributes; /**< Tableau d'attributs du nœud (dans `attribute_storage`, puis dans l'arène). */
+    XMLNode **children;       /**< Tableau des enfants du nœud (dans l'arène, NULL si vide). */
+    ArrayInline(XMLAttribute, XML_NODE_INLINE_ATTRIBUTES) attribute_storage; /**< Premiers attributs. */
 };
 
 /**
  * @struct XMLDocument
  * @brief Représente un document XML avec un nœud racine.
+ *
+ * Les nœuds, leurs tableaux d'attributs et d'enfants ainsi que toutes les chaînes
+ * sont alloués dans l'arène du document (les premiers attributs restent dans le
+ * nœud). Les tableaux `attributes` et `children`
+ * se lisent avec les macros de array.h mais ne doivent être ni agrandis avec
+ * array_push ni libérés avec array_free.
  */
 typedef struct {
-    XMLNode *root;  /**< Racine du document XML. */
+    XMLNode *root;   /**< Racine du document XML. */
+    XMLArena *arena; /**< Arène qui possède tout le document. */
 } XMLDocument;
 
 /**
@@ -68,10 +147,190 @@ typedef XMLNode** Array_XMLNode;
  */
 typedef XMLAttribute* Array_XMLAttribute;
 
+/**
+ * @def XML_VIEW_NONE
+ * @brief Indice invalide d'un nœud de vue (absence de parent, d'enfant ou de frère).
+ */
+#define XML_VIEW_NONE ((size_t)-1)
+
+/**
+ * @struct XMLStr
+ * @brief Vue sur une chaîne (pointeur et longueur), sans zéro final.
+ */
+typedef struct {
+    const char *data; /**< Début de la chaîne. */
+    size_t size;      /**< Longueur de la chaîne en octets. */
+} XMLStr;
+
+/**
+ * @struct XMLViewAttribute
+ * @brief Attribut d'un nœud de vue, dont la clé et la valeur pointent dans le fichier projeté.
+ */
+typedef struct {
+    XMLStr key;   /**< Clé de l'attribut. */
+    XMLStr value; /**< Valeur de l'attribut (sans les guillemets). */
+} XMLViewAttribute;
+
+/**
+ * @struct XMLViewNode
+ * @brief Nœud d'un document XML en vue. Les liens sont des indices dans `XMLView.nodes`.
+ */
+typedef struct {
+    XMLStr tag;          /**< Tag du nœud. */
+    XMLStr inner_text;   /**< Texte interne, sans les blancs de début et de fin. */
+    size_t parent;       /**< Indice du parent, ou XML_VIEW_NONE pour la racine. */
+    size_t first_child;  /**< Indice du premier enfant, ou XML_VIEW_NONE. */
+    size_t next_sibling; /**< Indice du frère suivant, ou XML_VIEW_NONE. */
+    size_t first_attr;   /**< Indice du premier attribut dans `XMLView.attributes`. */
+    size_t attr_count;   /**< Nombre d'attributs du nœud. */
+} XMLViewNode;
+
+/**
+ * @struct XMLView
+ * @brief Document XML analysé sur place dans un fichier projeté en mémoire (mmap).
+ *
+ * Aucun tag, attribut ou texte n'est copié : ce sont des vues dans `data`,
+ * valides jusqu'à xml_view_free. Les nœuds et attributs sont stockés dans deux
+ * tableaux plats, le nœud d'indice 0 étant la racine.
+ */
+typedef struct {
+    char *data;                   /**< Contenu du fichier projeté en mémoire. */
+    size_t size;                  /**< Taille du fichier en octets. */
+    XMLViewNode *nodes;           /**< Tableau dynamique des nœuds, dans l'ordre du document. */
+    XMLViewAttribute *attributes; /**< Tableau dynamique des attributs de tous les nœuds. */
+} XMLView;
+
+/**
+ * @struct XMLPosition
+ * @brief Position dans un document, ligne et colonne comptées à partir de 1.
+ */
+typedef struct {
+    size_t line;   /**< Ligne. */
+    size_t column; /**< Colonne, en octets depuis le début de la ligne. */
+} XMLPosition;
+
+/**
+ * @struct XMLSaxHandler
+ * @brief Fonctions appelées au fil de l'analyse en flux (SAX). Chacune peut être NULL.
+ *
+ * Les vues passées aux fonctions ne sont valides que pendant l'appel.
+ */
+typedef struct {
+    void *user;                                                          /**< Donnée passée en premier argument de chaque fonction. */
+    void (*start)(void *user, XMLStr tag);                               /**< Balise ouvrante (ou en ligne). */
+    void (*attribute)(void *user, XMLStr tag, XMLStr key, XMLStr value); /**< Attribut de la dernière balise ouvrante. */
+    void (*text)(void *user, XMLStr tag, XMLStr text);                   /**< Morceau du texte interne de `tag`, blancs compris. */
+    void (*end)(void *user, XMLStr tag);                                 /**< Balise fermante (aussi appelée pour une balise en ligne). */
+    XMLPosition *position;                                               /**< Si non NULL, reçoit avant chaque appel la position de la balise ou du texte. */
+} XMLSaxHandler;
+
+/**
+ * @def XML_SAX_INLINE_MARKUP
+ * @brief Taille d'une balise coupée gardée dans l'analyseur lui-même, avant de passer sur le tas.
+ */
+#define XML_SAX_INLINE_MARKUP 128
+
+/**
+ * @def XML_SAX_INLINE_DEPTH
+ * @brief Profondeur gardée dans l'analyseur lui-même (noms des éléments ouverts compris).
+ */
+#define XML_SAX_INLINE_DEPTH 8
+
+/**
+ * @struct XMLSax
+ * @brief Analyseur XML en flux, alimenté morceau par morceau.
+ *
+ * Le texte est transmis directement depuis les morceaux, éventuellement en
+ * plusieurs fois. Seule une balise coupée entre deux morceaux est recopiée
+ * dans `markup`, si bien que la mémoire utilisée ne dépend que de la taille
+ * des balises et de la profondeur du document. Tant que celles-ci restent
+ * petites, les tableaux restent dans la structure (voir ArrayInline) : elle ne
+ * doit pas être déplacée entre xml_sax_init et xml_sax_free.
+ *
+ * Comme pour xml_load, la suite du document est ignorée une fois la racine
+ * fermée. Un élément vide du nom de la racine, directement dans la racine,
+ * ferme aussi la racine : c'est le `<root/>` que les anciennes versions
+ * écrivaient à la place de `</root>`.
+ */
+typedef struct {
+    XMLSaxHandler handler; /**< Fonctions appelées pendant l'analyse. */
+    char *markup;          /**< Tableau dynamique : début d'une balise coupée par la fin d'un morceau. */
+    bool in_markup;        /**< Le morceau précédent s'est terminé au milieu d'une balise. */
+    char quote;            /**< Guillemet de la valeur d'attribut où la balise coupée s'est arrêtée, 0 sinon. */
+    char *names;           /**< Tableau dynamique : noms des éléments ouverts, terminés par zéro. */
+    size_t *open;          /**< Tableau dynamique : position de chaque élément ouvert dans `names`. */
+    XMLPosition *opened;   /**< Tableau dynamique : position dans le document de chaque élément ouvert (si `handler.position`). */
+    bool failed;           /**< Une erreur a interrompu l'analyse. */
+    bool closed;           /**< La racine est fermée : la suite du document est ignorée. */
+    XMLPosition cursor;    /**< Position de l'octet `scanned` du morceau en cours (si `handler.position`). */
+    size_t scanned;        /**< Octets du morceau en cours déjà comptés dans `cursor`. */
+    XMLPosition markup_position; /**< Position du début de la balise coupée. */
+    ArrayInline(char, XML_SAX_INLINE_MARKUP) markup_storage;     /**< Stockage intégré de `markup`. */
+    ArrayInline(char, XML_SAX_INLINE_DEPTH * 16) names_storage;  /**< Stockage intégré de `names`. */
+    ArrayInline(size_t, XML_SAX_INLINE_DEPTH) open_storage;      /**< Stockage intégré de `open`. */
+    ArrayInline(XMLPosition, XML_SAX_INLINE_DEPTH) opened_storage; /**< Stockage intégré de `opened`. */
+} XMLSax;
+
+/**
+ * @brief Choisit l'allocateur des arènes créées ensuite (documents chargés ou construits).
+ *
+ * Une arène garde l'allocateur avec lequel elle a été créée. Le choix est
+ * propre à la bibliothèque chargée : il est à refaire après un rechargement.
+ *
+ * @param allocator L'allocateur, ou NULL pour malloc (valeur initiale).
+ */
+void xml_set_allocator(ArrayAllocator *allocator);
+
+/**
+ * @brief Crée une arène vide, avec l'allocateur choisi par xml_set_allocator.
+ *
+ * @return Arène allouée, à libérer avec xml_arena_free.
+ */
+XMLArena* xml_arena_new(void);
+
+/**
+ * @brief Alloue `size` octets alignés sur 8 octets dans l'arène.
+ *
+ * @param arena Arène.
+ * @param size Nombre d'octets.
+ * @return Mémoire valide jusqu'à xml_arena_free.
+ */
+void* xml_arena_alloc(XMLArena *arena, size_t size);
+
+/**
+ * @brief Copie une chaîne dans l'arène (équivalent de strdup).
+ *
+ * @param arena Arène.
+ * @param str Chaîne à copier.
+ * @return Copie de la chaîne.
+ */
+char* xml_arena_strdup(XMLArena *arena, const char *str);
+
+/**
+ * @brief Interne une chaîne dans la table d'un document.
+ *
+ * Deux chaînes égales internées dans la même arène ont la même adresse.
+ *
+ * @param arena Arène du document.
+ * @param str Chaîne à interner.
+ * @return La copie unique de la chaîne, valide jusqu'à la libération de l'arène.
+ */
+char* xml_intern(XMLArena *arena, const char *str);
+
+/**
+ * @brief Libère tous les blocs de l'arène et l'arène elle-même.
+ *
+ * @param arena Arène à libérer (peut être NULL).
+ */
+void xml_arena_free(XMLArena *arena);
+
 /**
  * @brief Crée un nouveau nœud XML avec un parent donné.
  *
- * @param parent Parent du nouveau nœud.
+ * Le nœud est alloué dans l'arène du parent. La racine d'un document est créée
+ * par xml_doc_init ou xml_load.
+ *
+ * @param parent Parent du nouveau nœud (non NULL).
  * @return Nouveau nœud XML créé.
  */
 XMLNode* xml_node_new(XMLNode *parent);
@@ -79,6 +338,9 @@ XMLNode* xml_node_new(XMLNode *parent);
 /**
  * @brief Charge un document XML à partir d'un fichier.
  *
+ * La suite du fichier est ignorée une fois la racine fermée, par `</root>` ou par
+ * le `<root/>` des anciennes versions ; un fichier qui se termine avant est refusé.
+ *
  * @param doc Pointeur vers le document XML à charger.
  * @param file_path Chemin du fichier XML à charger.
  * @return `true` si le chargement est réussi, sinon `false`.
@@ -96,6 +358,8 @@ void xml_node_print(XMLNode *node, int height);
 /**
  * @brief Écrit le document XML dans un fichier avec une indentation spécifiée.
  *
+ * Le document est construit dans un tampon puis écrit en un seul appel.
+ *
  * @param doc Document XML à écrire.
  * @param file_path Chemin du fichier XML de sortie.
  * @param indent Niveau d'indentation.
@@ -104,7 +368,16 @@ void xml_node_print(XMLNode *node, int height);
 bool xml_doc_write(XMLDocument *doc, const char *file_path, int indent);
 
 /**
- * @brief Libère la mémoire associée à un document XML.
+ * @brief Ajoute le document XML à un tampon de sortie, avec une indentation spécifiée.
+ *
+ * @param doc Document XML à écrire.
+ * @param out Tampon de sortie.
+ * @param indent Niveau d'indentation.
+ */
+void xml_doc_write_buffer(XMLDocument *doc, Buffer *out, int indent);
+
+/**
+ * @brief Libère la mémoire associée à un document XML en libérant son arène.
  *
  * @param doc Document XML à libérer.
  */
@@ -130,9 +403,10 @@ XMLDocument xml_doc_init(const char *tagname);
  *
  * @param parent Parent du nouveau nœud.
  * @param tag Balise du nouveau nœud.
- * @param inner_text Texte interne du nouveau nœud.
+ * @param inner_text Texte interne du nouveau nœud (copié), ou NULL.
+ * @return Le nouveau nœud.
  */
-void xml_insert_node(XMLNode *parent, const char *tag, const char *inner_text);
+XMLNode* xml_insert_node(XMLNode *parent, const char *tag, const char *inner_text);
 
 /**
  * @brief Ajoute un attribut à un nœud XML avec une clé et une valeur spécifiées.
@@ -146,30 +420,51 @@ void xml_attrib_add(XMLNode *node, const char *key, const char *value);
 /**
  * @brief Recherche un nœud XML avec un tag spécifié dans l'arborescence du nœud donné.
  *
+ * La recherche passe par l'index des tags du document (voir xml_node_find_tags).
+ *
  * @param root Racine de l'arborescence à rechercher.
  * @param tagname Tag à rechercher.
- * @return Pointeur vers le nœud trouvé, ou NULL s'il n'est pas trouvé.
+ * @return Le premier nœud trouvé dans l'ordre du document (`root` compris), ou NULL s'il n'est pas trouvé.
  */
 XMLNode* xml_node_find_tag(XMLNode *root, const char *tagname);
 
 /**
  * @brief Recherche tous les nœuds XML avec un tag spécifié dans l'arborescence du nœud donné.
  *
+ * La première recherche construit l'index des tags du document, qui associe à
+ * chaque tag ses nœuds dans l'ordre du document ; les suivantes ne parcourent
+ * que les nœuds du tag demandé. L'index est reconstruit après l'ajout d'un nœud.
+ *
  * @param root Racine de l'arborescence à rechercher.
  * @param tagname Tag à rechercher.
- * @return Tableau de pointeurs vers les nœuds trouvés.
+ * @return Tableau dynamique des nœuds trouvés, dans l'ordre du document (à libérer avec array_free).
  */
 Array_XMLNode xml_node_find_tags(XMLNode *root, const char *tagname);
 
 /**
  * @brief Obtient la valeur d'un attribut XML spécifié dans l'arborescence du nœud donné.
  *
+ * Les clés des attributs sont parcourues et comparées avec strcmp (une clé
+ * internée dans le document est reconnue à son adresse).
+ *
  * @param root Racine de l'arborescence à rechercher.
  * @param key Clé de l'attribut à obtenir.
  * @return Valeur de l'attribut, ou NULL si l'attribut n'est pas trouvé.
  */
 char* xml_attrib_get_value(XMLNode *root, const char *key);
 
+/**
+ * @brief Comme xml_attrib_get_value, pour une clé déjà internée dans le document.
+ *
+ * Les clés ne sont comparées que par adresse : internée une fois avec xml_intern
+ * hors d'une boucle, la clé sert à interroger autant de nœuds du document que voulu.
+ *
+ * @param root Nœud dont les attributs sont parcourus.
+ * @param key Clé renvoyée par xml_intern sur l'arène du document.
+ * @return Valeur de l'attribut, ou NULL si l'attribut n'est pas trouvé.
+ */
+char* xml_attrib_get_interned(XMLNode *root, const char *key);
+
 /**
  * @brief Obtient les chemins de fichiers XML dans un répertoire spécifié.
  *
@@ -178,4 +473,118 @@ char* xml_attrib_get_value(XMLNode *root, const char *key);
  */
 char** xml_get_filepaths(const char *path);
 
+/**
+ * @brief Projette un fichier XML en mémoire et l'analyse sur place, sans copier les chaînes.
+ *
+ * @param view Pointeur vers la vue à remplir.
+ * @param file_path Chemin du fichier XML à charger.
+ * @return `true` si le chargement est réussi, sinon `false` (la vue est alors libérée).
+ */
+bool xml_view_load(XMLView *view, const char *file_path);
+
+/**
+ * @brief Analyse sur place un tampon XML déjà en mémoire.
+ *
+ * Le tampon n'est ni copié ni modifié et doit rester valide tant que la vue est utilisée.
+ * xml_view_free ne le libère pas. Comme xml_load, un `<root/>` directement dans la racine
+ * termine le document (anciens niveaux) et un document tronqué est refusé.
+ *
+ * @param view Pointeur vers la vue à remplir.
+ * @param data Contenu XML (sans zéro final obligatoire).
+ * @param size Taille du contenu en octets.
+ * @return `true` si l'analyse est réussie, sinon `false`.
+ */
+bool xml_view_parse(XMLView *view, const char *data, size_t size);
+
+/**
+ * @brief Libère les tableaux de la vue et la projection du fichier.
+ *
+ * @param view Vue à libérer.
+ */
+void xml_view_free(XMLView *view);
+
+/**
+ * @brief Recherche en profondeur le premier nœud de tag donné, à partir d'un nœud.
+ *
+ * @param view Vue du document.
+ * @param node Indice du nœud de départ (0 pour la racine).
+ * @param tagname Tag à rechercher.
+ * @return Indice du nœud trouvé, ou XML_VIEW_NONE.
+ */
+size_t xml_view_find_tag(const XMLView *view, size_t node, const char *tagname);
+
+/**
+ * @brief Obtient la valeur d'un attribut d'un nœud de vue.
+ *
+ * @param view Vue du document.
+ * @param node Indice du nœud.
+ * @param key Clé de l'attribut.
+ * @return Vue sur la valeur, de `data` NULL si l'attribut n'existe pas.
+ */
+XMLStr xml_view_attrib(const XMLView *view, size_t node, const char *key);
+
+/**
+ * @brief Compare une vue de chaîne à une chaîne terminée par zéro.
+ *
+ * @param str Vue de chaîne.
+ * @param cstr Chaîne à comparer.
+ * @return `true` si les deux chaînes sont égales.
+ */
+bool xml_str_eq(XMLStr str, const char *cstr);
+
+/**
+ * @brief Convertit une vue de chaîne en entier décimal (équivalent de atoi).
+ *
+ * @param str Vue de chaîne.
+ * @return Valeur lue, 0 si la chaîne ne commence pas par un nombre.
+ */
+int xml_str_to_int(XMLStr str);
+
+/**
+ * @brief Initialise un analyseur en flux.
+ *
+ * @param sax Analyseur à initialiser.
+ * @param handler Fonctions appelées pendant l'analyse.
+ */
+void xml_sax_init(XMLSax *sax, XMLSaxHandler handler);
+
+/**
+ * @brief Analyse un morceau du document.
+ *
+ * Le morceau n'a pas besoin de se terminer sur une limite de balise.
+ *
+ * @param sax Analyseur.
+ * @param data Octets du morceau.
+ * @param size Nombre d'octets.
+ * @return `false` si le document est invalide.
+ */
+bool xml_sax_feed(XMLSax *sax, const char *data, size_t size);
+
+/**
+ * @brief Termine l'analyse après le dernier morceau.
+ *
+ * Un document tronqué est refusé : l'erreur donne l'élément ouvert le plus
+ * profond et, si les positions sont demandées, l'endroit où il commence.
+ *
+ * @param sax Analyseur.
+ * @return `false` si le document est invalide, se termine au milieu d'une balise ou avant la fermeture de la racine.
+ */
+bool xml_sax_finish(XMLSax *sax);
+
+/**
+ * @brief Libère la mémoire de l'analyseur en flux.
+ *
+ * @param sax Analyseur à libérer.
+ */
+void xml_sax_free(XMLSax *sax);
+
+/**
+ * @brief Analyse en flux un fichier lu par morceaux de XML_SAX_CHUNK_SIZE octets.
+ *
+ * @param file_path Chemin du fichier XML.
+ * @param handler Fonctions appelées pendant l'analyse.
+ * @return `true` si l'analyse est réussie, sinon `false`.
+ */
+bool xml_sax_parse_file(const char *file_path, XMLSaxHandler handler);
+
 #endif // XML_H_